@@ -0,0 +1,74 @@
+#pragma once
+
+#include "as/Exports.h"
+#include "as/Parse_Tree.h"
+
+#include <mn/Buf.h>
+
+namespace as
+{
+	// registers read and written by an instruction, bit i is register token KIND_KEYWORD_R0 + i
+	// same as the reg_list operand, partial writes like i32.mov are both a def and a use
+	struct Ins_Regs
+	{
+		uint32_t def;
+		uint32_t use;
+	};
+
+	AS_EXPORT Ins_Regs
+	ins_regs(const Ins& ins);
+
+	// maximal run of instructions with a single entry at the top and a single exit at the bottom
+	struct Basic_Block
+	{
+		// labels defined at the start of the block
+		mn::Buf<Tkn> labels;
+		// instructions without the labels
+		mn::Buf<Ins> ins;
+		// def/use registers of each instruction, indexed the same as ins
+		mn::Buf<Ins_Regs> regs;
+		// indices of the successor blocks, the fallthrough block comes last
+		mn::Buf<size_t> succs;
+		// the last instruction jumps to a label which isn't defined in the proc
+		bool escapes;
+	};
+
+	AS_EXPORT void
+	basic_block_free(Basic_Block& self);
+
+	inline static void
+	destruct(Basic_Block& self)
+	{
+		basic_block_free(self);
+	}
+
+	// control flow graph of a proc, blocks are kept in the source order and the first one is the entry
+	struct CFG
+	{
+		mn::Buf<Basic_Block> blocks;
+	};
+
+	AS_EXPORT CFG
+	cfg_build(const Proc& proc);
+
+	AS_EXPORT void
+	cfg_free(CFG& self);
+
+	inline static void
+	destruct(CFG& self)
+	{
+		cfg_free(self);
+	}
+
+	// writes the blocks back as the proc flat instructions list, ready for generation
+	AS_EXPORT void
+	cfg_lower(const CFG& self, Proc& proc);
+
+	// retargets jumps to blocks which only jump somewhere else, returns true if anything changed
+	AS_EXPORT bool
+	cfg_jumps_thread(CFG& self);
+
+	// removes the blocks which can't be reached from the entry block, returns true if anything changed
+	AS_EXPORT bool
+	cfg_dead_blocks_remove(CFG& self);
+}
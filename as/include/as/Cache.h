@@ -0,0 +1,60 @@
+#pragma once
+
+#include "as/Exports.h"
+
+#include <vm/Debug.h>
+
+#include <mn/Str.h>
+#include <mn/Buf.h>
+#include <mn/Map.h>
+
+namespace as
+{
+	struct Cache_Reloc
+	{
+		uint64_t bytecode_index;
+		mn::Str target;
+		uint8_t width;
+	};
+
+	// generated bytecode and relocations of a single proc
+	struct Cache_Entry
+	{
+		mn::Buf<uint8_t> bytes;
+		mn::Buf<Cache_Reloc> relocs;
+		// debug info of the entries generated with it, the lines are relative to the proc name line so
+		// the entry is still valid after the proc moves around
+		mn::Buf<vm::Debug_Line> lines;
+		mn::Buf<vm::Debug_Label> labels;
+		// set when the entry is used by the current build, only used entries are saved
+		bool used;
+	};
+
+	// build cache, procs are keyed by the hash of their tokens and the globals they reference so
+	// unchanged procs reuse their bytecode across builds instead of being generated again
+	struct Cache
+	{
+		mn::Map<uint64_t, Cache_Entry> entries;
+		size_t hits;
+		size_t misses;
+	};
+
+	AS_EXPORT Cache
+	cache_new();
+
+	AS_EXPORT void
+	cache_free(Cache& self);
+
+	inline static void
+	destruct(Cache& self)
+	{
+		cache_free(self);
+	}
+
+	// loads the cache file, a missing or outdated file loads an empty cache
+	AS_EXPORT Cache
+	cache_load(const mn::Str& filename);
+
+	AS_EXPORT void
+	cache_save(const Cache& self, const mn::Str& filename);
+}
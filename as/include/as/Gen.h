@@ -4,10 +4,33 @@
 
 #include <vm/Pkg.h>
 
+#include <mn/Buf.h>
+
+#include <stddef.h>
+
 namespace as
 {
 	struct Src;
+	struct Cache;
 
+	// generates the package of the parsed src, procs are generated in parallel on the given number of
+	// workers, 0 means a worker per hardware thread, and the output is the same for any workers count,
+	// debug adds the line table and labels of each proc to the package (vm/Debug.h)
 	AS_EXPORT vm::Pkg
-	src_gen(Src* src);
+	src_gen(Src* src, size_t workers = 0, bool debug = false);
+
+	// generates a single package out of multiple parsed srcs, global symbols are shared and checked
+	// across all of them and each src gets its own errors, procs found in the optional cache are reused
+	// and the newly generated ones are added to it
+	AS_EXPORT vm::Pkg
+	srcs_gen(const mn::Buf<Src*>& srcs, size_t workers = 0, Cache* cache = nullptr, bool debug = false);
+
+	// streaming build, every declaration is scanned, parsed, generated and written to the package as
+	// soon as it's reached then it's released along with its lines when the src is streamed
+	// (src_stream_from_file), it gives the same package as src_gen with the relocs in another order,
+	// what's kept until the end of the src is the global symbols, the label names which aren't globals,
+	// the constants which are pooled, the relocs to constants or to globals declared after their use and
+	// the stack frame of each proc, a label redefined by a later global is reported at the global
+	AS_EXPORT bool
+	src_gen_stream(Src* src, vm::Pkg_Writer& writer, bool debug = false);
 }
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "as/Exports.h"
+#include "as/Src.h"
+
+#include <mn/Buf.h>
+
+namespace as
+{
+	enum OPT_LEVEL
+	{
+		OPT_LEVEL_NONE,
+		// peephole optimizations, jump threading and dead block elimination within each proc
+		OPT_LEVEL_1,
+		// level 1 plus inlining of small leaf procs at their call sites
+		OPT_LEVEL_2,
+	};
+
+	// peephole pass over the proc instructions, it removes instructions which do nothing like mov r0 r0,
+	// add r0 0 and jumps to the next instruction, merges back to back add/sub of immediates into the
+	// same register and threads jumps to unconditional jumps, new immediates are interned in the src
+	AS_EXPORT void
+	proc_peephole(Src* src, Proc& proc);
+
+	// optimizes the procs of the parsed srcs in place before generation, inlining works across the srcs
+	// and procs which were inlined and aren't referenced anymore are removed from their src
+	AS_EXPORT void
+	srcs_opt(const mn::Buf<Src*>& srcs, OPT_LEVEL level);
+}
@@ -8,6 +8,32 @@ namespace as
 	AS_EXPORT bool
 	parse(Src* src);
 
+	// scans and parses each src on its own worker, 0 workers means a worker per hardware thread,
+	// returns false if any of the srcs has errors
+	AS_EXPORT bool
+	srcs_parse(const mn::Buf<Src*>& srcs, size_t workers = 0);
+
+	// streaming parser, the tokens are scanned on demand and each declaration is parsed on its own
+	// so that it can be generated and released before parsing the next one
+	struct Parser;
+
+	AS_EXPORT Parser*
+	parser_stream_new(Src* src);
+
+	AS_EXPORT void
+	parser_stream_free(Parser* self);
+
+	inline static void
+	destruct(Parser* self)
+	{
+		parser_stream_free(self);
+	}
+
+	// parses the next declaration, returns nullptr at the end of the src or on errors, the returned
+	// decl along with its tokens and strings is only valid until the next call
+	AS_EXPORT Decl*
+	parser_stream_decl(Parser* self);
+
 	AS_EXPORT mn::Str
 	decl_dump(Src* src, mn::Allocator allocator = mn::allocator_top());
 }
\ No newline at end of file
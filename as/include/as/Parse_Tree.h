@@ -6,6 +6,9 @@
 #include <mn/Buf.h>
 #include <mn/Fmt.h>
 
+#include <assert.h>
+#include <ctype.h>
+
 namespace as
 {
 	struct Operand
@@ -16,7 +19,8 @@ namespace as
 			KIND_REG,
 			KIND_MEM,
 			KIND_IMM,
-			KIND_ID
+			KIND_ID,
+			KIND_REG_LIST
 		};
 
 		KIND kind;
@@ -26,7 +30,14 @@ namespace as
 			Tkn mem;
 			Tkn imm;
 			Tkn id;
+			// bit i is set if register token KIND_KEYWORD_R0 + i is in the list
+			uint32_t reg_list;
 		};
+
+		// optional displacement of memory operands [reg + disp], disp_op is the + or - token
+		// and it's empty when the sign is part of the integer itself like [fp -8]
+		Tkn disp_op;
+		Tkn disp;
 	};
 
 	inline static Operand
@@ -47,6 +58,32 @@ namespace as
 		return self;
 	}
 
+	inline static Operand
+	operand_mem_disp(Tkn mem_reg, Tkn disp_op, Tkn disp)
+	{
+		Operand self{};
+		self.kind = Operand::KIND_MEM;
+		self.mem = mem_reg;
+		self.disp_op = disp_op;
+		self.disp = disp;
+		return self;
+	}
+
+	inline static Operand
+	operand_reg_list(uint32_t reg_list)
+	{
+		Operand self{};
+		self.kind = Operand::KIND_REG_LIST;
+		self.reg_list = reg_list;
+		return self;
+	}
+
+	inline static uint32_t
+	reg_list_bit(const Tkn& reg)
+	{
+		return uint32_t(1) << (reg.kind - Tkn::KIND_KEYWORD_R0);
+	}
+
 	inline static Operand
 	operand_imm(Tkn imm)
 	{
@@ -70,6 +107,7 @@ namespace as
 		Tkn op;  // operation
 		Operand dst; // destination
 		Operand src; // source
+		Operand src2; // second source, used by three operand instructions like fma
 		Tkn lbl; // label
 	};
 
@@ -80,10 +118,10 @@ namespace as
 	};
 
 	inline static Proc
-	proc_new()
+	proc_new(mn::Allocator allocator = mn::allocator_top())
 	{
 		Proc self{};
-		self.ins = mn::buf_new<Ins>();
+		self.ins = mn::buf_with_allocator<Ins>(allocator);
 		return self;
 	}
 
@@ -115,10 +153,10 @@ namespace as
 	};
 
 	inline static C_Proc
-	c_proc_new()
+	c_proc_new(mn::Allocator allocator = mn::allocator_top())
 	{
 		C_Proc self{};
-		self.args = mn::buf_new<Tkn>();
+		self.args = mn::buf_with_allocator<Tkn>(allocator);
 		return self;
 	}
 
@@ -155,14 +193,15 @@ namespace as
 	};
 
 	AS_EXPORT Decl*
-	decl_proc_new(Proc proc);
+	decl_proc_new(Proc proc, mn::Allocator allocator = mn::allocator_top());
 
 	AS_EXPORT Decl*
-	decl_constant_new(Constant constant);
+	decl_constant_new(Constant constant, mn::Allocator allocator = mn::allocator_top());
 
 	AS_EXPORT Decl*
-	decl_c_proc_new(C_Proc c_proc);
+	decl_c_proc_new(C_Proc c_proc, mn::Allocator allocator = mn::allocator_top());
 
+	// decls allocated from an arena, like the src arena, are released with it and shouldn't be freed
 	AS_EXPORT void
 	decl_free(Decl* self);
 
@@ -171,6 +210,18 @@ namespace as
 	{
 		decl_free(self);
 	}
+
+	inline static Tkn
+	decl_name(const Decl* self)
+	{
+		switch(self->kind)
+		{
+		case Decl::KIND_PROC: return self->proc.name;
+		case Decl::KIND_C_PROC: return self->c_proc.name;
+		case Decl::KIND_CONSTANT: return self->constant.name;
+		default: assert(false && "unreachable"); return Tkn{};
+		}
+	}
 }
 
 namespace fmt
@@ -200,7 +251,27 @@ namespace fmt
 			case as::Operand::KIND_REG:
 				return format_to(ctx.out(), "{}", operand.reg);
 			case as::Operand::KIND_MEM:
+				if (operand.disp_op)
+					return format_to(ctx.out(), "[{} {} {}]", operand.mem, operand.disp_op, operand.disp);
+				else if (operand.disp)
+					return format_to(ctx.out(), "[{} {}]", operand.mem, operand.disp);
 				return format_to(ctx.out(), "[{}]", operand.mem);
+			case as::Operand::KIND_REG_LIST:
+			{
+				bool first = true;
+				for (uint32_t i = 0; i < 32; ++i)
+				{
+					if ((operand.reg_list & (uint32_t(1) << i)) == 0)
+						continue;
+					if (first == false)
+						format_to(ctx.out(), " ");
+					first = false;
+					// register names are listed in upper case so print them in lower case like the source
+					for (auto c = as::Tkn::NAMES[as::Tkn::KIND_KEYWORD_R0 + i]; *c; ++c)
+						format_to(ctx.out(), "{}", char(::tolower(*c)));
+				}
+				return ctx.out();
+			}
 			case as::Operand::KIND_IMM:
 				return format_to(ctx.out(), "{}", operand.imm);
 			case as::Operand::KIND_ID:
@@ -229,6 +300,8 @@ namespace fmt
 				format_to(ctx.out(), " {}", ins.dst);
 			if(ins.src.kind != as::Operand::KIND_NONE)
 				format_to(ctx.out(), " {}", ins.src);
+			if(ins.src2.kind != as::Operand::KIND_NONE)
+				format_to(ctx.out(), " {}", ins.src2);
 			if(ins.lbl)
 				format_to(ctx.out(), " {}", ins.lbl);
 			return ctx.out();
@@ -7,4 +7,39 @@ namespace as
 {
 	AS_EXPORT bool
 	scan(Src* src);
+
+	// on demand scanner, it returns the tokens one by one instead of appending them to the src tokens,
+	// the tokens strings are interned into the given table and the src lines table isn't recorded
+	struct Scanner;
+
+	AS_EXPORT Scanner*
+	scanner_new(Src* src, mn::Str_Intern* str_table);
+
+	AS_EXPORT void
+	scanner_free(Scanner* self);
+
+	inline static void
+	destruct(Scanner* self)
+	{
+		scanner_free(self);
+	}
+
+	// returns the next token or an empty token at the end of the src
+	AS_EXPORT Tkn
+	scanner_next(Scanner* self);
+
+	// position of the scanner, the offset is into the src content so it stays valid when the content
+	// of a streamed src grows
+	struct Scanner_Mark
+	{
+		size_t offset;
+		Pos pos;
+	};
+
+	AS_EXPORT Scanner_Mark
+	scanner_mark(const Scanner* self);
+
+	// moves the scanner to the mark, it has to be at the start of a token or of the whitespaces before it
+	AS_EXPORT void
+	scanner_restart(Scanner* self, const Scanner_Mark& mark);
 }
\ No newline at end of file
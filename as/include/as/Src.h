@@ -9,11 +9,18 @@
 #include <mn/Str.h>
 #include <mn/Buf.h>
 #include <mn/Str_Intern.h>
+#include <mn/File.h>
 
 namespace as
 {
+	// bytes read at a time by streamed srcs
+	constexpr size_t SRC_STREAM_CHUNK_SIZE = 64 * 1024;
+
+	// everything hanging off the src (lines, tokens, interned strings, decls and their buffers) is
+	// allocated from its arena and released at once in src_free
 	struct Src
 	{
+		mn::Allocator arena;
 		mn::Str path;
 		mn::Str content;
 		mn::Buf<Line> lines;
@@ -21,6 +28,12 @@ namespace as
 		mn::Buf<Err> errs;
 		mn::Buf<Tkn> tkns;
 		mn::Buf<Decl*> decls;
+		// streamed srcs read their file a chunk at a time, the content holds the whole lines which were
+		// read and not released yet starting at content_line and the partial last line waits in pending
+		mn::File file;
+		mn::Str pending;
+		size_t chunk_size;
+		uint32_t content_line;
 	};
 
 	AS_EXPORT Src*
@@ -29,6 +42,22 @@ namespace as
 	AS_EXPORT Src*
 	src_from_str(const char* code);
 
+	// streamed src, its content starts empty and is read by src_stream_read
+	AS_EXPORT Src*
+	src_stream_from_file(const char* path, size_t chunk_size = SRC_STREAM_CHUNK_SIZE);
+
+	// adds the next whole lines of a streamed src to its content, it reads at least a chunk and at least
+	// as much as the content has so a declaration which is read again and again takes linear time,
+	// returns false if there's nothing left to read
+	AS_EXPORT bool
+	src_stream_read(Src* self);
+
+	// releases the content lines before the line of the given offset, line is its line number, the
+	// lines are only released once they're at least half of the content so the content is moved a
+	// linear number of bytes in total, returns the count of released bytes
+	AS_EXPORT size_t
+	src_stream_release(Src* self, size_t offset, uint32_t line);
+
 	AS_EXPORT void
 	src_free(Src* self);
 
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "as/Exports.h"
+
+#include <mn/Str.h>
+
+namespace as
+{
+	// shape of the call graph of the generated procs, every proc is called exactly once so the run time
+	// grows linearly with the procs count whatever the shape is
+	enum SYNTH_SHAPE
+	{
+		// each proc calls the next one, the call depth is the procs count
+		SYNTH_SHAPE_CHAIN,
+		// each proc calls the next fanout procs of a complete tree
+		SYNTH_SHAPE_TREE,
+		// each proc is called by a random proc before it
+		SYNTH_SHAPE_RANDOM,
+	};
+
+	struct Synth_Config
+	{
+		// the same seed and config give the same program
+		uint64_t seed;
+		// procs count including main
+		size_t procs;
+		// random instructions of each proc, the loops, calls and frame setup come on top of them
+		size_t ins_per_proc;
+		// labels of each proc, they alternate between loop heads and forward jumps targets
+		size_t labels_per_proc;
+		// iterations of each loop
+		size_t loop_count;
+		// string constants which the procs read from
+		size_t constants;
+		// c procs which are declared and called, they're picked from a fixed list of libc procs
+		size_t c_procs;
+		SYNTH_SHAPE shape;
+		// children of each proc in the tree shape
+		size_t fanout;
+	};
+
+	AS_EXPORT Synth_Config
+	synth_config_default();
+
+	// generates a program which assembles without errors and halts in main with a checksum of its run in
+	// r0, the checksum depends only on the config so it can be compared across the ways of running it
+	AS_EXPORT mn::Str
+	synth_generate(const Synth_Config& config, mn::Allocator allocator = mn::allocator_top());
+
+	// procs count which makes the generated program about the given size with the rest of the config
+	AS_EXPORT size_t
+	synth_procs_for_size(const Synth_Config& config, size_t size_in_bytes);
+
+	AS_EXPORT const char*
+	synth_shape_name(SYNTH_SHAPE shape);
+
+	// returns false if the name isn't a shape
+	AS_EXPORT bool
+	synth_shape_from_name(const char* name, SYNTH_SHAPE& shape);
+}
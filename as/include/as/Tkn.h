@@ -16,7 +16,7 @@ namespace as
 			#undef TOKEN
 		};
 
-		inline static const char* NAMES[] = {
+		inline static constexpr const char* NAMES[] = {
 			#define TOKEN(k, s) s
 				TOKEN_LISTING
 			#undef TOKEN
@@ -48,7 +48,8 @@ namespace as
 				k == Tkn::KIND_KEYWORD_R6 ||
 				k == Tkn::KIND_KEYWORD_R7 ||
 				k == Tkn::KIND_KEYWORD_IP ||
-				k == Tkn::KIND_KEYWORD_SP);
+				k == Tkn::KIND_KEYWORD_SP ||
+				k == Tkn::KIND_KEYWORD_FP);
 	}
 
 	inline static bool
@@ -78,7 +79,9 @@ namespace as
 				k == Tkn::KIND_KEYWORD_U8_MOV ||
 				k == Tkn::KIND_KEYWORD_U16_MOV ||
 				k == Tkn::KIND_KEYWORD_U32_MOV ||
-				k == Tkn::KIND_KEYWORD_U64_MOV);
+				k == Tkn::KIND_KEYWORD_U64_MOV ||
+				k == Tkn::KIND_KEYWORD_F32_MOV ||
+				k == Tkn::KIND_KEYWORD_F64_MOV);
 	}
 
 	inline static bool
@@ -115,7 +118,164 @@ namespace as
 				k == Tkn::KIND_KEYWORD_U8_DIV ||
 				k == Tkn::KIND_KEYWORD_U16_DIV ||
 				k == Tkn::KIND_KEYWORD_U32_DIV ||
-				k == Tkn::KIND_KEYWORD_U64_DIV);
+				k == Tkn::KIND_KEYWORD_U64_DIV ||
+				k == Tkn::KIND_KEYWORD_F32_ADD ||
+				k == Tkn::KIND_KEYWORD_F64_ADD ||
+				k == Tkn::KIND_KEYWORD_F32_SUB ||
+				k == Tkn::KIND_KEYWORD_F64_SUB ||
+				k == Tkn::KIND_KEYWORD_F32_MUL ||
+				k == Tkn::KIND_KEYWORD_F64_MUL ||
+				k == Tkn::KIND_KEYWORD_F32_DIV ||
+				k == Tkn::KIND_KEYWORD_F64_DIV ||
+				k == Tkn::KIND_KEYWORD_F32_SQRT ||
+				k == Tkn::KIND_KEYWORD_F64_SQRT ||
+				k == Tkn::KIND_KEYWORD_F32_MIN ||
+				k == Tkn::KIND_KEYWORD_F64_MIN ||
+				k == Tkn::KIND_KEYWORD_F32_MAX ||
+				k == Tkn::KIND_KEYWORD_F64_MAX);
+	}
+
+	inline static bool
+	is_bitwise(Tkn::KIND k)
+	{
+		return (k == Tkn::KIND_KEYWORD_I8_AND ||
+				k == Tkn::KIND_KEYWORD_I16_AND ||
+				k == Tkn::KIND_KEYWORD_I32_AND ||
+				k == Tkn::KIND_KEYWORD_I64_AND ||
+				k == Tkn::KIND_KEYWORD_U8_AND ||
+				k == Tkn::KIND_KEYWORD_U16_AND ||
+				k == Tkn::KIND_KEYWORD_U32_AND ||
+				k == Tkn::KIND_KEYWORD_U64_AND ||
+				k == Tkn::KIND_KEYWORD_I8_OR ||
+				k == Tkn::KIND_KEYWORD_I16_OR ||
+				k == Tkn::KIND_KEYWORD_I32_OR ||
+				k == Tkn::KIND_KEYWORD_I64_OR ||
+				k == Tkn::KIND_KEYWORD_U8_OR ||
+				k == Tkn::KIND_KEYWORD_U16_OR ||
+				k == Tkn::KIND_KEYWORD_U32_OR ||
+				k == Tkn::KIND_KEYWORD_U64_OR ||
+				k == Tkn::KIND_KEYWORD_I8_XOR ||
+				k == Tkn::KIND_KEYWORD_I16_XOR ||
+				k == Tkn::KIND_KEYWORD_I32_XOR ||
+				k == Tkn::KIND_KEYWORD_I64_XOR ||
+				k == Tkn::KIND_KEYWORD_U8_XOR ||
+				k == Tkn::KIND_KEYWORD_U16_XOR ||
+				k == Tkn::KIND_KEYWORD_U32_XOR ||
+				k == Tkn::KIND_KEYWORD_U64_XOR ||
+				k == Tkn::KIND_KEYWORD_I8_SHL ||
+				k == Tkn::KIND_KEYWORD_I16_SHL ||
+				k == Tkn::KIND_KEYWORD_I32_SHL ||
+				k == Tkn::KIND_KEYWORD_I64_SHL ||
+				k == Tkn::KIND_KEYWORD_U8_SHL ||
+				k == Tkn::KIND_KEYWORD_U16_SHL ||
+				k == Tkn::KIND_KEYWORD_U32_SHL ||
+				k == Tkn::KIND_KEYWORD_U64_SHL ||
+				k == Tkn::KIND_KEYWORD_I8_SHR ||
+				k == Tkn::KIND_KEYWORD_I16_SHR ||
+				k == Tkn::KIND_KEYWORD_I32_SHR ||
+				k == Tkn::KIND_KEYWORD_I64_SHR ||
+				k == Tkn::KIND_KEYWORD_U8_SHR ||
+				k == Tkn::KIND_KEYWORD_U16_SHR ||
+				k == Tkn::KIND_KEYWORD_U32_SHR ||
+				k == Tkn::KIND_KEYWORD_U64_SHR ||
+				k == Tkn::KIND_KEYWORD_I8_ROL ||
+				k == Tkn::KIND_KEYWORD_I16_ROL ||
+				k == Tkn::KIND_KEYWORD_I32_ROL ||
+				k == Tkn::KIND_KEYWORD_I64_ROL ||
+				k == Tkn::KIND_KEYWORD_U8_ROL ||
+				k == Tkn::KIND_KEYWORD_U16_ROL ||
+				k == Tkn::KIND_KEYWORD_U32_ROL ||
+				k == Tkn::KIND_KEYWORD_U64_ROL ||
+				k == Tkn::KIND_KEYWORD_I8_ROR ||
+				k == Tkn::KIND_KEYWORD_I16_ROR ||
+				k == Tkn::KIND_KEYWORD_I32_ROR ||
+				k == Tkn::KIND_KEYWORD_I64_ROR ||
+				k == Tkn::KIND_KEYWORD_U8_ROR ||
+				k == Tkn::KIND_KEYWORD_U16_ROR ||
+				k == Tkn::KIND_KEYWORD_U32_ROR ||
+				k == Tkn::KIND_KEYWORD_U64_ROR ||
+				k == Tkn::KIND_KEYWORD_I8_POPCNT ||
+				k == Tkn::KIND_KEYWORD_I16_POPCNT ||
+				k == Tkn::KIND_KEYWORD_I32_POPCNT ||
+				k == Tkn::KIND_KEYWORD_I64_POPCNT ||
+				k == Tkn::KIND_KEYWORD_U8_POPCNT ||
+				k == Tkn::KIND_KEYWORD_U16_POPCNT ||
+				k == Tkn::KIND_KEYWORD_U32_POPCNT ||
+				k == Tkn::KIND_KEYWORD_U64_POPCNT ||
+				k == Tkn::KIND_KEYWORD_I8_CLZ ||
+				k == Tkn::KIND_KEYWORD_I16_CLZ ||
+				k == Tkn::KIND_KEYWORD_I32_CLZ ||
+				k == Tkn::KIND_KEYWORD_I64_CLZ ||
+				k == Tkn::KIND_KEYWORD_U8_CLZ ||
+				k == Tkn::KIND_KEYWORD_U16_CLZ ||
+				k == Tkn::KIND_KEYWORD_U32_CLZ ||
+				k == Tkn::KIND_KEYWORD_U64_CLZ ||
+				k == Tkn::KIND_KEYWORD_I8_CTZ ||
+				k == Tkn::KIND_KEYWORD_I16_CTZ ||
+				k == Tkn::KIND_KEYWORD_I32_CTZ ||
+				k == Tkn::KIND_KEYWORD_I64_CTZ ||
+				k == Tkn::KIND_KEYWORD_U8_CTZ ||
+				k == Tkn::KIND_KEYWORD_U16_CTZ ||
+				k == Tkn::KIND_KEYWORD_U32_CTZ ||
+				k == Tkn::KIND_KEYWORD_U64_CTZ);
+	}
+
+	inline static bool
+	is_bitwise_unary(Tkn::KIND k)
+	{
+		return (k == Tkn::KIND_KEYWORD_I8_NOT ||
+				k == Tkn::KIND_KEYWORD_I16_NOT ||
+				k == Tkn::KIND_KEYWORD_I32_NOT ||
+				k == Tkn::KIND_KEYWORD_I64_NOT ||
+				k == Tkn::KIND_KEYWORD_U8_NOT ||
+				k == Tkn::KIND_KEYWORD_U16_NOT ||
+				k == Tkn::KIND_KEYWORD_U32_NOT ||
+				k == Tkn::KIND_KEYWORD_U64_NOT ||
+				k == Tkn::KIND_KEYWORD_I16_BSWAP ||
+				k == Tkn::KIND_KEYWORD_I32_BSWAP ||
+				k == Tkn::KIND_KEYWORD_I64_BSWAP ||
+				k == Tkn::KIND_KEYWORD_U16_BSWAP ||
+				k == Tkn::KIND_KEYWORD_U32_BSWAP ||
+				k == Tkn::KIND_KEYWORD_U64_BSWAP);
+	}
+
+	inline static bool
+	is_float_unary(Tkn::KIND k)
+	{
+		return (k == Tkn::KIND_KEYWORD_F32_ABS ||
+				k == Tkn::KIND_KEYWORD_F64_ABS ||
+				k == Tkn::KIND_KEYWORD_F32_NEG ||
+				k == Tkn::KIND_KEYWORD_F64_NEG);
+	}
+
+	inline static bool
+	is_fma(Tkn::KIND k)
+	{
+		return (k == Tkn::KIND_KEYWORD_F32_FMA ||
+				k == Tkn::KIND_KEYWORD_F64_FMA);
+	}
+
+	inline static bool
+	is_conversion(Tkn::KIND k)
+	{
+		return (k == Tkn::KIND_KEYWORD_F32_FROM_I32 ||
+				k == Tkn::KIND_KEYWORD_F32_FROM_I64 ||
+				k == Tkn::KIND_KEYWORD_F32_FROM_U32 ||
+				k == Tkn::KIND_KEYWORD_F32_FROM_U64 ||
+				k == Tkn::KIND_KEYWORD_F64_FROM_I32 ||
+				k == Tkn::KIND_KEYWORD_F64_FROM_I64 ||
+				k == Tkn::KIND_KEYWORD_F64_FROM_U32 ||
+				k == Tkn::KIND_KEYWORD_F64_FROM_U64 ||
+				k == Tkn::KIND_KEYWORD_I32_FROM_F32 ||
+				k == Tkn::KIND_KEYWORD_I32_FROM_F64 ||
+				k == Tkn::KIND_KEYWORD_I64_FROM_F32 ||
+				k == Tkn::KIND_KEYWORD_I64_FROM_F64 ||
+				k == Tkn::KIND_KEYWORD_U32_FROM_F32 ||
+				k == Tkn::KIND_KEYWORD_U32_FROM_F64 ||
+				k == Tkn::KIND_KEYWORD_U64_FROM_F32 ||
+				k == Tkn::KIND_KEYWORD_U64_FROM_F64 ||
+				k == Tkn::KIND_KEYWORD_F64_FROM_F32 ||
+				k == Tkn::KIND_KEYWORD_F32_FROM_F64);
 	}
 
 	inline static bool
@@ -188,7 +348,9 @@ namespace as
 				k == Tkn::KIND_KEYWORD_U8_CMP ||
 				k == Tkn::KIND_KEYWORD_U16_CMP ||
 				k == Tkn::KIND_KEYWORD_U32_CMP ||
-				k == Tkn::KIND_KEYWORD_U64_CMP);
+				k == Tkn::KIND_KEYWORD_U64_CMP ||
+				k == Tkn::KIND_KEYWORD_F32_CMP ||
+				k == Tkn::KIND_KEYWORD_F64_CMP);
 	}
 
 	inline static bool
@@ -202,6 +364,112 @@ namespace as
 				k == Tkn::KIND_KEYWORD_JGE ||
 				k == Tkn::KIND_KEYWORD_JMP);
 	}
+
+	inline static bool
+	is_cmov(Tkn::KIND k)
+	{
+		return (k == Tkn::KIND_KEYWORD_I8_CMOVE ||
+				k == Tkn::KIND_KEYWORD_I16_CMOVE ||
+				k == Tkn::KIND_KEYWORD_I32_CMOVE ||
+				k == Tkn::KIND_KEYWORD_I64_CMOVE ||
+				k == Tkn::KIND_KEYWORD_U8_CMOVE ||
+				k == Tkn::KIND_KEYWORD_U16_CMOVE ||
+				k == Tkn::KIND_KEYWORD_U32_CMOVE ||
+				k == Tkn::KIND_KEYWORD_U64_CMOVE ||
+				k == Tkn::KIND_KEYWORD_I8_CMOVNE ||
+				k == Tkn::KIND_KEYWORD_I16_CMOVNE ||
+				k == Tkn::KIND_KEYWORD_I32_CMOVNE ||
+				k == Tkn::KIND_KEYWORD_I64_CMOVNE ||
+				k == Tkn::KIND_KEYWORD_U8_CMOVNE ||
+				k == Tkn::KIND_KEYWORD_U16_CMOVNE ||
+				k == Tkn::KIND_KEYWORD_U32_CMOVNE ||
+				k == Tkn::KIND_KEYWORD_U64_CMOVNE ||
+				k == Tkn::KIND_KEYWORD_I8_CMOVL ||
+				k == Tkn::KIND_KEYWORD_I16_CMOVL ||
+				k == Tkn::KIND_KEYWORD_I32_CMOVL ||
+				k == Tkn::KIND_KEYWORD_I64_CMOVL ||
+				k == Tkn::KIND_KEYWORD_U8_CMOVL ||
+				k == Tkn::KIND_KEYWORD_U16_CMOVL ||
+				k == Tkn::KIND_KEYWORD_U32_CMOVL ||
+				k == Tkn::KIND_KEYWORD_U64_CMOVL ||
+				k == Tkn::KIND_KEYWORD_I8_CMOVLE ||
+				k == Tkn::KIND_KEYWORD_I16_CMOVLE ||
+				k == Tkn::KIND_KEYWORD_I32_CMOVLE ||
+				k == Tkn::KIND_KEYWORD_I64_CMOVLE ||
+				k == Tkn::KIND_KEYWORD_U8_CMOVLE ||
+				k == Tkn::KIND_KEYWORD_U16_CMOVLE ||
+				k == Tkn::KIND_KEYWORD_U32_CMOVLE ||
+				k == Tkn::KIND_KEYWORD_U64_CMOVLE ||
+				k == Tkn::KIND_KEYWORD_I8_CMOVG ||
+				k == Tkn::KIND_KEYWORD_I16_CMOVG ||
+				k == Tkn::KIND_KEYWORD_I32_CMOVG ||
+				k == Tkn::KIND_KEYWORD_I64_CMOVG ||
+				k == Tkn::KIND_KEYWORD_U8_CMOVG ||
+				k == Tkn::KIND_KEYWORD_U16_CMOVG ||
+				k == Tkn::KIND_KEYWORD_U32_CMOVG ||
+				k == Tkn::KIND_KEYWORD_U64_CMOVG ||
+				k == Tkn::KIND_KEYWORD_I8_CMOVGE ||
+				k == Tkn::KIND_KEYWORD_I16_CMOVGE ||
+				k == Tkn::KIND_KEYWORD_I32_CMOVGE ||
+				k == Tkn::KIND_KEYWORD_I64_CMOVGE ||
+				k == Tkn::KIND_KEYWORD_U8_CMOVGE ||
+				k == Tkn::KIND_KEYWORD_U16_CMOVGE ||
+				k == Tkn::KIND_KEYWORD_U32_CMOVGE ||
+				k == Tkn::KIND_KEYWORD_U64_CMOVGE);
+	}
+
+	inline static bool
+	is_set(Tkn::KIND k)
+	{
+		return (k == Tkn::KIND_KEYWORD_I8_SETE ||
+				k == Tkn::KIND_KEYWORD_I16_SETE ||
+				k == Tkn::KIND_KEYWORD_I32_SETE ||
+				k == Tkn::KIND_KEYWORD_I64_SETE ||
+				k == Tkn::KIND_KEYWORD_U8_SETE ||
+				k == Tkn::KIND_KEYWORD_U16_SETE ||
+				k == Tkn::KIND_KEYWORD_U32_SETE ||
+				k == Tkn::KIND_KEYWORD_U64_SETE ||
+				k == Tkn::KIND_KEYWORD_I8_SETNE ||
+				k == Tkn::KIND_KEYWORD_I16_SETNE ||
+				k == Tkn::KIND_KEYWORD_I32_SETNE ||
+				k == Tkn::KIND_KEYWORD_I64_SETNE ||
+				k == Tkn::KIND_KEYWORD_U8_SETNE ||
+				k == Tkn::KIND_KEYWORD_U16_SETNE ||
+				k == Tkn::KIND_KEYWORD_U32_SETNE ||
+				k == Tkn::KIND_KEYWORD_U64_SETNE ||
+				k == Tkn::KIND_KEYWORD_I8_SETL ||
+				k == Tkn::KIND_KEYWORD_I16_SETL ||
+				k == Tkn::KIND_KEYWORD_I32_SETL ||
+				k == Tkn::KIND_KEYWORD_I64_SETL ||
+				k == Tkn::KIND_KEYWORD_U8_SETL ||
+				k == Tkn::KIND_KEYWORD_U16_SETL ||
+				k == Tkn::KIND_KEYWORD_U32_SETL ||
+				k == Tkn::KIND_KEYWORD_U64_SETL ||
+				k == Tkn::KIND_KEYWORD_I8_SETLE ||
+				k == Tkn::KIND_KEYWORD_I16_SETLE ||
+				k == Tkn::KIND_KEYWORD_I32_SETLE ||
+				k == Tkn::KIND_KEYWORD_I64_SETLE ||
+				k == Tkn::KIND_KEYWORD_U8_SETLE ||
+				k == Tkn::KIND_KEYWORD_U16_SETLE ||
+				k == Tkn::KIND_KEYWORD_U32_SETLE ||
+				k == Tkn::KIND_KEYWORD_U64_SETLE ||
+				k == Tkn::KIND_KEYWORD_I8_SETG ||
+				k == Tkn::KIND_KEYWORD_I16_SETG ||
+				k == Tkn::KIND_KEYWORD_I32_SETG ||
+				k == Tkn::KIND_KEYWORD_I64_SETG ||
+				k == Tkn::KIND_KEYWORD_U8_SETG ||
+				k == Tkn::KIND_KEYWORD_U16_SETG ||
+				k == Tkn::KIND_KEYWORD_U32_SETG ||
+				k == Tkn::KIND_KEYWORD_U64_SETG ||
+				k == Tkn::KIND_KEYWORD_I8_SETGE ||
+				k == Tkn::KIND_KEYWORD_I16_SETGE ||
+				k == Tkn::KIND_KEYWORD_I32_SETGE ||
+				k == Tkn::KIND_KEYWORD_I64_SETGE ||
+				k == Tkn::KIND_KEYWORD_U8_SETGE ||
+				k == Tkn::KIND_KEYWORD_U16_SETGE ||
+				k == Tkn::KIND_KEYWORD_U32_SETGE ||
+				k == Tkn::KIND_KEYWORD_U64_SETGE);
+	}
 }
 
 #undef TOKEN_LISTING
\ No newline at end of file
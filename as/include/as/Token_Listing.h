@@ -8,6 +8,8 @@
 	TOKEN(OPEN_BRACKET, "["), \
 	TOKEN(CLOSE_BRACKET, "]"), \
 	TOKEN(COMMA, ","), \
+	TOKEN(PLUS, "+"), \
+	TOKEN(MINUS, "-"), \
 	TOKEN(ID, "<ID>"), \
 	TOKEN(STRING, "<STRING>"), \
 	TOKEN(INTEGER, "<INTEGER>"), \
@@ -69,6 +71,100 @@
 	TOKEN(KEYWORD_U16_DIV, "u16.div"), \
 	TOKEN(KEYWORD_U32_DIV, "u32.div"), \
 	TOKEN(KEYWORD_U64_DIV, "u64.div"), \
+	TOKEN(KEYWORD_I8_AND, "i8.and"), \
+	TOKEN(KEYWORD_I16_AND, "i16.and"), \
+	TOKEN(KEYWORD_I32_AND, "i32.and"), \
+	TOKEN(KEYWORD_I64_AND, "i64.and"), \
+	TOKEN(KEYWORD_U8_AND, "u8.and"), \
+	TOKEN(KEYWORD_U16_AND, "u16.and"), \
+	TOKEN(KEYWORD_U32_AND, "u32.and"), \
+	TOKEN(KEYWORD_U64_AND, "u64.and"), \
+	TOKEN(KEYWORD_I8_OR, "i8.or"), \
+	TOKEN(KEYWORD_I16_OR, "i16.or"), \
+	TOKEN(KEYWORD_I32_OR, "i32.or"), \
+	TOKEN(KEYWORD_I64_OR, "i64.or"), \
+	TOKEN(KEYWORD_U8_OR, "u8.or"), \
+	TOKEN(KEYWORD_U16_OR, "u16.or"), \
+	TOKEN(KEYWORD_U32_OR, "u32.or"), \
+	TOKEN(KEYWORD_U64_OR, "u64.or"), \
+	TOKEN(KEYWORD_I8_XOR, "i8.xor"), \
+	TOKEN(KEYWORD_I16_XOR, "i16.xor"), \
+	TOKEN(KEYWORD_I32_XOR, "i32.xor"), \
+	TOKEN(KEYWORD_I64_XOR, "i64.xor"), \
+	TOKEN(KEYWORD_U8_XOR, "u8.xor"), \
+	TOKEN(KEYWORD_U16_XOR, "u16.xor"), \
+	TOKEN(KEYWORD_U32_XOR, "u32.xor"), \
+	TOKEN(KEYWORD_U64_XOR, "u64.xor"), \
+	TOKEN(KEYWORD_I8_NOT, "i8.not"), \
+	TOKEN(KEYWORD_I16_NOT, "i16.not"), \
+	TOKEN(KEYWORD_I32_NOT, "i32.not"), \
+	TOKEN(KEYWORD_I64_NOT, "i64.not"), \
+	TOKEN(KEYWORD_U8_NOT, "u8.not"), \
+	TOKEN(KEYWORD_U16_NOT, "u16.not"), \
+	TOKEN(KEYWORD_U32_NOT, "u32.not"), \
+	TOKEN(KEYWORD_U64_NOT, "u64.not"), \
+	TOKEN(KEYWORD_I8_SHL, "i8.shl"), \
+	TOKEN(KEYWORD_I16_SHL, "i16.shl"), \
+	TOKEN(KEYWORD_I32_SHL, "i32.shl"), \
+	TOKEN(KEYWORD_I64_SHL, "i64.shl"), \
+	TOKEN(KEYWORD_U8_SHL, "u8.shl"), \
+	TOKEN(KEYWORD_U16_SHL, "u16.shl"), \
+	TOKEN(KEYWORD_U32_SHL, "u32.shl"), \
+	TOKEN(KEYWORD_U64_SHL, "u64.shl"), \
+	TOKEN(KEYWORD_I8_SHR, "i8.shr"), \
+	TOKEN(KEYWORD_I16_SHR, "i16.shr"), \
+	TOKEN(KEYWORD_I32_SHR, "i32.shr"), \
+	TOKEN(KEYWORD_I64_SHR, "i64.shr"), \
+	TOKEN(KEYWORD_U8_SHR, "u8.shr"), \
+	TOKEN(KEYWORD_U16_SHR, "u16.shr"), \
+	TOKEN(KEYWORD_U32_SHR, "u32.shr"), \
+	TOKEN(KEYWORD_U64_SHR, "u64.shr"), \
+	TOKEN(KEYWORD_I8_ROL, "i8.rol"), \
+	TOKEN(KEYWORD_I16_ROL, "i16.rol"), \
+	TOKEN(KEYWORD_I32_ROL, "i32.rol"), \
+	TOKEN(KEYWORD_I64_ROL, "i64.rol"), \
+	TOKEN(KEYWORD_U8_ROL, "u8.rol"), \
+	TOKEN(KEYWORD_U16_ROL, "u16.rol"), \
+	TOKEN(KEYWORD_U32_ROL, "u32.rol"), \
+	TOKEN(KEYWORD_U64_ROL, "u64.rol"), \
+	TOKEN(KEYWORD_I8_ROR, "i8.ror"), \
+	TOKEN(KEYWORD_I16_ROR, "i16.ror"), \
+	TOKEN(KEYWORD_I32_ROR, "i32.ror"), \
+	TOKEN(KEYWORD_I64_ROR, "i64.ror"), \
+	TOKEN(KEYWORD_U8_ROR, "u8.ror"), \
+	TOKEN(KEYWORD_U16_ROR, "u16.ror"), \
+	TOKEN(KEYWORD_U32_ROR, "u32.ror"), \
+	TOKEN(KEYWORD_U64_ROR, "u64.ror"), \
+	TOKEN(KEYWORD_I8_POPCNT, "i8.popcnt"), \
+	TOKEN(KEYWORD_I16_POPCNT, "i16.popcnt"), \
+	TOKEN(KEYWORD_I32_POPCNT, "i32.popcnt"), \
+	TOKEN(KEYWORD_I64_POPCNT, "i64.popcnt"), \
+	TOKEN(KEYWORD_U8_POPCNT, "u8.popcnt"), \
+	TOKEN(KEYWORD_U16_POPCNT, "u16.popcnt"), \
+	TOKEN(KEYWORD_U32_POPCNT, "u32.popcnt"), \
+	TOKEN(KEYWORD_U64_POPCNT, "u64.popcnt"), \
+	TOKEN(KEYWORD_I8_CLZ, "i8.clz"), \
+	TOKEN(KEYWORD_I16_CLZ, "i16.clz"), \
+	TOKEN(KEYWORD_I32_CLZ, "i32.clz"), \
+	TOKEN(KEYWORD_I64_CLZ, "i64.clz"), \
+	TOKEN(KEYWORD_U8_CLZ, "u8.clz"), \
+	TOKEN(KEYWORD_U16_CLZ, "u16.clz"), \
+	TOKEN(KEYWORD_U32_CLZ, "u32.clz"), \
+	TOKEN(KEYWORD_U64_CLZ, "u64.clz"), \
+	TOKEN(KEYWORD_I8_CTZ, "i8.ctz"), \
+	TOKEN(KEYWORD_I16_CTZ, "i16.ctz"), \
+	TOKEN(KEYWORD_I32_CTZ, "i32.ctz"), \
+	TOKEN(KEYWORD_I64_CTZ, "i64.ctz"), \
+	TOKEN(KEYWORD_U8_CTZ, "u8.ctz"), \
+	TOKEN(KEYWORD_U16_CTZ, "u16.ctz"), \
+	TOKEN(KEYWORD_U32_CTZ, "u32.ctz"), \
+	TOKEN(KEYWORD_U64_CTZ, "u64.ctz"), \
+	TOKEN(KEYWORD_I16_BSWAP, "i16.bswap"), \
+	TOKEN(KEYWORD_I32_BSWAP, "i32.bswap"), \
+	TOKEN(KEYWORD_I64_BSWAP, "i64.bswap"), \
+	TOKEN(KEYWORD_U16_BSWAP, "u16.bswap"), \
+	TOKEN(KEYWORD_U32_BSWAP, "u32.bswap"), \
+	TOKEN(KEYWORD_U64_BSWAP, "u64.bswap"), \
 	TOKEN(KEYWORD_I8_CMP, "i8.cmp"), \
 	TOKEN(KEYWORD_I16_CMP, "i16.cmp"), \
 	TOKEN(KEYWORD_I32_CMP, "i32.cmp"), \
@@ -77,6 +173,48 @@
 	TOKEN(KEYWORD_U16_CMP, "u16.cmp"), \
 	TOKEN(KEYWORD_U32_CMP, "u32.cmp"), \
 	TOKEN(KEYWORD_U64_CMP, "u64.cmp"), \
+	TOKEN(KEYWORD_F32_MOV, "f32.mov"), \
+	TOKEN(KEYWORD_F64_MOV, "f64.mov"), \
+	TOKEN(KEYWORD_F32_ADD, "f32.add"), \
+	TOKEN(KEYWORD_F64_ADD, "f64.add"), \
+	TOKEN(KEYWORD_F32_SUB, "f32.sub"), \
+	TOKEN(KEYWORD_F64_SUB, "f64.sub"), \
+	TOKEN(KEYWORD_F32_MUL, "f32.mul"), \
+	TOKEN(KEYWORD_F64_MUL, "f64.mul"), \
+	TOKEN(KEYWORD_F32_DIV, "f32.div"), \
+	TOKEN(KEYWORD_F64_DIV, "f64.div"), \
+	TOKEN(KEYWORD_F32_FMA, "f32.fma"), \
+	TOKEN(KEYWORD_F64_FMA, "f64.fma"), \
+	TOKEN(KEYWORD_F32_SQRT, "f32.sqrt"), \
+	TOKEN(KEYWORD_F64_SQRT, "f64.sqrt"), \
+	TOKEN(KEYWORD_F32_MIN, "f32.min"), \
+	TOKEN(KEYWORD_F64_MIN, "f64.min"), \
+	TOKEN(KEYWORD_F32_MAX, "f32.max"), \
+	TOKEN(KEYWORD_F64_MAX, "f64.max"), \
+	TOKEN(KEYWORD_F32_ABS, "f32.abs"), \
+	TOKEN(KEYWORD_F64_ABS, "f64.abs"), \
+	TOKEN(KEYWORD_F32_NEG, "f32.neg"), \
+	TOKEN(KEYWORD_F64_NEG, "f64.neg"), \
+	TOKEN(KEYWORD_F32_CMP, "f32.cmp"), \
+	TOKEN(KEYWORD_F64_CMP, "f64.cmp"), \
+	TOKEN(KEYWORD_F32_FROM_I32, "f32.from.i32"), \
+	TOKEN(KEYWORD_F32_FROM_I64, "f32.from.i64"), \
+	TOKEN(KEYWORD_F32_FROM_U32, "f32.from.u32"), \
+	TOKEN(KEYWORD_F32_FROM_U64, "f32.from.u64"), \
+	TOKEN(KEYWORD_F64_FROM_I32, "f64.from.i32"), \
+	TOKEN(KEYWORD_F64_FROM_I64, "f64.from.i64"), \
+	TOKEN(KEYWORD_F64_FROM_U32, "f64.from.u32"), \
+	TOKEN(KEYWORD_F64_FROM_U64, "f64.from.u64"), \
+	TOKEN(KEYWORD_I32_FROM_F32, "i32.from.f32"), \
+	TOKEN(KEYWORD_I32_FROM_F64, "i32.from.f64"), \
+	TOKEN(KEYWORD_I64_FROM_F32, "i64.from.f32"), \
+	TOKEN(KEYWORD_I64_FROM_F64, "i64.from.f64"), \
+	TOKEN(KEYWORD_U32_FROM_F32, "u32.from.f32"), \
+	TOKEN(KEYWORD_U32_FROM_F64, "u32.from.f64"), \
+	TOKEN(KEYWORD_U64_FROM_F32, "u64.from.f32"), \
+	TOKEN(KEYWORD_U64_FROM_F64, "u64.from.f64"), \
+	TOKEN(KEYWORD_F64_FROM_F32, "f64.from.f32"), \
+	TOKEN(KEYWORD_F32_FROM_F64, "f32.from.f64"), \
 	TOKEN(KEYWORD_JE, "je"), \
 	TOKEN(KEYWORD_JNE, "jne"), \
 	TOKEN(KEYWORD_JL, "jl"), \
@@ -132,8 +270,106 @@
 	TOKEN(KEYWORD_U16_JGE, "u16.jge"), \
 	TOKEN(KEYWORD_U32_JGE, "u32.jge"), \
 	TOKEN(KEYWORD_U64_JGE, "u64.jge"), \
+	TOKEN(KEYWORD_I8_CMOVE, "i8.cmove"), \
+	TOKEN(KEYWORD_I16_CMOVE, "i16.cmove"), \
+	TOKEN(KEYWORD_I32_CMOVE, "i32.cmove"), \
+	TOKEN(KEYWORD_I64_CMOVE, "i64.cmove"), \
+	TOKEN(KEYWORD_U8_CMOVE, "u8.cmove"), \
+	TOKEN(KEYWORD_U16_CMOVE, "u16.cmove"), \
+	TOKEN(KEYWORD_U32_CMOVE, "u32.cmove"), \
+	TOKEN(KEYWORD_U64_CMOVE, "u64.cmove"), \
+	TOKEN(KEYWORD_I8_CMOVNE, "i8.cmovne"), \
+	TOKEN(KEYWORD_I16_CMOVNE, "i16.cmovne"), \
+	TOKEN(KEYWORD_I32_CMOVNE, "i32.cmovne"), \
+	TOKEN(KEYWORD_I64_CMOVNE, "i64.cmovne"), \
+	TOKEN(KEYWORD_U8_CMOVNE, "u8.cmovne"), \
+	TOKEN(KEYWORD_U16_CMOVNE, "u16.cmovne"), \
+	TOKEN(KEYWORD_U32_CMOVNE, "u32.cmovne"), \
+	TOKEN(KEYWORD_U64_CMOVNE, "u64.cmovne"), \
+	TOKEN(KEYWORD_I8_CMOVL, "i8.cmovl"), \
+	TOKEN(KEYWORD_I16_CMOVL, "i16.cmovl"), \
+	TOKEN(KEYWORD_I32_CMOVL, "i32.cmovl"), \
+	TOKEN(KEYWORD_I64_CMOVL, "i64.cmovl"), \
+	TOKEN(KEYWORD_U8_CMOVL, "u8.cmovl"), \
+	TOKEN(KEYWORD_U16_CMOVL, "u16.cmovl"), \
+	TOKEN(KEYWORD_U32_CMOVL, "u32.cmovl"), \
+	TOKEN(KEYWORD_U64_CMOVL, "u64.cmovl"), \
+	TOKEN(KEYWORD_I8_CMOVLE, "i8.cmovle"), \
+	TOKEN(KEYWORD_I16_CMOVLE, "i16.cmovle"), \
+	TOKEN(KEYWORD_I32_CMOVLE, "i32.cmovle"), \
+	TOKEN(KEYWORD_I64_CMOVLE, "i64.cmovle"), \
+	TOKEN(KEYWORD_U8_CMOVLE, "u8.cmovle"), \
+	TOKEN(KEYWORD_U16_CMOVLE, "u16.cmovle"), \
+	TOKEN(KEYWORD_U32_CMOVLE, "u32.cmovle"), \
+	TOKEN(KEYWORD_U64_CMOVLE, "u64.cmovle"), \
+	TOKEN(KEYWORD_I8_CMOVG, "i8.cmovg"), \
+	TOKEN(KEYWORD_I16_CMOVG, "i16.cmovg"), \
+	TOKEN(KEYWORD_I32_CMOVG, "i32.cmovg"), \
+	TOKEN(KEYWORD_I64_CMOVG, "i64.cmovg"), \
+	TOKEN(KEYWORD_U8_CMOVG, "u8.cmovg"), \
+	TOKEN(KEYWORD_U16_CMOVG, "u16.cmovg"), \
+	TOKEN(KEYWORD_U32_CMOVG, "u32.cmovg"), \
+	TOKEN(KEYWORD_U64_CMOVG, "u64.cmovg"), \
+	TOKEN(KEYWORD_I8_CMOVGE, "i8.cmovge"), \
+	TOKEN(KEYWORD_I16_CMOVGE, "i16.cmovge"), \
+	TOKEN(KEYWORD_I32_CMOVGE, "i32.cmovge"), \
+	TOKEN(KEYWORD_I64_CMOVGE, "i64.cmovge"), \
+	TOKEN(KEYWORD_U8_CMOVGE, "u8.cmovge"), \
+	TOKEN(KEYWORD_U16_CMOVGE, "u16.cmovge"), \
+	TOKEN(KEYWORD_U32_CMOVGE, "u32.cmovge"), \
+	TOKEN(KEYWORD_U64_CMOVGE, "u64.cmovge"), \
+	TOKEN(KEYWORD_I8_SETE, "i8.sete"), \
+	TOKEN(KEYWORD_I16_SETE, "i16.sete"), \
+	TOKEN(KEYWORD_I32_SETE, "i32.sete"), \
+	TOKEN(KEYWORD_I64_SETE, "i64.sete"), \
+	TOKEN(KEYWORD_U8_SETE, "u8.sete"), \
+	TOKEN(KEYWORD_U16_SETE, "u16.sete"), \
+	TOKEN(KEYWORD_U32_SETE, "u32.sete"), \
+	TOKEN(KEYWORD_U64_SETE, "u64.sete"), \
+	TOKEN(KEYWORD_I8_SETNE, "i8.setne"), \
+	TOKEN(KEYWORD_I16_SETNE, "i16.setne"), \
+	TOKEN(KEYWORD_I32_SETNE, "i32.setne"), \
+	TOKEN(KEYWORD_I64_SETNE, "i64.setne"), \
+	TOKEN(KEYWORD_U8_SETNE, "u8.setne"), \
+	TOKEN(KEYWORD_U16_SETNE, "u16.setne"), \
+	TOKEN(KEYWORD_U32_SETNE, "u32.setne"), \
+	TOKEN(KEYWORD_U64_SETNE, "u64.setne"), \
+	TOKEN(KEYWORD_I8_SETL, "i8.setl"), \
+	TOKEN(KEYWORD_I16_SETL, "i16.setl"), \
+	TOKEN(KEYWORD_I32_SETL, "i32.setl"), \
+	TOKEN(KEYWORD_I64_SETL, "i64.setl"), \
+	TOKEN(KEYWORD_U8_SETL, "u8.setl"), \
+	TOKEN(KEYWORD_U16_SETL, "u16.setl"), \
+	TOKEN(KEYWORD_U32_SETL, "u32.setl"), \
+	TOKEN(KEYWORD_U64_SETL, "u64.setl"), \
+	TOKEN(KEYWORD_I8_SETLE, "i8.setle"), \
+	TOKEN(KEYWORD_I16_SETLE, "i16.setle"), \
+	TOKEN(KEYWORD_I32_SETLE, "i32.setle"), \
+	TOKEN(KEYWORD_I64_SETLE, "i64.setle"), \
+	TOKEN(KEYWORD_U8_SETLE, "u8.setle"), \
+	TOKEN(KEYWORD_U16_SETLE, "u16.setle"), \
+	TOKEN(KEYWORD_U32_SETLE, "u32.setle"), \
+	TOKEN(KEYWORD_U64_SETLE, "u64.setle"), \
+	TOKEN(KEYWORD_I8_SETG, "i8.setg"), \
+	TOKEN(KEYWORD_I16_SETG, "i16.setg"), \
+	TOKEN(KEYWORD_I32_SETG, "i32.setg"), \
+	TOKEN(KEYWORD_I64_SETG, "i64.setg"), \
+	TOKEN(KEYWORD_U8_SETG, "u8.setg"), \
+	TOKEN(KEYWORD_U16_SETG, "u16.setg"), \
+	TOKEN(KEYWORD_U32_SETG, "u32.setg"), \
+	TOKEN(KEYWORD_U64_SETG, "u64.setg"), \
+	TOKEN(KEYWORD_I8_SETGE, "i8.setge"), \
+	TOKEN(KEYWORD_I16_SETGE, "i16.setge"), \
+	TOKEN(KEYWORD_I32_SETGE, "i32.setge"), \
+	TOKEN(KEYWORD_I64_SETGE, "i64.setge"), \
+	TOKEN(KEYWORD_U8_SETGE, "u8.setge"), \
+	TOKEN(KEYWORD_U16_SETGE, "u16.setge"), \
+	TOKEN(KEYWORD_U32_SETGE, "u32.setge"), \
+	TOKEN(KEYWORD_U64_SETGE, "u64.setge"), \
 	TOKEN(KEYWORD_PUSH, "push"), \
 	TOKEN(KEYWORD_POP, "pop"), \
+	TOKEN(KEYWORD_ENTER, "enter"), \
+	TOKEN(KEYWORD_LEAVE, "leave"), \
 	TOKEN(KEYWORD_CALL, "call"), \
 	TOKEN(KEYWORD_RET, "ret"), \
 	TOKEN(KEYWORD_R0, "R0"), \
@@ -146,4 +382,5 @@
 	TOKEN(KEYWORD_R7, "R7"), \
 	TOKEN(KEYWORD_IP, "IP"), \
 	TOKEN(KEYWORD_SP, "SP"), \
+	TOKEN(KEYWORD_FP, "FP"), \
 	TOKEN(KEYWORDS__END, ""),
@@ -0,0 +1,322 @@
+#include "as/CFG.h"
+
+#include <mn/Map.h>
+#include <mn/Defer.h>
+
+namespace as
+{
+	constexpr static uint32_t ALL_REGS = (uint32_t(1) << (Tkn::KIND_KEYWORD_FP - Tkn::KIND_KEYWORD_R0 + 1)) - 1;
+
+	inline static uint32_t
+	_reg_bit(const Tkn& reg)
+	{
+		return is_reg(reg.kind) ? reg_list_bit(reg) : 0;
+	}
+
+	inline static uint32_t
+	_operand_regs(const Operand& op)
+	{
+		switch(op.kind)
+		{
+		case Operand::KIND_REG: return _reg_bit(op.reg);
+		case Operand::KIND_MEM: return _reg_bit(op.mem);
+		case Operand::KIND_REG_LIST: return op.reg_list;
+		default: return 0;
+		}
+	}
+
+	inline static bool
+	_is_full_mov(Tkn::KIND k)
+	{
+		return (k == Tkn::KIND_KEYWORD_I64_MOV ||
+				k == Tkn::KIND_KEYWORD_U64_MOV ||
+				k == Tkn::KIND_KEYWORD_F64_MOV);
+	}
+
+	// the memory operand base register is only read, a register destination is written
+	inline static void
+	_dst_write(Ins_Regs& regs, const Operand& dst, bool partial)
+	{
+		if (dst.kind == Operand::KIND_REG)
+		{
+			regs.def |= _reg_bit(dst.reg);
+			if (partial)
+				regs.use |= _reg_bit(dst.reg);
+		}
+		else
+		{
+			regs.use |= _operand_regs(dst);
+		}
+	}
+
+	inline static bool
+	_ins_is_label(const Ins& ins)
+	{
+		return ins.op.kind == Tkn::KIND_ID;
+	}
+
+	inline static bool
+	_ins_is_jump(const Ins& ins)
+	{
+		return is_pure_jump(ins.op.kind) || is_cond_jump(ins.op.kind);
+	}
+
+	inline static bool
+	_ins_is_terminator(const Ins& ins)
+	{
+		return (_ins_is_jump(ins) ||
+				ins.op.kind == Tkn::KIND_KEYWORD_RET ||
+				ins.op.kind == Tkn::KIND_KEYWORD_HALT);
+	}
+
+	inline static Basic_Block
+	_basic_block_new()
+	{
+		Basic_Block self{};
+		self.labels = mn::buf_new<Tkn>();
+		self.ins = mn::buf_new<Ins>();
+		self.regs = mn::buf_new<Ins_Regs>();
+		self.succs = mn::buf_new<size_t>();
+		return self;
+	}
+
+	// API
+	Ins_Regs
+	ins_regs(const Ins& ins)
+	{
+		Ins_Regs regs{};
+		auto k = ins.op.kind;
+		auto sp = reg_list_bit(Tkn{Tkn::KIND_KEYWORD_SP});
+		auto fp = reg_list_bit(Tkn{Tkn::KIND_KEYWORD_FP});
+
+		if (is_mov(k))
+		{
+			_dst_write(regs, ins.dst, _is_full_mov(k) == false);
+			regs.use |= _operand_regs(ins.src);
+		}
+		else if (is_set(k))
+		{
+			_dst_write(regs, ins.dst, true);
+		}
+		else if (is_arithmetic(k) || is_bitwise(k) || is_bitwise_unary(k) || is_float_unary(k) ||
+				 is_fma(k) || is_conversion(k) || is_cmov(k))
+		{
+			_dst_write(regs, ins.dst, true);
+			regs.use |= _operand_regs(ins.src) | _operand_regs(ins.src2);
+		}
+		else if (is_cmp(k) || is_cond_jump(k))
+		{
+			regs.use |= _operand_regs(ins.dst) | _operand_regs(ins.src);
+		}
+		else if (k == Tkn::KIND_KEYWORD_PUSH)
+		{
+			regs.use |= _operand_regs(ins.dst) | sp;
+			regs.def |= sp;
+		}
+		else if (k == Tkn::KIND_KEYWORD_POP)
+		{
+			// pop [r1] writes the memory so r1 is only read
+			_dst_write(regs, ins.dst, false);
+			regs.def |= sp;
+			regs.use |= sp;
+		}
+		else if (k == Tkn::KIND_KEYWORD_ENTER || k == Tkn::KIND_KEYWORD_LEAVE)
+		{
+			regs.def |= sp | fp;
+			regs.use |= sp | fp;
+		}
+		else if (k == Tkn::KIND_KEYWORD_CALL)
+		{
+			// there's no calling convention to rely on, the callee may read and write any register
+			regs.def |= ALL_REGS;
+			regs.use |= ALL_REGS;
+		}
+		else if (k == Tkn::KIND_KEYWORD_RET || k == Tkn::KIND_KEYWORD_HALT)
+		{
+			regs.use |= ALL_REGS;
+		}
+		return regs;
+	}
+
+	void
+	basic_block_free(Basic_Block& self)
+	{
+		mn::buf_free(self.labels);
+		mn::buf_free(self.ins);
+		mn::buf_free(self.regs);
+		mn::buf_free(self.succs);
+	}
+
+	CFG
+	cfg_build(const Proc& proc)
+	{
+		CFG self{};
+		self.blocks = mn::buf_new<Basic_Block>();
+
+		// split the instructions into blocks, a label starts a new block unless the current one has only
+		// labels and a terminator ends the current block
+		bool block_ended = true;
+		for (const auto& ins: proc.ins)
+		{
+			if (_ins_is_label(ins))
+			{
+				if (block_ended || mn::buf_top(self.blocks).ins.count > 0)
+					mn::buf_push(self.blocks, _basic_block_new());
+				mn::buf_push(mn::buf_top(self.blocks).labels, ins.op);
+				block_ended = false;
+				continue;
+			}
+
+			if (block_ended)
+				mn::buf_push(self.blocks, _basic_block_new());
+
+			auto& block = mn::buf_top(self.blocks);
+			mn::buf_push(block.ins, ins);
+			mn::buf_push(block.regs, ins_regs(ins));
+			block_ended = _ins_is_terminator(ins);
+		}
+
+		auto labels = mn::map_new<mn::Str, size_t>();
+		mn_defer(mn::map_free(labels));
+		for (size_t i = 0; i < self.blocks.count; ++i)
+			for (const auto& label: self.blocks[i].labels)
+				mn::map_insert(labels, mn::str_lit(label.str), i);
+
+		for (size_t i = 0; i < self.blocks.count; ++i)
+		{
+			auto& block = self.blocks[i];
+			bool falls_through = true;
+			if (block.ins.count > 0)
+			{
+				const auto& last = mn::buf_top(block.ins);
+				if (_ins_is_jump(last))
+				{
+					if (auto it = mn::map_lookup(labels, mn::str_lit(last.lbl.str)))
+						mn::buf_push(block.succs, it->value);
+					else
+						block.escapes = true;
+					falls_through = last.op.kind != Tkn::KIND_KEYWORD_JMP;
+				}
+				else if (_ins_is_terminator(last))
+				{
+					falls_through = false;
+				}
+			}
+
+			if (falls_through && i + 1 < self.blocks.count)
+				mn::buf_push(block.succs, i + 1);
+		}
+
+		return self;
+	}
+
+	void
+	cfg_free(CFG& self)
+	{
+		destruct(self.blocks);
+	}
+
+	void
+	cfg_lower(const CFG& self, Proc& proc)
+	{
+		mn::buf_clear(proc.ins);
+		for (const auto& block: self.blocks)
+		{
+			for (const auto& label: block.labels)
+			{
+				Ins ins{};
+				ins.op = label;
+				mn::buf_push(proc.ins, ins);
+			}
+
+			for (const auto& ins: block.ins)
+				mn::buf_push(proc.ins, ins);
+		}
+	}
+
+	bool
+	cfg_jumps_thread(CFG& self)
+	{
+		bool changed = false;
+		for (auto& block: self.blocks)
+		{
+			if (block.ins.count == 0 || block.escapes || _ins_is_jump(mn::buf_top(block.ins)) == false)
+				continue;
+
+			auto& jump = mn::buf_top(block.ins);
+			auto target = block.succs[0];
+			auto lbl = jump.lbl;
+			size_t hops = 0;
+			for (; hops <= self.blocks.count; ++hops)
+			{
+				const auto& next = self.blocks[target];
+				if (next.ins.count != 1 || next.ins[0].op.kind != Tkn::KIND_KEYWORD_JMP || next.escapes)
+					break;
+				lbl = next.ins[0].lbl;
+				target = next.succs[0];
+			}
+
+			// jump cycles are left as is
+			if (hops > self.blocks.count || target == block.succs[0])
+				continue;
+
+			jump.lbl = lbl;
+			block.succs[0] = target;
+			changed = true;
+		}
+		return changed;
+	}
+
+	bool
+	cfg_dead_blocks_remove(CFG& self)
+	{
+		if (self.blocks.count == 0)
+			return false;
+
+		auto reachable = mn::buf_new<bool>();
+		mn_defer(mn::buf_free(reachable));
+		mn::buf_resize_fill(reachable, self.blocks.count, false);
+
+		auto stack = mn::buf_new<size_t>();
+		mn_defer(mn::buf_free(stack));
+		mn::buf_push(stack, size_t(0));
+		reachable[0] = true;
+		while (stack.count > 0)
+		{
+			auto ix = mn::buf_top(stack);
+			mn::buf_pop(stack);
+			for (auto succ: self.blocks[ix].succs)
+			{
+				if (reachable[succ] == false)
+				{
+					reachable[succ] = true;
+					mn::buf_push(stack, succ);
+				}
+			}
+		}
+
+		// new index of each block after the removal
+		auto remap = mn::buf_new<size_t>();
+		mn_defer(mn::buf_free(remap));
+		mn::buf_resize(remap, self.blocks.count);
+
+		size_t count = 0;
+		for (size_t i = 0; i < self.blocks.count; ++i)
+		{
+			if (reachable[i] == false)
+			{
+				basic_block_free(self.blocks[i]);
+				continue;
+			}
+			remap[i] = count;
+			self.blocks[count++] = self.blocks[i];
+		}
+
+		bool changed = count != self.blocks.count;
+		self.blocks.count = count;
+		for (auto& block: self.blocks)
+			for (auto& succ: block.succs)
+				succ = remap[succ];
+		return changed;
+	}
+}
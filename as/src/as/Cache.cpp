@@ -0,0 +1,205 @@
+#include "as/Cache.h"
+
+#include <mn/File.h>
+#include <mn/Path.h>
+#include <mn/Defer.h>
+
+#include <assert.h>
+
+namespace as
+{
+	// bump the version whenever the generated bytecode changes so old caches are discarded
+	constexpr static uint32_t CACHE_MAGIC = 0x43534154; // "TASC"
+	constexpr static uint32_t CACHE_VERSION = 2;
+
+	inline static void
+	_cache_entry_free(Cache_Entry& self)
+	{
+		mn::buf_free(self.bytes);
+		for (auto& reloc: self.relocs)
+			mn::str_free(reloc.target);
+		mn::buf_free(self.relocs);
+		mn::buf_free(self.lines);
+		destruct(self.labels);
+	}
+
+	template<typename T>
+	inline static bool
+	_read(mn::Stream in, T& v)
+	{
+		return mn::stream_read(in, mn::block_from(v)) == sizeof(v);
+	}
+
+	inline static bool
+	_read_bytes(mn::Stream in, mn::Buf<uint8_t>& bytes)
+	{
+		uint32_t len = 0;
+		if (_read(in, len) == false)
+			return false;
+		mn::buf_resize(bytes, len);
+		return mn::stream_read(in, mn::block_from(bytes)) == size_t(len);
+	}
+
+	inline static bool
+	_read_string(mn::Stream in, mn::Str& str)
+	{
+		uint32_t len = 0;
+		if (_read(in, len) == false)
+			return false;
+		mn::str_resize(str, len);
+		return mn::stream_read(in, mn::block_from(str)) == size_t(len);
+	}
+
+	inline static void
+	_write_bytes(mn::Stream out, mn::Block bytes)
+	{
+		uint32_t len = uint32_t(bytes.size);
+		mn::stream_write(out, mn::block_from(len));
+		mn::stream_write(out, bytes);
+	}
+
+	inline static bool
+	_cache_entry_load(mn::Stream in, Cache_Entry& self)
+	{
+		if (_read_bytes(in, self.bytes) == false)
+			return false;
+
+		uint32_t relocs_count = 0;
+		if (_read(in, relocs_count) == false)
+			return false;
+
+		for (uint32_t i = 0; i < relocs_count; ++i)
+		{
+			mn::buf_push(self.relocs, Cache_Reloc{0, mn::str_new(), 0});
+			auto& reloc = mn::buf_top(self.relocs);
+			if (_read(in, reloc.bytecode_index) == false ||
+				_read_string(in, reloc.target) == false ||
+				_read(in, reloc.width) == false)
+				return false;
+		}
+
+		uint32_t lines_count = 0;
+		if (_read(in, lines_count) == false)
+			return false;
+		mn::buf_resize(self.lines, lines_count);
+		if (mn::stream_read(in, mn::block_from(self.lines)) != lines_count * sizeof(vm::Debug_Line))
+			return false;
+
+		uint32_t labels_count = 0;
+		if (_read(in, labels_count) == false)
+			return false;
+
+		for (uint32_t i = 0; i < labels_count; ++i)
+		{
+			mn::buf_push(self.labels, vm::Debug_Label{mn::str_new(), 0});
+			auto& label = mn::buf_top(self.labels);
+			if (_read_string(in, label.name) == false ||
+				_read(in, label.offset) == false)
+				return false;
+		}
+		return true;
+	}
+
+	// API
+	Cache
+	cache_new()
+	{
+		Cache self{};
+		self.entries = mn::map_new<uint64_t, Cache_Entry>();
+		return self;
+	}
+
+	void
+	cache_free(Cache& self)
+	{
+		for (auto& [_, entry]: self.entries)
+			_cache_entry_free(entry);
+		mn::map_free(self.entries);
+	}
+
+	Cache
+	cache_load(const mn::Str& filename)
+	{
+		auto self = cache_new();
+		if (mn::path_is_file(filename) == false)
+			return self;
+
+		auto f = mn::file_open(filename, mn::IO_MODE::READ, mn::OPEN_MODE::OPEN_ONLY);
+		if (f == nullptr)
+			return self;
+		mn_defer(mn::file_close(f));
+
+		uint32_t magic = 0, version = 0;
+		uint64_t entries_count = 0;
+		if (_read(f, magic) == false || magic != CACHE_MAGIC ||
+			_read(f, version) == false || version != CACHE_VERSION ||
+			_read(f, entries_count) == false)
+			return self;
+
+		for (uint64_t i = 0; i < entries_count; ++i)
+		{
+			uint64_t hash = 0;
+			Cache_Entry entry{};
+			entry.bytes = mn::buf_new<uint8_t>();
+			entry.relocs = mn::buf_new<Cache_Reloc>();
+			entry.lines = mn::buf_new<vm::Debug_Line>();
+			entry.labels = mn::buf_new<vm::Debug_Label>();
+			if (_read(f, hash) == false || _cache_entry_load(f, entry) == false)
+			{
+				// a truncated cache is discarded altogether
+				_cache_entry_free(entry);
+				cache_free(self);
+				return cache_new();
+			}
+			mn::map_insert(self.entries, hash, entry);
+		}
+		return self;
+	}
+
+	void
+	cache_save(const Cache& self, const mn::Str& filename)
+	{
+		auto f = mn::file_open(filename, mn::IO_MODE::WRITE, mn::OPEN_MODE::CREATE_OVERWRITE);
+		assert(f != nullptr);
+		mn_defer(mn::file_close(f));
+
+		uint64_t entries_count = 0;
+		for (const auto& [_, entry]: self.entries)
+			if (entry.used)
+				++entries_count;
+
+		mn::stream_write(f, mn::block_from(CACHE_MAGIC));
+		mn::stream_write(f, mn::block_from(CACHE_VERSION));
+		mn::stream_write(f, mn::block_from(entries_count));
+
+		for (const auto& [hash, entry]: self.entries)
+		{
+			if (entry.used == false)
+				continue;
+
+			mn::stream_write(f, mn::block_from(hash));
+			_write_bytes(f, mn::block_from(entry.bytes));
+
+			uint32_t relocs_count = uint32_t(entry.relocs.count);
+			mn::stream_write(f, mn::block_from(relocs_count));
+			for (const auto& reloc: entry.relocs)
+			{
+				mn::stream_write(f, mn::block_from(reloc.bytecode_index));
+				_write_bytes(f, mn::block_from(reloc.target));
+				mn::stream_write(f, mn::block_from(reloc.width));
+			}
+
+			uint32_t lines_count = uint32_t(entry.lines.count);
+			mn::stream_write(f, mn::block_from(lines_count));
+			mn::stream_write(f, mn::block_from(entry.lines));
+
+			uint32_t labels_count = uint32_t(entry.labels.count);
+			mn::stream_write(f, mn::block_from(labels_count));
+			for (const auto& label: entry.labels)
+			{
+				_write_bytes(f, mn::block_from(label.name));
+				mn::stream_write(f, mn::block_from(label.offset));
+			}
+		}
+	}
+}
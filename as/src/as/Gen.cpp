@@ -1,5 +1,8 @@
 #include "as/Gen.h"
 #include "as/Src.h"
+#include "as/Parse.h"
+#include "as/Cache.h"
+#include "Parallel.h"
 
 #include <vm/Util.h>
 #include <vm/Op.h>
@@ -13,8 +16,25 @@
 
 #include <assert.h>
 
+#include <algorithm>
+
 namespace as
 {
+	inline static void
+	write8(uint8_t* ptr, uint8_t v)
+	{
+		ptr[0] = v;
+	}
+
+	inline static void
+	write32(uint8_t* ptr, uint32_t v)
+	{
+		ptr[0] = uint8_t(v);
+		ptr[1] = uint8_t(v >> 8);
+		ptr[2] = uint8_t(v >> 16);
+		ptr[3] = uint8_t(v >> 24);
+	}
+
 	inline static void
 	write64(uint8_t* ptr, uint64_t v)
 	{
@@ -32,36 +52,81 @@ namespace as
 	{
 		Tkn name;
 		size_t bytecode_index;
+		// size of the jump offset in bytes
+		uint8_t size;
 	};
 
-	struct Emitter
+	struct Reloc_Request
+	{
+		Tkn target;
+		size_t bytecode_index;
+		// size of the relocated value in bytes
+		uint8_t width;
+	};
+
+	// global symbol along with the src it's declared in
+	struct Global
 	{
 		Src* src;
+		Tkn name;
+	};
+
+	// location of the global symbol relative to the given src, the path is omitted for the same src
+	inline static mn::Str
+	global_location(const Global& self, const Src* src)
+	{
+		if (self.src == src)
+			return mn::strf("{}:{}", self.name.pos.line, self.name.pos.col);
+		return mn::strf("{}:{}:{}", self.src->path, self.name.pos.line, self.name.pos.col);
+	}
+
+	// emitters only share the read only globals so procs can be generated in parallel, errors are
+	// collected in the emitter and moved to the src later in the same order as the serial build
+	struct Emitter
+	{
+		// src of the proc, errors aren't reported to it directly
+		const Src* src;
+		mn::Buf<Err> errs;
 		mn::Buf<uint8_t> out;
 		mn::Buf<Fixup_Request> fixups;
+		mn::Buf<Reloc_Request> relocs;
+		// offset size of each jump in the proc, indexed the same as fixups
+		mn::Buf<uint8_t> jump_sizes;
 		mn::Map<const char*, size_t> symbols;
 		// pointer to the globals symbols to check local symbols against
-		mn::Map<const char*, Tkn> *globals;
+		mn::Map<mn::Str, Global> *globals;
+		// source line of each instruction, only filled when generating debug info
+		bool debug;
+		mn::Buf<vm::Debug_Line> lines;
 	};
 
 	inline static Emitter
-	emitter_new(Src* src, mn::Map<const char*, Tkn> *globals)
+	emitter_new(const Src* src, mn::Map<mn::Str, Global> *globals, bool debug)
 	{
 		Emitter self{};
 		self.src = src;
+		self.errs = mn::buf_new<Err>();
 		self.out = mn::buf_new<uint8_t>();
 		self.fixups = mn::buf_new<Fixup_Request>();
+		self.relocs = mn::buf_new<Reloc_Request>();
+		self.jump_sizes = mn::buf_new<uint8_t>();
 		self.symbols = mn::map_new<const char*, uint64_t>();
 		self.globals = globals;
+		self.debug = debug;
+		self.lines = mn::buf_new<vm::Debug_Line>();
 		return self;
 	}
 
 	inline static void
 	emitter_free(Emitter& self)
 	{
+		destruct(self.errs);
 		mn::buf_free(self.out);
 		mn::buf_free(self.fixups);
+		mn::buf_free(self.relocs);
+		mn::buf_free(self.jump_sizes);
 		mn::map_free(self.symbols);
+		mn::buf_free(self.lines);
 	}
 
 	inline static void
@@ -70,15 +135,32 @@ namespace as
 		emitter_free(self);
 	}
 
+	inline static void
+	emitter_err(Emitter& self, const Tkn& tkn, const mn::Str& msg)
+	{
+		mn::buf_push(self.errs, err_tkn(tkn, msg));
+	}
+
+	// moves the emitter errors to the src
+	inline static void
+	emitter_errs_flush(Emitter& self, Src* src)
+	{
+		for(const auto& e: self.errs)
+			src_err(src, e);
+		mn::buf_clear(self.errs);
+	}
+
 	inline static void
 	emitter_register_symbol(Emitter& self, const Tkn& label)
 	{
 		// check global symbols
 		assert(self.globals != nullptr);
 
-		if(auto it = mn::map_lookup(*self.globals, label.str))
+		if(auto it = mn::map_lookup(*self.globals, mn::str_lit(label.str)))
 		{
-			src_err(self.src, label, mn::strf("global symbol redefinition, it was first defined in {}:{}", it->value.pos.line, it->value.pos.col));
+			auto location = global_location(it->value, self.src);
+			mn_defer(mn::str_free(location));
+			emitter_err(self, label, mn::strf("global symbol redefinition, it was first defined in {}", location));
 		}
 
 		if (mn::map_lookup(self.symbols, label.str) == nullptr)
@@ -87,7 +169,7 @@ namespace as
 		}
 		else
 		{
-			src_err(self.src, label, mn::strf("'{}' local symbol redefinition", label.str));
+			emitter_err(self, label, mn::strf("'{}' local symbol redefinition", label.str));
 		}
 	}
 
@@ -106,6 +188,7 @@ namespace as
 		case Tkn::KIND_KEYWORD_R7: return vm::Reg_R7;
 		case Tkn::KIND_KEYWORD_IP: return vm::Reg_IP;
 		case Tkn::KIND_KEYWORD_SP: return vm::Reg_SP;
+		case Tkn::KIND_KEYWORD_FP: return vm::Reg_FP;
 		default:				   return vm::Reg_COUNT;
 		}
 	}
@@ -131,6 +214,34 @@ namespace as
 		return c;
 	}
 
+	inline static int32_t
+	operand_disp(const Operand& op)
+	{
+		auto disp = convert_to<int32_t>(op.disp);
+		if (op.disp_op.kind == Tkn::KIND_MINUS)
+			disp = -disp;
+		return disp;
+	}
+
+	// converts the register list operand to a vm register mask
+	inline static uint16_t
+	reg_list_mask(const Operand& op)
+	{
+		assert(op.kind == Operand::KIND_REG_LIST);
+
+		uint16_t mask = 0;
+		for(uint32_t i = 0; i < 32; ++i)
+		{
+			if ((op.reg_list & (uint32_t(1) << i)) == 0)
+				continue;
+
+			Tkn reg{};
+			reg.kind = Tkn::KIND(Tkn::KIND_KEYWORD_R0 + i);
+			mask |= uint16_t(1 << tkn_to_reg(reg));
+		}
+		return mask;
+	}
+
 	template<typename T>
 	inline static vm::Operand
 	op_convert(const Operand &op)
@@ -140,6 +251,8 @@ namespace as
 		case Operand::KIND_REG:
 			return vm::op_reg(tkn_to_reg(op.reg));
 		case Operand::KIND_MEM:
+			if (op.disp)
+				return vm::op_mem_disp(tkn_to_reg(op.mem), operand_disp(op));
 			return vm::op_mem(tkn_to_reg(op.mem));
 		case Operand::KIND_IMM:
 			return vm::op_imm(convert_to<T>(op.imm));
@@ -151,8 +264,62 @@ namespace as
 		}
 	}
 
+	// returns the encoding of the given jump op with the given offset size
+	inline static vm::Op
+	jump_op(vm::Op op, uint8_t size)
+	{
+		if (size == sizeof(int64_t))
+			return op;
+
+		bool is_short = size == sizeof(int8_t);
+		switch(op)
+		{
+		case vm::Op_JMP: return is_short ? vm::Op_JMP8 : vm::Op_JMP32;
+		case vm::Op_JE: return is_short ? vm::Op_JE8 : vm::Op_JE32;
+		case vm::Op_JNE: return is_short ? vm::Op_JNE8 : vm::Op_JNE32;
+		case vm::Op_JL: return is_short ? vm::Op_JL8 : vm::Op_JL32;
+		case vm::Op_JLE: return is_short ? vm::Op_JLE8 : vm::Op_JLE32;
+		case vm::Op_JG: return is_short ? vm::Op_JG8 : vm::Op_JG32;
+		case vm::Op_JGE: return is_short ? vm::Op_JGE8 : vm::Op_JGE32;
+		default: assert(false && "unreachable"); return vm::Op_IGL;
+		}
+	}
+
+	inline static bool
+	jump_offset_fits(int64_t offset, uint8_t size)
+	{
+		switch(size)
+		{
+		case sizeof(int8_t): return offset >= INT8_MIN && offset <= INT8_MAX;
+		case sizeof(int32_t): return offset >= INT32_MIN && offset <= INT32_MAX;
+		default: return true;
+		}
+	}
+
+	inline static void
+	emitter_jump_gen(Emitter& self, vm::Op op, const Tkn& lbl)
+	{
+		// jumps start with the short form, relaxation grows them later if needed
+		auto jump_index = self.fixups.count;
+		if (jump_index == self.jump_sizes.count)
+			mn::buf_push(self.jump_sizes, uint8_t(sizeof(int8_t)));
+		auto size = self.jump_sizes[jump_index];
+
+		vm::Operand offset{};
+		switch(size)
+		{
+		case sizeof(int8_t): offset = vm::op_imm(int8_t(0)); break;
+		case sizeof(int32_t): offset = vm::op_imm(int32_t(0)); break;
+		case sizeof(int64_t): offset = vm::op_imm(int64_t(0)); break;
+		default: assert(false && "unreachable"); break;
+		}
+
+		auto [dst_offset, _] = vm::ins_push(self.out, jump_op(op, size), offset, vm::op_none());
+		mn::buf_push(self.fixups, Fixup_Request{ lbl, dst_offset, size });
+	}
+
 	inline static void
-	emitter_ins_gen(Emitter& self, const Ins& ins, const Proc& proc, vm::Pkg& pkg)
+	emitter_ins_gen(Emitter& self, const Ins& ins)
 	{
 		switch(ins.op.kind)
 		{
@@ -210,14 +377,7 @@ namespace as
 			auto src = op_convert<int64_t>(ins.src);
 			auto [dst_offset, src_offset] = vm::ins_push(self.out, vm::Op_MOV64, dst, src);
 			if (ins.src.kind == Operand::KIND_ID)
-			{
-				vm::pkg_reloc_add(
-					pkg,
-					mn::str_lit(proc.name.str),
-					src_offset,
-					mn::str_lit(ins.src.id.str)
-				);
-			}
+				mn::buf_push(self.relocs, Reloc_Request{ ins.src.id, src_offset, sizeof(uint64_t) });
 			break;
 		}
 
@@ -227,14 +387,8 @@ namespace as
 			auto src = op_convert<uint64_t>(ins.src);
 			auto [dst_offset, src_offset] = vm::ins_push(self.out, vm::Op_MOV64, dst, src);
 			if (ins.src.kind == Operand::KIND_ID)
-			{
-				vm::pkg_reloc_add(
-					pkg,
-					mn::str_lit(proc.name.str),
-					src_offset,
-					mn::str_lit(ins.src.id.str)
-				);
-			}
+				mn::buf_push(self.relocs, Reloc_Request{ ins.src.id, src_offset, sizeof(uint64_t) });
+			break;
 		}
 
 
@@ -498,676 +652,2488 @@ namespace as
 		}
 
 
-		case Tkn::KIND_KEYWORD_I8_JE:
+		case Tkn::KIND_KEYWORD_I8_AND:
 		{
 			auto dst = op_convert<int8_t>(ins.dst);
 			auto src = op_convert<int8_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP8, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_AND8, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I16_JE:
+		case Tkn::KIND_KEYWORD_I16_AND:
 		{
 			auto dst = op_convert<int16_t>(ins.dst);
 			auto src = op_convert<int16_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP16, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_AND16, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I32_JE:
+		case Tkn::KIND_KEYWORD_I32_AND:
 		{
 			auto dst = op_convert<int32_t>(ins.dst);
 			auto src = op_convert<int32_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP32, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_AND32, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I64_JE:
+		case Tkn::KIND_KEYWORD_I64_AND:
 		{
 			auto dst = op_convert<int64_t>(ins.dst);
 			auto src = op_convert<int64_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP64, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_AND64, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U8_JE:
+		case Tkn::KIND_KEYWORD_U8_AND:
 		{
 			auto dst = op_convert<uint8_t>(ins.dst);
 			auto src = op_convert<uint8_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP8, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_AND8, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U16_JE:
+		case Tkn::KIND_KEYWORD_U16_AND:
 		{
 			auto dst = op_convert<uint16_t>(ins.dst);
 			auto src = op_convert<uint16_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP16, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_AND16, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U32_JE:
+		case Tkn::KIND_KEYWORD_U32_AND:
 		{
 			auto dst = op_convert<uint32_t>(ins.dst);
 			auto src = op_convert<uint32_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP32, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_AND32, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U64_JE:
+		case Tkn::KIND_KEYWORD_U64_AND:
 		{
 			auto dst = op_convert<uint64_t>(ins.dst);
 			auto src = op_convert<uint64_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP64, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_AND64, dst, src);
 			break;
 		}
 
 
-		case Tkn::KIND_KEYWORD_I8_JNE:
+		case Tkn::KIND_KEYWORD_I8_OR:
 		{
 			auto dst = op_convert<int8_t>(ins.dst);
 			auto src = op_convert<int8_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP8, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JNE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_OR8, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I16_JNE:
+		case Tkn::KIND_KEYWORD_I16_OR:
 		{
 			auto dst = op_convert<int16_t>(ins.dst);
 			auto src = op_convert<int16_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP16, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JNE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_OR16, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I32_JNE:
+		case Tkn::KIND_KEYWORD_I32_OR:
 		{
 			auto dst = op_convert<int32_t>(ins.dst);
 			auto src = op_convert<int32_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP32, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JNE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_OR32, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I64_JNE:
+		case Tkn::KIND_KEYWORD_I64_OR:
 		{
 			auto dst = op_convert<int64_t>(ins.dst);
 			auto src = op_convert<int64_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP64, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JNE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_OR64, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U8_JNE:
+		case Tkn::KIND_KEYWORD_U8_OR:
 		{
 			auto dst = op_convert<uint8_t>(ins.dst);
 			auto src = op_convert<uint8_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP8, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JNE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_OR8, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U16_JNE:
+		case Tkn::KIND_KEYWORD_U16_OR:
 		{
 			auto dst = op_convert<uint16_t>(ins.dst);
 			auto src = op_convert<uint16_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP16, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JNE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_OR16, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U32_JNE:
+		case Tkn::KIND_KEYWORD_U32_OR:
 		{
 			auto dst = op_convert<uint32_t>(ins.dst);
 			auto src = op_convert<uint32_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP32, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JNE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_OR32, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U64_JNE:
+		case Tkn::KIND_KEYWORD_U64_OR:
 		{
 			auto dst = op_convert<uint64_t>(ins.dst);
 			auto src = op_convert<uint64_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP64, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JNE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_OR64, dst, src);
 			break;
 		}
 
 
-		case Tkn::KIND_KEYWORD_I8_JL:
+		case Tkn::KIND_KEYWORD_I8_XOR:
 		{
 			auto dst = op_convert<int8_t>(ins.dst);
 			auto src = op_convert<int8_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP8, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JL, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_XOR8, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I16_JL:
+		case Tkn::KIND_KEYWORD_I16_XOR:
 		{
 			auto dst = op_convert<int16_t>(ins.dst);
 			auto src = op_convert<int16_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP16, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JL, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_XOR16, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I32_JL:
+		case Tkn::KIND_KEYWORD_I32_XOR:
 		{
 			auto dst = op_convert<int32_t>(ins.dst);
 			auto src = op_convert<int32_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP32, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JL, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_XOR32, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I64_JL:
+		case Tkn::KIND_KEYWORD_I64_XOR:
 		{
 			auto dst = op_convert<int64_t>(ins.dst);
 			auto src = op_convert<int64_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP64, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JL, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_XOR64, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U8_JL:
+		case Tkn::KIND_KEYWORD_U8_XOR:
 		{
 			auto dst = op_convert<uint8_t>(ins.dst);
 			auto src = op_convert<uint8_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP8, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JL, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_XOR8, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U16_JL:
+		case Tkn::KIND_KEYWORD_U16_XOR:
 		{
 			auto dst = op_convert<uint16_t>(ins.dst);
 			auto src = op_convert<uint16_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP16, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JL, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_XOR16, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U32_JL:
+		case Tkn::KIND_KEYWORD_U32_XOR:
 		{
 			auto dst = op_convert<uint32_t>(ins.dst);
 			auto src = op_convert<uint32_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP32, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JL, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_XOR32, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U64_JL:
+		case Tkn::KIND_KEYWORD_U64_XOR:
 		{
 			auto dst = op_convert<uint64_t>(ins.dst);
 			auto src = op_convert<uint64_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP64, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JL, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_XOR64, dst, src);
 			break;
 		}
 
 
-		case Tkn::KIND_KEYWORD_I8_JLE:
+		case Tkn::KIND_KEYWORD_I8_NOT:
 		{
 			auto dst = op_convert<int8_t>(ins.dst);
-			auto src = op_convert<int8_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP8, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JLE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_NOT8, dst, vm::op_none());
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I16_JLE:
+		case Tkn::KIND_KEYWORD_I16_NOT:
 		{
 			auto dst = op_convert<int16_t>(ins.dst);
-			auto src = op_convert<int16_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP16, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JLE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_NOT16, dst, vm::op_none());
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I32_JLE:
+		case Tkn::KIND_KEYWORD_I32_NOT:
 		{
 			auto dst = op_convert<int32_t>(ins.dst);
-			auto src = op_convert<int32_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP32, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JLE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_NOT32, dst, vm::op_none());
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I64_JLE:
+		case Tkn::KIND_KEYWORD_I64_NOT:
 		{
 			auto dst = op_convert<int64_t>(ins.dst);
-			auto src = op_convert<int64_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP64, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JLE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_NOT64, dst, vm::op_none());
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U8_JLE:
+		case Tkn::KIND_KEYWORD_U8_NOT:
 		{
 			auto dst = op_convert<uint8_t>(ins.dst);
-			auto src = op_convert<uint8_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP8, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JLE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_NOT8, dst, vm::op_none());
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U16_JLE:
+		case Tkn::KIND_KEYWORD_U16_NOT:
 		{
 			auto dst = op_convert<uint16_t>(ins.dst);
-			auto src = op_convert<uint16_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP16, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JLE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_NOT16, dst, vm::op_none());
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U32_JLE:
+		case Tkn::KIND_KEYWORD_U32_NOT:
 		{
 			auto dst = op_convert<uint32_t>(ins.dst);
-			auto src = op_convert<uint32_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP32, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JLE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_NOT32, dst, vm::op_none());
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U64_JLE:
+		case Tkn::KIND_KEYWORD_U64_NOT:
 		{
 			auto dst = op_convert<uint64_t>(ins.dst);
-			auto src = op_convert<uint64_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP64, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JLE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_NOT64, dst, vm::op_none());
 			break;
 		}
 
 
-		case Tkn::KIND_KEYWORD_I8_JG:
+		case Tkn::KIND_KEYWORD_I8_SHL:
 		{
 			auto dst = op_convert<int8_t>(ins.dst);
 			auto src = op_convert<int8_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP8, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JG, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_SHL8, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I16_JG:
+		case Tkn::KIND_KEYWORD_I16_SHL:
 		{
 			auto dst = op_convert<int16_t>(ins.dst);
 			auto src = op_convert<int16_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP16, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JG, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_SHL16, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I32_JG:
+		case Tkn::KIND_KEYWORD_I32_SHL:
 		{
 			auto dst = op_convert<int32_t>(ins.dst);
 			auto src = op_convert<int32_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP32, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JG, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_SHL32, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I64_JG:
+		case Tkn::KIND_KEYWORD_I64_SHL:
 		{
 			auto dst = op_convert<int64_t>(ins.dst);
 			auto src = op_convert<int64_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP64, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JG, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_SHL64, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U8_JG:
+		case Tkn::KIND_KEYWORD_U8_SHL:
 		{
 			auto dst = op_convert<uint8_t>(ins.dst);
 			auto src = op_convert<uint8_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP8, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JG, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_SHL8, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U16_JG:
+		case Tkn::KIND_KEYWORD_U16_SHL:
 		{
 			auto dst = op_convert<uint16_t>(ins.dst);
 			auto src = op_convert<uint16_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP16, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JG, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_SHL16, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U32_JG:
+		case Tkn::KIND_KEYWORD_U32_SHL:
 		{
 			auto dst = op_convert<uint32_t>(ins.dst);
 			auto src = op_convert<uint32_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP32, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JG, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_SHL32, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U64_JG:
+		case Tkn::KIND_KEYWORD_U64_SHL:
 		{
 			auto dst = op_convert<uint64_t>(ins.dst);
 			auto src = op_convert<uint64_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP64, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JG, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_SHL64, dst, src);
 			break;
 		}
 
 
-		case Tkn::KIND_KEYWORD_I8_JGE:
+		case Tkn::KIND_KEYWORD_I8_SHR:
 		{
 			auto dst = op_convert<int8_t>(ins.dst);
 			auto src = op_convert<int8_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP8, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JGE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_SAR8, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I16_JGE:
+		case Tkn::KIND_KEYWORD_I16_SHR:
 		{
 			auto dst = op_convert<int16_t>(ins.dst);
 			auto src = op_convert<int16_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP16, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JGE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_SAR16, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I32_JGE:
+		case Tkn::KIND_KEYWORD_I32_SHR:
 		{
 			auto dst = op_convert<int32_t>(ins.dst);
 			auto src = op_convert<int32_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP32, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JGE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_SAR32, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I64_JGE:
+		case Tkn::KIND_KEYWORD_I64_SHR:
 		{
 			auto dst = op_convert<int64_t>(ins.dst);
 			auto src = op_convert<int64_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP64, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JGE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_SAR64, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U8_JGE:
+		case Tkn::KIND_KEYWORD_U8_SHR:
 		{
 			auto dst = op_convert<uint8_t>(ins.dst);
 			auto src = op_convert<uint8_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP8, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JGE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_SHR8, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U16_JGE:
+		case Tkn::KIND_KEYWORD_U16_SHR:
 		{
 			auto dst = op_convert<uint16_t>(ins.dst);
 			auto src = op_convert<uint16_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP16, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JGE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_SHR16, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U32_JGE:
+		case Tkn::KIND_KEYWORD_U32_SHR:
 		{
 			auto dst = op_convert<uint32_t>(ins.dst);
 			auto src = op_convert<uint32_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP32, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JGE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_SHR32, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U64_JGE:
+		case Tkn::KIND_KEYWORD_U64_SHR:
 		{
 			auto dst = op_convert<uint64_t>(ins.dst);
 			auto src = op_convert<uint64_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP64, dst, src);
-
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JGE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			vm::ins_push(self.out, vm::Op_SHR64, dst, src);
 			break;
 		}
 
 
-		case Tkn::KIND_KEYWORD_JMP:
+		case Tkn::KIND_KEYWORD_I8_ROL:
 		{
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JMP, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ROL8, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_JE:
+		case Tkn::KIND_KEYWORD_I16_ROL:
 		{
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ROL16, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_JNE:
+		case Tkn::KIND_KEYWORD_I32_ROL:
 		{
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JNE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ROL32, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_JL:
+		case Tkn::KIND_KEYWORD_I64_ROL:
 		{
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JL, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ROL64, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_JLE:
+		case Tkn::KIND_KEYWORD_U8_ROL:
 		{
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JLE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ROL8, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_JG:
+		case Tkn::KIND_KEYWORD_U16_ROL:
 		{
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JG, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ROL16, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_JGE:
+		case Tkn::KIND_KEYWORD_U32_ROL:
 		{
-			auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_JGE, vm::op_imm(uint64_t(0)), vm::op_none());
-			mn::buf_push(self.fixups, Fixup_Request{ ins.lbl, dst_offset });
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ROL32, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_PUSH:
+		case Tkn::KIND_KEYWORD_U64_ROL:
 		{
 			auto dst = op_convert<uint64_t>(ins.dst);
-			vm::ins_push(self.out, vm::Op_PUSH, dst, vm::op_none());
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ROL64, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_POP:
+
+		case Tkn::KIND_KEYWORD_I8_ROR:
 		{
-			auto dst = op_convert<uint64_t>(ins.dst);
-			vm::ins_push(self.out, vm::Op_POP, dst, vm::op_none());
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ROR8, dst, src);
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_CALL:
+		case Tkn::KIND_KEYWORD_I16_ROR:
 		{
-			vm::Op op = vm::Op_IGL;
-			if (mn::str_prefix(ins.lbl.str, "C."))
-				op = vm::Op_C_CALL;
-			else
-				op = vm::Op_CALL;
-
-			auto [dst_offset, _] = vm::ins_push(self.out, op, vm::op_imm(uint64_t(0)), vm::op_none());
-			vm::pkg_reloc_add(pkg, mn::str_lit(proc.name.str), dst_offset, mn::str_lit(ins.lbl.str));
-			break;
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ROR16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_ROR:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ROR32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_ROR:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ROR64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_ROR:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ROR8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_ROR:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ROR16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_ROR:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ROR32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_ROR:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ROR64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_POPCNT:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_POPCNT8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_POPCNT:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_POPCNT16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_POPCNT:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_POPCNT32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_POPCNT:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_POPCNT64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_POPCNT:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_POPCNT8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_POPCNT:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_POPCNT16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_POPCNT:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_POPCNT32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_POPCNT:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_POPCNT64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_CLZ:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CLZ8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_CLZ:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CLZ16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_CLZ:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CLZ32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_CLZ:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CLZ64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_CLZ:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CLZ8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_CLZ:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CLZ16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_CLZ:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CLZ32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_CLZ:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CLZ64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_CTZ:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CTZ8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_CTZ:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CTZ16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_CTZ:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CTZ32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_CTZ:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CTZ64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_CTZ:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CTZ8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_CTZ:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CTZ16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_CTZ:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CTZ32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_CTZ:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CTZ64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I16_BSWAP:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_BSWAP16, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_BSWAP:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_BSWAP32, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_BSWAP:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_BSWAP64, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_BSWAP:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_BSWAP16, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_BSWAP:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_BSWAP32, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_BSWAP:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_BSWAP64, dst, vm::op_none());
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_F32_MOV:
+		{
+			auto dst = op_convert<float>(ins.dst);
+			auto src = op_convert<float>(ins.src);
+			vm::ins_push(self.out, vm::Op_MOV32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F64_MOV:
+		{
+			auto dst = op_convert<double>(ins.dst);
+			auto src = op_convert<double>(ins.src);
+			vm::ins_push(self.out, vm::Op_MOV64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_F32_ADD:
+		{
+			auto dst = op_convert<float>(ins.dst);
+			auto src = op_convert<float>(ins.src);
+			vm::ins_push(self.out, vm::Op_FADD32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F64_ADD:
+		{
+			auto dst = op_convert<double>(ins.dst);
+			auto src = op_convert<double>(ins.src);
+			vm::ins_push(self.out, vm::Op_FADD64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_F32_SUB:
+		{
+			auto dst = op_convert<float>(ins.dst);
+			auto src = op_convert<float>(ins.src);
+			vm::ins_push(self.out, vm::Op_FSUB32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F64_SUB:
+		{
+			auto dst = op_convert<double>(ins.dst);
+			auto src = op_convert<double>(ins.src);
+			vm::ins_push(self.out, vm::Op_FSUB64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_F32_MUL:
+		{
+			auto dst = op_convert<float>(ins.dst);
+			auto src = op_convert<float>(ins.src);
+			vm::ins_push(self.out, vm::Op_FMUL32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F64_MUL:
+		{
+			auto dst = op_convert<double>(ins.dst);
+			auto src = op_convert<double>(ins.src);
+			vm::ins_push(self.out, vm::Op_FMUL64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_F32_DIV:
+		{
+			auto dst = op_convert<float>(ins.dst);
+			auto src = op_convert<float>(ins.src);
+			vm::ins_push(self.out, vm::Op_FDIV32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F64_DIV:
+		{
+			auto dst = op_convert<double>(ins.dst);
+			auto src = op_convert<double>(ins.src);
+			vm::ins_push(self.out, vm::Op_FDIV64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_F32_SQRT:
+		{
+			auto dst = op_convert<float>(ins.dst);
+			auto src = op_convert<float>(ins.src);
+			vm::ins_push(self.out, vm::Op_FSQRT32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F64_SQRT:
+		{
+			auto dst = op_convert<double>(ins.dst);
+			auto src = op_convert<double>(ins.src);
+			vm::ins_push(self.out, vm::Op_FSQRT64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_F32_MIN:
+		{
+			auto dst = op_convert<float>(ins.dst);
+			auto src = op_convert<float>(ins.src);
+			vm::ins_push(self.out, vm::Op_FMIN32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F64_MIN:
+		{
+			auto dst = op_convert<double>(ins.dst);
+			auto src = op_convert<double>(ins.src);
+			vm::ins_push(self.out, vm::Op_FMIN64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_F32_MAX:
+		{
+			auto dst = op_convert<float>(ins.dst);
+			auto src = op_convert<float>(ins.src);
+			vm::ins_push(self.out, vm::Op_FMAX32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F64_MAX:
+		{
+			auto dst = op_convert<double>(ins.dst);
+			auto src = op_convert<double>(ins.src);
+			vm::ins_push(self.out, vm::Op_FMAX64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_F32_CMP:
+		{
+			auto dst = op_convert<float>(ins.dst);
+			auto src = op_convert<float>(ins.src);
+			vm::ins_push(self.out, vm::Op_FCMP32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F64_CMP:
+		{
+			auto dst = op_convert<double>(ins.dst);
+			auto src = op_convert<double>(ins.src);
+			vm::ins_push(self.out, vm::Op_FCMP64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_F32_FMA:
+		{
+			auto dst = op_convert<float>(ins.dst);
+			auto src = op_convert<float>(ins.src);
+			auto src2 = op_convert<float>(ins.src2);
+			vm::ins_push(self.out, vm::Op_FMA32, dst, src, src2);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F64_FMA:
+		{
+			auto dst = op_convert<double>(ins.dst);
+			auto src = op_convert<double>(ins.src);
+			auto src2 = op_convert<double>(ins.src2);
+			vm::ins_push(self.out, vm::Op_FMA64, dst, src, src2);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_F32_ABS:
+		{
+			auto dst = op_convert<float>(ins.dst);
+			vm::ins_push(self.out, vm::Op_FABS32, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F64_ABS:
+		{
+			auto dst = op_convert<double>(ins.dst);
+			vm::ins_push(self.out, vm::Op_FABS64, dst, vm::op_none());
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_F32_NEG:
+		{
+			auto dst = op_convert<float>(ins.dst);
+			vm::ins_push(self.out, vm::Op_FNEG32, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F64_NEG:
+		{
+			auto dst = op_convert<double>(ins.dst);
+			vm::ins_push(self.out, vm::Op_FNEG64, dst, vm::op_none());
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_F32_FROM_I32:
+		{
+			auto dst = op_convert<float>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_I32_TO_F32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F32_FROM_I64:
+		{
+			auto dst = op_convert<float>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_I64_TO_F32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F32_FROM_U32:
+		{
+			auto dst = op_convert<float>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_U32_TO_F32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F32_FROM_U64:
+		{
+			auto dst = op_convert<float>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_U64_TO_F32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F64_FROM_I32:
+		{
+			auto dst = op_convert<double>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_I32_TO_F64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F64_FROM_I64:
+		{
+			auto dst = op_convert<double>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_I64_TO_F64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F64_FROM_U32:
+		{
+			auto dst = op_convert<double>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_U32_TO_F64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F64_FROM_U64:
+		{
+			auto dst = op_convert<double>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_U64_TO_F64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I32_FROM_F32:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<float>(ins.src);
+			vm::ins_push(self.out, vm::Op_F32_TO_I32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_FROM_F64:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<double>(ins.src);
+			vm::ins_push(self.out, vm::Op_F64_TO_I32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_FROM_F32:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<float>(ins.src);
+			vm::ins_push(self.out, vm::Op_F32_TO_I64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_FROM_F64:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<double>(ins.src);
+			vm::ins_push(self.out, vm::Op_F64_TO_I64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_FROM_F32:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<float>(ins.src);
+			vm::ins_push(self.out, vm::Op_F32_TO_U32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_FROM_F64:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<double>(ins.src);
+			vm::ins_push(self.out, vm::Op_F64_TO_U32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_FROM_F32:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<float>(ins.src);
+			vm::ins_push(self.out, vm::Op_F32_TO_U64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_FROM_F64:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<double>(ins.src);
+			vm::ins_push(self.out, vm::Op_F64_TO_U64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_F64_FROM_F32:
+		{
+			auto dst = op_convert<double>(ins.dst);
+			auto src = op_convert<float>(ins.src);
+			vm::ins_push(self.out, vm::Op_F32_TO_F64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_F32_FROM_F64:
+		{
+			auto dst = op_convert<float>(ins.dst);
+			auto src = op_convert<double>(ins.src);
+			vm::ins_push(self.out, vm::Op_F64_TO_F32, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_JE:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP8, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_JE:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP16, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_JE:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP32, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_JE:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP64, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_JE:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP8, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_JE:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP16, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_JE:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP32, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_JE:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP64, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JE, ins.lbl);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_JNE:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP8, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JNE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_JNE:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP16, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JNE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_JNE:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP32, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JNE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_JNE:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP64, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JNE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_JNE:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP8, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JNE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_JNE:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP16, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JNE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_JNE:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP32, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JNE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_JNE:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP64, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JNE, ins.lbl);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_JL:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP8, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JL, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_JL:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP16, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JL, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_JL:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP32, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JL, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_JL:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP64, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JL, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_JL:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP8, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JL, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_JL:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP16, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JL, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_JL:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP32, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JL, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_JL:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP64, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JL, ins.lbl);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_JLE:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP8, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JLE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_JLE:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP16, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JLE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_JLE:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP32, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JLE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_JLE:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP64, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JLE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_JLE:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP8, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JLE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_JLE:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP16, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JLE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_JLE:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP32, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JLE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_JLE:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP64, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JLE, ins.lbl);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_JG:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP8, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JG, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_JG:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP16, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JG, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_JG:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP32, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JG, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_JG:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP64, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JG, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_JG:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP8, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JG, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_JG:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP16, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JG, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_JG:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP32, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JG, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_JG:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP64, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JG, ins.lbl);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_JGE:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP8, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JGE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_JGE:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP16, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JGE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_JGE:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP32, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JGE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_JGE:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP64, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JGE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_JGE:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP8, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JGE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_JGE:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP16, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JGE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_JGE:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP32, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JGE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_JGE:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP64, dst, src);
+
+			emitter_jump_gen(self, vm::Op_JGE, ins.lbl);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_JMP:
+		{
+			emitter_jump_gen(self, vm::Op_JMP, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_JE:
+		{
+			emitter_jump_gen(self, vm::Op_JE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_JNE:
+		{
+			emitter_jump_gen(self, vm::Op_JNE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_JL:
+		{
+			emitter_jump_gen(self, vm::Op_JL, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_JLE:
+		{
+			emitter_jump_gen(self, vm::Op_JLE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_JG:
+		{
+			emitter_jump_gen(self, vm::Op_JG, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_JGE:
+		{
+			emitter_jump_gen(self, vm::Op_JGE, ins.lbl);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_PUSH:
+		{
+			if (ins.dst.kind == Operand::KIND_REG_LIST)
+			{
+				vm::ins_push(self.out, vm::Op_PUSHM, vm::op_imm(reg_list_mask(ins.dst)), vm::op_none());
+				break;
+			}
+
+			auto dst = op_convert<uint64_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_PUSH, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_POP:
+		{
+			if (ins.dst.kind == Operand::KIND_REG_LIST)
+			{
+				vm::ins_push(self.out, vm::Op_POPM, vm::op_imm(reg_list_mask(ins.dst)), vm::op_none());
+				break;
+			}
+
+			auto dst = op_convert<uint64_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_POP, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_ENTER:
+		{
+			auto size = op_convert<uint32_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_ENTER, size, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_LEAVE:
+		{
+			vm::ins_push(self.out, vm::Op_LEAVE, vm::op_none(), vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_CALL:
+		{
+			// C procs are called through a 64-bit table index, bytecode procs through a 32-bit address
+			if (mn::str_prefix(ins.lbl.str, "C."))
+			{
+				auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_C_CALL, vm::op_imm(uint64_t(0)), vm::op_none());
+				mn::buf_push(self.relocs, Reloc_Request{ ins.lbl, dst_offset, sizeof(uint64_t) });
+			}
+			else
+			{
+				auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_CALL32, vm::op_imm(uint32_t(0)), vm::op_none());
+				mn::buf_push(self.relocs, Reloc_Request{ ins.lbl, dst_offset, sizeof(uint32_t) });
+			}
+			break;
+		}
+		
+		case Tkn::KIND_KEYWORD_RET:
+		{
+			vm::ins_push(self.out, vm::Op_RET, vm::op_none(), vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I8_CMP:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_CMP:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_CMP:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_CMP:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_ICMP64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_CMP:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_CMP:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_CMP:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_CMP:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMP64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_CMOVE:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVE8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_CMOVE:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVE16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_CMOVE:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVE32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_CMOVE:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVE64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_CMOVE:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVE8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_CMOVE:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVE16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_CMOVE:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVE32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_CMOVE:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVE64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_CMOVNE:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVNE8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_CMOVNE:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVNE16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_CMOVNE:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVNE32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_CMOVNE:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVNE64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_CMOVNE:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVNE8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_CMOVNE:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVNE16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_CMOVNE:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVNE32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_CMOVNE:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVNE64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_CMOVL:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVL8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_CMOVL:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVL16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_CMOVL:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVL32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_CMOVL:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVL64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_CMOVL:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVL8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_CMOVL:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVL16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_CMOVL:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVL32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_CMOVL:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVL64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_CMOVLE:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVLE8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_CMOVLE:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVLE16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_CMOVLE:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVLE32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_CMOVLE:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVLE64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_CMOVLE:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVLE8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_CMOVLE:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVLE16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_CMOVLE:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVLE32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_CMOVLE:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVLE64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_CMOVG:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVG8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_CMOVG:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVG16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_CMOVG:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVG32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_CMOVG:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVG64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_CMOVG:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVG8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_CMOVG:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVG16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_CMOVG:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVG32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_CMOVG:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVG64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_CMOVGE:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			auto src = op_convert<int8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVGE8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_CMOVGE:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			auto src = op_convert<int16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVGE16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_CMOVGE:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			auto src = op_convert<int32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVGE32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_CMOVGE:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			auto src = op_convert<int64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVGE64, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_CMOVGE:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			auto src = op_convert<uint8_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVGE8, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_CMOVGE:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			auto src = op_convert<uint16_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVGE16, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_CMOVGE:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			auto src = op_convert<uint32_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVGE32, dst, src);
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_CMOVGE:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			auto src = op_convert<uint64_t>(ins.src);
+			vm::ins_push(self.out, vm::Op_CMOVGE64, dst, src);
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_SETE:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETE8, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_SETE:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETE16, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_SETE:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETE32, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_SETE:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETE64, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_SETE:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETE8, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_SETE:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETE16, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_SETE:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETE32, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_SETE:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETE64, dst, vm::op_none());
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_SETNE:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETNE8, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_SETNE:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETNE16, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_SETNE:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETNE32, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_SETNE:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETNE64, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_SETNE:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETNE8, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_SETNE:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETNE16, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_SETNE:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETNE32, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_SETNE:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETNE64, dst, vm::op_none());
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_SETL:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETL8, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_SETL:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETL16, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_SETL:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETL32, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_SETL:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETL64, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_SETL:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETL8, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_SETL:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETL16, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_SETL:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETL32, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_SETL:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETL64, dst, vm::op_none());
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_SETLE:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETLE8, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_SETLE:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETLE16, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_SETLE:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETLE32, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_SETLE:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETLE64, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_SETLE:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETLE8, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U16_SETLE:
+		{
+			auto dst = op_convert<uint16_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETLE16, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U32_SETLE:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETLE32, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_SETLE:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETLE64, dst, vm::op_none());
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_SETG:
+		{
+			auto dst = op_convert<int8_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETG8, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I16_SETG:
+		{
+			auto dst = op_convert<int16_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETG16, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I32_SETG:
+		{
+			auto dst = op_convert<int32_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETG32, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_I64_SETG:
+		{
+			auto dst = op_convert<int64_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETG64, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U8_SETG:
+		{
+			auto dst = op_convert<uint8_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETG8, dst, vm::op_none());
+			break;
 		}
-		
-		case Tkn::KIND_KEYWORD_RET:
+
+		case Tkn::KIND_KEYWORD_U16_SETG:
 		{
-			vm::ins_push(self.out, vm::Op_RET, vm::op_none(), vm::op_none());
+			auto dst = op_convert<uint16_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETG16, dst, vm::op_none());
 			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I8_CMP:
+		case Tkn::KIND_KEYWORD_U32_SETG:
+		{
+			auto dst = op_convert<uint32_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETG32, dst, vm::op_none());
+			break;
+		}
+
+		case Tkn::KIND_KEYWORD_U64_SETG:
+		{
+			auto dst = op_convert<uint64_t>(ins.dst);
+			vm::ins_push(self.out, vm::Op_SETG64, dst, vm::op_none());
+			break;
+		}
+
+
+		case Tkn::KIND_KEYWORD_I8_SETGE:
 		{
 			auto dst = op_convert<int8_t>(ins.dst);
-			auto src = op_convert<int8_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP8, dst, src);
+			vm::ins_push(self.out, vm::Op_SETGE8, dst, vm::op_none());
+			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I16_CMP:
+		case Tkn::KIND_KEYWORD_I16_SETGE:
 		{
 			auto dst = op_convert<int16_t>(ins.dst);
-			auto src = op_convert<int16_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP16, dst, src);
+			vm::ins_push(self.out, vm::Op_SETGE16, dst, vm::op_none());
+			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I32_CMP:
+		case Tkn::KIND_KEYWORD_I32_SETGE:
 		{
 			auto dst = op_convert<int32_t>(ins.dst);
-			auto src = op_convert<int32_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP32, dst, src);
+			vm::ins_push(self.out, vm::Op_SETGE32, dst, vm::op_none());
+			break;
 		}
 
-		case Tkn::KIND_KEYWORD_I64_CMP:
+		case Tkn::KIND_KEYWORD_I64_SETGE:
 		{
 			auto dst = op_convert<int64_t>(ins.dst);
-			auto src = op_convert<int64_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_ICMP64, dst, src);
+			vm::ins_push(self.out, vm::Op_SETGE64, dst, vm::op_none());
+			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U8_CMP:
+		case Tkn::KIND_KEYWORD_U8_SETGE:
 		{
 			auto dst = op_convert<uint8_t>(ins.dst);
-			auto src = op_convert<uint8_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP8, dst, src);
+			vm::ins_push(self.out, vm::Op_SETGE8, dst, vm::op_none());
+			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U16_CMP:
+		case Tkn::KIND_KEYWORD_U16_SETGE:
 		{
 			auto dst = op_convert<uint16_t>(ins.dst);
-			auto src = op_convert<uint16_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP16, dst, src);
+			vm::ins_push(self.out, vm::Op_SETGE16, dst, vm::op_none());
+			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U32_CMP:
+		case Tkn::KIND_KEYWORD_U32_SETGE:
 		{
 			auto dst = op_convert<uint32_t>(ins.dst);
-			auto src = op_convert<uint32_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP32, dst, src);
+			vm::ins_push(self.out, vm::Op_SETGE32, dst, vm::op_none());
+			break;
 		}
 
-		case Tkn::KIND_KEYWORD_U64_CMP:
+		case Tkn::KIND_KEYWORD_U64_SETGE:
 		{
 			auto dst = op_convert<uint64_t>(ins.dst);
-			auto src = op_convert<uint64_t>(ins.src);
-			vm::ins_push(self.out, vm::Op_CMP64, dst, src);
+			vm::ins_push(self.out, vm::Op_SETGE64, dst, vm::op_none());
+			break;
 		}
 
 
@@ -1186,12 +3152,77 @@ namespace as
 		}
 	}
 
+	// a call to a bytecode proc immediately followed by a ret can reuse the current frame
+	inline static bool
+	is_tail_call(const Ins& ins, const Ins& next)
+	{
+		return ins.op.kind == Tkn::KIND_KEYWORD_CALL &&
+			mn::str_prefix(ins.lbl.str, "C.") == false &&
+			next.op.kind == Tkn::KIND_KEYWORD_RET;
+	}
+
+	inline static void
+	emitter_tail_call_gen(Emitter& self, const Ins& ins)
+	{
+		auto [dst_offset, _] = vm::ins_push(self.out, vm::Op_TAILCALL, vm::op_imm(uint32_t(0)), vm::op_none());
+		mn::buf_push(self.relocs, Reloc_Request{ ins.lbl, dst_offset, sizeof(uint32_t) });
+	}
+
 	inline static void
-	emitter_proc_gen(Emitter& self, const Proc& proc, vm::Pkg& pkg)
+	emitter_proc_gen(Emitter& self, const Proc& proc)
 	{
-		// emit the proc bytecode
-		for(const auto& ins: proc.ins)
-			emitter_ins_gen(self, ins, proc, pkg);
+		// branch relaxation, all jumps start with an 8-bit offset then we emit the proc and grow
+		// the jumps which can't reach their targets and emit again until the layout is stable
+		// jumps only grow so this is guaranteed to terminate
+		auto errs_count = self.errs.count;
+		while (true)
+		{
+			mn::buf_clear(self.out);
+			mn::buf_clear(self.fixups);
+			mn::buf_clear(self.relocs);
+			mn::map_clear(self.symbols);
+			mn::buf_clear(self.lines);
+
+			// emit the proc bytecode
+			for(size_t i = 0; i < proc.ins.count; ++i)
+			{
+				const auto& ins = proc.ins[i];
+				// labels don't emit anything and instructions made up by the optimizer have no position
+				if (self.debug && ins.op.kind != Tkn::KIND_ID && ins.op.pos.line != 0)
+					mn::buf_push(self.lines, vm::Debug_Line{self.out.count, ins.op.pos.line, ins.op.pos.col});
+				if (i + 1 < proc.ins.count && is_tail_call(ins, proc.ins[i + 1]))
+				{
+					emitter_tail_call_gen(self, ins);
+					// skip the ret
+					++i;
+					continue;
+				}
+				emitter_ins_gen(self, ins);
+			}
+
+			// don't report the same errors again
+			if (self.errs.count > errs_count)
+				break;
+
+			bool changed = false;
+			for(size_t i = 0; i < self.fixups.count; ++i)
+			{
+				auto fixup = self.fixups[i];
+				auto it = mn::map_lookup(self.symbols, fixup.name.str);
+				if (it == nullptr)
+					continue;
+
+				int64_t offset = it->value - (fixup.bytecode_index + fixup.size);
+				if (jump_offset_fits(offset, fixup.size) == false)
+				{
+					self.jump_sizes[i] = fixup.size == sizeof(int8_t) ? sizeof(int32_t) : sizeof(int64_t);
+					changed = true;
+				}
+			}
+
+			if (changed == false)
+				break;
+		}
 
 		// do the fixups
 		for(auto fixup: self.fixups)
@@ -1199,12 +3230,18 @@ namespace as
 			auto it = mn::map_lookup(self.symbols, fixup.name.str);
 			if(it == nullptr)
 			{
-				src_err(self.src, fixup.name, mn::strf("'{}' undefined symbol", fixup.name.str));
+				emitter_err(self, fixup.name, mn::strf("'{}' undefined symbol", fixup.name.str));
 				continue;
 			}
 
-			int64_t offset = it->value - (fixup.bytecode_index + sizeof(int64_t));
-			write64(self.out.ptr + fixup.bytecode_index, uint64_t(offset));
+			int64_t offset = it->value - (fixup.bytecode_index + fixup.size);
+			switch(fixup.size)
+			{
+			case sizeof(int8_t): write8(self.out.ptr + fixup.bytecode_index, uint8_t(offset)); break;
+			case sizeof(int32_t): write32(self.out.ptr + fixup.bytecode_index, uint32_t(offset)); break;
+			case sizeof(int64_t): write64(self.out.ptr + fixup.bytecode_index, uint64_t(offset)); break;
+			default: assert(false && "unreachable"); break;
+			}
 		}
 	}
 
@@ -1307,12 +3344,13 @@ namespace as
 		}
 	}
 
-	inline static void
-	_cproc_gen(C_Proc& self, Src* src, vm::Pkg *pkg)
+	inline static bool
+	_cproc_gen(C_Proc& self, Src* src, vm::C_Proc& res)
 	{
 		auto parts = mn::str_split(self.name.str, ".", true);
+		mn_defer(destruct(parts));
 
-		auto res = vm::c_proc_new();
+		res = vm::c_proc_new();
 		if(parts.count == 2)
 		{
 			res.lib = clone(parts[0]);
@@ -1326,7 +3364,8 @@ namespace as
 		else
 		{
 			src_err(src, self.name, mn::strf("unknown C proc name, name should be 'C.library_name.procedure_name'"));
-			return;
+			vm::c_proc_free(res);
+			return false;
 		}
 
 		mn::buf_reserve(res.arg_types, self.args.count);
@@ -1334,101 +3373,595 @@ namespace as
 			mn::buf_push(res.arg_types, tkn_to_ctype(tkn));
 
 		res.ret = tkn_to_ctype(self.ret);
+		return true;
+	}
 
-		mn::buf_push(pkg->c_procs, res);
+	// adds the decl name to the globals and reports symbol redefinitions
+	inline static void
+	_global_register(Src* src, mn::Map<mn::Str, Global>& globals, const Tkn& name)
+	{
+		if(auto it = mn::map_lookup(globals, mn::str_lit(name.str)))
+		{
+			auto location = global_location(it->value, src);
+			mn_defer(mn::str_free(location));
+			src_err(src, name, mn::strf("symbol redefinition, it was first defined in {}", location));
+		}
+		else
+		{
+			mn::map_insert(globals, mn::str_lit(name.str), Global{src, name});
+		}
 	}
 
-	// API
-	vm::Pkg
-	src_gen(Src* src)
+	// FNV-1a
+	inline static uint64_t
+	_hash_bytes(uint64_t hash, const void* ptr, size_t size)
 	{
-		// load all global symbols into globals map and try to resolve symbol redefinition erros
-		auto globals = mn::map_new<const char*, Tkn>();
-		mn_defer(mn::map_free(globals));
+		auto bytes = (const uint8_t*)ptr;
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	template<typename T>
+	inline static uint64_t
+	_hash_value(uint64_t hash, const T& v)
+	{
+		return _hash_bytes(hash, &v, sizeof(v));
+	}
 
-		for(auto decl: src->decls)
+	// hashes the token kind and text, positions are left out so moving a proc around doesn't change its
+	// hash, and identifiers hash whether they name a global since that changes the generated code
+	inline static uint64_t
+	_hash_tkn(uint64_t hash, const Tkn& tkn, const mn::Map<mn::Str, Global>& globals)
+	{
+		hash = _hash_value(hash, tkn.kind);
+		if (tkn.kind == Tkn::KIND_NONE)
+			return hash;
+
+		uint32_t len = uint32_t(tkn.rng.end - tkn.rng.begin);
+		hash = _hash_value(hash, len);
+		hash = _hash_bytes(hash, tkn.rng.begin, len);
+		if (tkn.kind == Tkn::KIND_ID)
+			hash = _hash_value(hash, mn::map_lookup(globals, mn::str_lit(tkn.str)) != nullptr);
+		return hash;
+	}
+
+	inline static uint64_t
+	_hash_operand(uint64_t hash, const Operand& op, const mn::Map<mn::Str, Global>& globals)
+	{
+		hash = _hash_value(hash, op.kind);
+		switch(op.kind)
 		{
-			switch(decl->kind)
+		case Operand::KIND_NONE:
+			break;
+		case Operand::KIND_REG_LIST:
+			hash = _hash_value(hash, op.reg_list);
+			break;
+		case Operand::KIND_MEM:
+			hash = _hash_tkn(hash, op.mem, globals);
+			hash = _hash_tkn(hash, op.disp_op, globals);
+			hash = _hash_tkn(hash, op.disp, globals);
+			break;
+		default:
+			hash = _hash_tkn(hash, op.reg, globals);
+			break;
+		}
+		return hash;
+	}
+
+	// cache key of the proc, it covers the proc tokens and the globals they reference
+	inline static uint64_t
+	_proc_hash(const Proc& proc, const mn::Map<mn::Str, Global>& globals)
+	{
+		uint64_t hash = 14695981039346656037ULL;
+		hash = _hash_value(hash, proc.ins.count);
+		for (const auto& ins: proc.ins)
+		{
+			hash = _hash_tkn(hash, ins.op, globals);
+			hash = _hash_operand(hash, ins.dst, globals);
+			hash = _hash_operand(hash, ins.src, globals);
+			hash = _hash_operand(hash, ins.src2, globals);
+			hash = _hash_tkn(hash, ins.lbl, globals);
+		}
+		return hash;
+	}
+
+	// debug builds also hash the instructions positions relative to the proc name, the generated lines
+	// depend on them and debug entries never mix with the others
+	inline static uint64_t
+	_proc_debug_hash(uint64_t hash, const Proc& proc)
+	{
+		hash = _hash_value(hash, uint8_t(1));
+		for (const auto& ins: proc.ins)
+		{
+			hash = _hash_value(hash, int64_t(ins.op.pos.line) - int64_t(proc.name.pos.line));
+			hash = _hash_value(hash, ins.op.pos.col);
+		}
+		return hash;
+	}
+
+	// labels of the proc at their bytecode offsets, they're in the proc order so they're sorted by offset
+	inline static mn::Buf<vm::Debug_Label>
+	_proc_labels(const Proc& proc, const Emitter& emitter)
+	{
+		auto labels = mn::buf_new<vm::Debug_Label>();
+		for (const auto& ins: proc.ins)
+		{
+			if (ins.op.kind != Tkn::KIND_ID)
+				continue;
+			if (auto it = mn::map_lookup(emitter.symbols, ins.op.str))
+				mn::buf_push(labels, vm::Debug_Label{mn::str_from_c(ins.op.str), it->value});
+		}
+		return labels;
+	}
+
+	inline static vm::Proc_Debug
+	_proc_debug_new(const Src* src, const Proc& proc, const Emitter& emitter)
+	{
+		auto self = vm::proc_debug_new();
+		mn::str_push(self.file, src->path);
+		mn::buf_concat(self.lines, emitter.lines);
+		mn::buf_free(self.labels);
+		self.labels = _proc_labels(proc, emitter);
+		return self;
+	}
+
+	// cached lines are relative to the proc name line
+	inline static vm::Proc_Debug
+	_proc_debug_from_cache(const Src* src, const Proc& proc, const Cache_Entry& entry)
+	{
+		auto self = vm::proc_debug_new();
+		mn::str_push(self.file, src->path);
+		for (auto line: entry.lines)
+		{
+			line.line += proc.name.pos.line;
+			mn::buf_push(self.lines, line);
+		}
+		for (const auto& label: entry.labels)
+			mn::buf_push(self.labels, vm::Debug_Label{clone(label.name), label.offset});
+		return self;
+	}
+
+	inline static void
+	_cache_entry_add(Cache& cache, uint64_t hash, const Proc& proc, const Emitter& emitter)
+	{
+		if (mn::map_lookup(cache.entries, hash) != nullptr)
+			return;
+
+		Cache_Entry entry{};
+		entry.bytes = mn::buf_clone(emitter.out);
+		entry.relocs = mn::buf_with_capacity<Cache_Reloc>(emitter.relocs.count);
+		entry.lines = mn::buf_with_capacity<vm::Debug_Line>(emitter.lines.count);
+		entry.labels = emitter.debug ? _proc_labels(proc, emitter) : mn::buf_new<vm::Debug_Label>();
+		entry.used = true;
+		for (const auto& reloc: emitter.relocs)
+			mn::buf_push(entry.relocs, Cache_Reloc{reloc.bytecode_index, mn::str_from_c(reloc.target.str), reloc.width});
+		for (auto line: emitter.lines)
+		{
+			line.line -= proc.name.pos.line;
+			mn::buf_push(entry.lines, line);
+		}
+		mn::map_insert(cache.entries, hash, entry);
+	}
+
+	// all the constants of the package pooled into a single read only data section
+	struct Rodata
+	{
+		mn::Buf<uint8_t> bytes;
+		// offset of each constant in the section
+		mn::Map<mn::Str, uint64_t> offsets;
+	};
+
+	inline static void
+	_rodata_free(Rodata& self)
+	{
+		mn::buf_free(self.bytes);
+		mn::map_free(self.offsets);
+	}
+
+	// a constant and its escaped value, the name isn't owned
+	struct Rodata_Constant
+	{
+		const char* name;
+		mn::Str value;
+	};
+
+	inline static void
+	destruct(Rodata_Constant& self)
+	{
+		mn::str_free(self.value);
+	}
+
+	inline static Rodata_Constant
+	_rodata_constant_new(const Constant& constant, const char* name)
+	{
+		auto value = mn::str_new();
+		_escape_string(value, constant.value.rng.begin, constant.value.rng.end);
+		return Rodata_Constant{name, value};
+	}
+
+	// compares the strings starting from their last byte
+	inline static bool
+	_reversed_less(const mn::Str& a, const mn::Str& b)
+	{
+		for (size_t i = 0; i < a.count && i < b.count; ++i)
+		{
+			auto x = uint8_t(a[a.count - i - 1]);
+			auto y = uint8_t(b[b.count - i - 1]);
+			if (x != y)
+				return x < y;
+		}
+		return a.count < b.count;
+	}
+
+	inline static bool
+	_is_suffix(const mn::Str& str, const mn::Str& of)
+	{
+		return str.count <= of.count && ::memcmp(str.ptr, of.ptr + of.count - str.count, str.count) == 0;
+	}
+
+	// identical constants share the same bytes and a constant which is a suffix of another one points
+	// into it, sorting the values by their reversed bytes puts each suffix right before the values
+	// which end with it, the result doesn't depend on the order of the constants
+	inline static Rodata
+	_rodata_build(const mn::Buf<Rodata_Constant>& rodata_constants)
+	{
+		auto values = mn::buf_new<mn::Str>();
+		mn_defer(mn::buf_free(values));
+		auto values_index = mn::map_new<mn::Str, size_t>();
+		mn_defer(mn::map_free(values_index));
+		auto constants = mn::map_new<mn::Str, size_t>();
+		mn_defer(mn::map_free(constants));
+
+		for (const auto& constant: rodata_constants)
+		{
+			size_t index = values.count;
+			if (auto it = mn::map_lookup(values_index, constant.value))
 			{
-			case Decl::KIND_PROC:
+				index = it->value;
+			}
+			else
 			{
-				if(auto it = mn::map_lookup(globals, decl->proc.name.str))
-					src_err(src, decl->proc.name, mn::strf("symbol redefinition, it was first defined in {}:{}", it->value.pos.line, it->value.pos.col));
-				else
-					mn::map_insert(globals, decl->proc.name.str, decl->proc.name);
-				break;
+				mn::buf_push(values, constant.value);
+				mn::map_insert(values_index, constant.value, index);
 			}
+			mn::map_insert(constants, mn::str_lit(constant.name), index);
+		}
 
-			case Decl::KIND_C_PROC:
+		auto order = mn::buf_new<size_t>();
+		mn_defer(mn::buf_free(order));
+		for (size_t i = 0; i < values.count; ++i)
+			mn::buf_push(order, i);
+		std::sort(begin(order), end(order), [&](size_t a, size_t b) { return _reversed_less(values[a], values[b]); });
+
+		auto offsets = mn::buf_new<uint64_t>();
+		mn_defer(mn::buf_free(offsets));
+		mn::buf_resize(offsets, values.count);
+
+		Rodata self{};
+		self.bytes = mn::buf_new<uint8_t>();
+		self.offsets = mn::map_new<mn::Str, uint64_t>();
+
+		size_t owner = values.count;
+		for (size_t i = order.count; i > 0; --i)
+		{
+			auto index = order[i - 1];
+			const auto& value = values[index];
+			if (owner < values.count && _is_suffix(value, values[owner]))
 			{
-				if(auto it = mn::map_lookup(globals, decl->c_proc.name.str))
-					src_err(src, decl->proc.name, mn::strf("symbol redefinition, it was first defined in {}:{}", it->value.pos.line, it->value.pos.col));
-				else
-					mn::map_insert(globals, decl->c_proc.name.str, decl->c_proc.name);
-				break;
+				offsets[index] = offsets[owner] + values[owner].count - value.count;
+				continue;
 			}
 
-			case Decl::KIND_CONSTANT:
+			owner = index;
+			offsets[index] = self.bytes.count;
+			for (auto c: value)
+				mn::buf_push(self.bytes, uint8_t(c));
+		}
+
+		for (const auto& [name, index]: constants)
+			mn::map_insert(self.offsets, name, offsets[index]);
+		return self;
+	}
+
+	// relocations to constants target the rodata section at the constant offset
+	inline static void
+	_reloc_add(vm::Pkg& pkg, const Rodata& rodata, const char* source, uint64_t source_offset, const mn::Str& target, uint8_t width)
+	{
+		if (auto it = mn::map_lookup(rodata.offsets, target))
+			vm::pkg_reloc_add(pkg, mn::str_lit(source), source_offset, mn::str_lit(vm::RODATA_SECTION), width, it->value);
+		else
+			vm::pkg_reloc_add(pkg, mn::str_lit(source), source_offset, target, width);
+	}
+
+	inline static vm::Pkg
+	_srcs_gen(Src* const* srcs, size_t srcs_count, size_t workers, Cache* cache, bool debug)
+	{
+		// load all global symbols of all the srcs into globals map and try to resolve symbol redefinition erros
+		auto globals = mn::map_new<mn::Str, Global>();
+		mn_defer(mn::map_free(globals));
+
+		bool has_err = false;
+		for(size_t i = 0; i < srcs_count; ++i)
+		{
+			for(auto decl: srcs[i]->decls)
+				_global_register(srcs[i], globals, decl_name(decl));
+			has_err |= src_has_err(srcs[i]);
+		}
+
+		auto pkg = vm::pkg_new();
+
+		if (has_err)
+			return pkg;
+
+		// procs are generated first, each into its own emitter and possibly in parallel, then everything
+		// is added to the package in the srcs and decls order so the output doesn't depend on the workers count
+		auto procs = mn::buf_new<const Proc*>();
+		mn_defer(mn::buf_free(procs));
+		auto emitters = mn::buf_new<Emitter>();
+		mn_defer(destruct(emitters));
+
+		for(size_t i = 0; i < srcs_count; ++i)
+		{
+			for(auto decl: srcs[i]->decls)
 			{
-				if(auto it = mn::map_lookup(globals, decl->constant.name.str))
-					src_err(src, decl->constant.name, mn::strf("symbol redefinition, it was first defined in {}:{}", it->value.pos.line, it->value.pos.col));
-				else
-					mn::map_insert(globals, decl->constant.name.str, decl->constant.name);
-				break;
+				if (decl->kind != Decl::KIND_PROC)
+					continue;
+				mn::buf_push(procs, &decl->proc);
+				mn::buf_push(emitters, emitter_new(srcs[i], &globals, debug));
 			}
+		}
 
-			default:
-				assert(false && "unreachable");
-				break;
+		// procs with a cache hit aren't generated at all
+		auto hashes = mn::buf_new<uint64_t>();
+		mn_defer(mn::buf_free(hashes));
+		auto cached = mn::buf_new<bool>();
+		mn_defer(mn::buf_free(cached));
+		if (cache)
+		{
+			mn::buf_resize(hashes, procs.count);
+			mn::buf_resize(cached, procs.count);
+			for(size_t i = 0; i < procs.count; ++i)
+			{
+				hashes[i] = _proc_hash(*procs[i], globals);
+				if (debug)
+					hashes[i] = _proc_debug_hash(hashes[i], *procs[i]);
+				auto it = mn::map_lookup(cache->entries, hashes[i]);
+				cached[i] = it != nullptr;
+				if (it)
+				{
+					it->value.used = true;
+					++cache->hits;
+				}
+				else
+				{
+					++cache->misses;
+				}
 			}
 		}
 
-		auto pkg = vm::pkg_new();
+		parallel_for(procs.count, workers, [&](size_t i) {
+			if (cache == nullptr || cached[i] == false)
+				emitter_proc_gen(emitters[i], *procs[i]);
+		});
 
-		if (src_has_err(src))
-			return pkg;
+		auto rodata_constants = mn::buf_new<Rodata_Constant>();
+		mn_defer(destruct(rodata_constants));
+		for (size_t i = 0; i < srcs_count; ++i)
+			for (auto decl: srcs[i]->decls)
+				if (decl->kind == Decl::KIND_CONSTANT)
+					mn::buf_push(rodata_constants, _rodata_constant_new(decl->constant, decl->constant.name.str));
 
-		auto tmp_str = mn::str_new();
-		mn_defer(mn::str_free(tmp_str));
+		auto rodata = _rodata_build(rodata_constants);
+		mn_defer(_rodata_free(rodata));
 
-		for(auto decl: src->decls)
+		size_t proc_index = 0;
+		for(size_t i = 0; i < srcs_count; ++i)
 		{
+			auto src = srcs[i];
+			for(auto decl: src->decls)
+			{
+				switch(decl->kind)
+				{
+				case Decl::KIND_PROC:
+				{
+					auto index = proc_index++;
+					if (cache && cached[index])
+					{
+						const auto& entry = mn::map_lookup(cache->entries, hashes[index])->value;
+						vm::pkg_proc_add(pkg, decl->proc.name.str, mn::block_from(entry.bytes));
+						for(const auto& reloc: entry.relocs)
+							_reloc_add(pkg, rodata, decl->proc.name.str, reloc.bytecode_index, reloc.target, reloc.width);
+						if (debug)
+							vm::pkg_debug_add(pkg, mn::str_lit(decl->proc.name.str), _proc_debug_from_cache(src, decl->proc, entry));
+						break;
+					}
+
+					auto& emitter = emitters[index];
+					if (cache && emitter.errs.count == 0)
+						_cache_entry_add(*cache, hashes[index], decl->proc, emitter);
+					emitter_errs_flush(emitter, src);
+					vm::pkg_proc_add(pkg, decl->proc.name.str, mn::block_from(emitter.out));
+					for(auto reloc: emitter.relocs)
+						_reloc_add(pkg, rodata, decl->proc.name.str, reloc.bytecode_index, mn::str_lit(reloc.target.str), reloc.width);
+					if (debug)
+						vm::pkg_debug_add(pkg, mn::str_lit(decl->proc.name.str), _proc_debug_new(src, decl->proc, emitter));
+					break;
+				}
+
+				case Decl::KIND_C_PROC:
+				{
+					vm::C_Proc res{};
+					if (_cproc_gen(decl->c_proc, src, res))
+						mn::buf_push(pkg.c_procs, res);
+					break;
+				}
+
+				case Decl::KIND_CONSTANT:
+					// constants are pooled into the rodata section
+					break;
+
+				default:
+					assert(false && "unreachable");
+					break;
+				}
+			}
+		}
+
+		if (rodata.offsets.count > 0)
+			vm::pkg_constant_add(pkg, vm::RODATA_SECTION, mn::block_from(rodata.bytes));
+
+		// cores get exactly sized stacks when the program stack depth is bounded
+		pkg.stack_size = vm::pkg_stack_bound(pkg);
+		return pkg;
+	}
+
+	// reloc of the streaming build, the names are interned into the src
+	struct Stream_Reloc
+	{
+		const char* source;
+		uint64_t source_offset;
+		const char* target;
+		uint8_t width;
+	};
+
+	// API
+	vm::Pkg
+	src_gen(Src* src, size_t workers, bool debug)
+	{
+		return _srcs_gen(&src, 1, workers, nullptr, debug);
+	}
+
+	vm::Pkg
+	srcs_gen(const mn::Buf<Src*>& srcs, size_t workers, Cache* cache, bool debug)
+	{
+		return _srcs_gen(srcs.ptr, srcs.count, workers, cache, debug);
+	}
+
+	bool
+	src_gen_stream(Src* src, vm::Pkg_Writer& writer, bool debug)
+	{
+		// the globals are kept across decls so their names are interned into the src table because each
+		// decl strings are released with it
+		auto globals = mn::map_new<mn::Str, Global>();
+		mn_defer(mn::map_free(globals));
+
+		// what can't be written before the whole src is seen is kept until its end, the first position of
+		// each label name which isn't a global yet so a later global can't redefine it, the constants which
+		// are pooled, the relocs to them or to globals which aren't declared yet, and the frame of each
+		// proc for the stack bound
+		auto labels = mn::map_new<mn::Str, Pos>();
+		mn_defer(mn::map_free(labels));
+		auto rodata_constants = mn::buf_new<Rodata_Constant>();
+		mn_defer(destruct(rodata_constants));
+		auto constants = mn::map_new<mn::Str, bool>();
+		mn_defer(mn::map_free(constants));
+		auto relocs = mn::buf_new<Stream_Reloc>();
+		mn_defer(mn::buf_free(relocs));
+		auto stack_bound = vm::stack_bound_new();
+		mn_defer(vm::stack_bound_free(stack_bound));
+
+		auto parser = parser_stream_new(src);
+		mn_defer(parser_stream_free(parser));
+
+		while(auto decl = parser_stream_decl(parser))
+		{
+			auto name = decl_name(decl);
+			name.str = mn::str_intern(src->str_table, name.str);
+			if (auto it = mn::map_lookup(labels, mn::str_lit(name.str)))
+			{
+				src_err(src, name, mn::strf("global symbol redefinition, it was first defined as a label in {}:{}", it->value.line, it->value.col));
+				break;
+			}
+			_global_register(src, globals, name);
+			if (src_has_err(src))
+				break;
+
 			switch(decl->kind)
 			{
 			case Decl::KIND_PROC:
 			{
-				auto emitter = emitter_new(src, &globals);
+				auto emitter = emitter_new(src, &globals, debug);
 				mn_defer(emitter_free(emitter));
 
-				emitter_proc_gen(emitter, decl->proc, pkg);
-				vm::pkg_proc_add(pkg, decl->proc.name.str, mn::block_from(emitter.out));
+				emitter_proc_gen(emitter, decl->proc);
+				emitter_errs_flush(emitter, src);
+				vm::pkg_writer_proc(writer, mn::str_lit(name.str), mn::block_from(emitter.out));
+				vm::stack_bound_proc(stack_bound, mn::str_lit(name.str), mn::block_from(emitter.out));
+				for(auto reloc: emitter.relocs)
+				{
+					auto target = mn::str_lit(reloc.target.str);
+					vm::stack_bound_reloc(stack_bound, mn::str_lit(name.str), reloc.bytecode_index, target);
+					// relocs to the procs declared so far are written right away
+					if (mn::map_lookup(globals, target) && mn::map_lookup(constants, target) == nullptr)
+					{
+						vm::pkg_writer_reloc(writer, mn::str_lit(name.str), reloc.bytecode_index, target, reloc.width);
+						continue;
+					}
+					auto interned = mn::str_intern(src->str_table, reloc.target.str);
+					mn::buf_push(relocs, Stream_Reloc{name.str, reloc.bytecode_index, interned, reloc.width});
+				}
+				for(const auto& ins: decl->proc.ins)
+				{
+					if (ins.op.kind != Tkn::KIND_ID || mn::map_lookup(globals, mn::str_lit(ins.op.str)) || mn::map_lookup(labels, mn::str_lit(ins.op.str)))
+						continue;
+					mn::map_insert(labels, mn::str_lit(mn::str_intern(src->str_table, ins.op.str)), ins.op.pos);
+				}
+				if (debug)
+				{
+					auto proc_debug = _proc_debug_new(src, decl->proc, emitter);
+					vm::pkg_writer_debug(writer, mn::str_lit(name.str), proc_debug);
+					vm::proc_debug_free(proc_debug);
+				}
 				break;
 			}
 
 			case Decl::KIND_C_PROC:
 			{
-				_cproc_gen(decl->c_proc, src, &pkg);
+				vm::C_Proc res{};
+				if (_cproc_gen(decl->c_proc, src, res))
+				{
+					vm::pkg_writer_c_proc(writer, res);
+					vm::c_proc_free(res);
+				}
 				break;
 			}
 
 			case Decl::KIND_CONSTANT:
-			{
-				mn::str_clear(tmp_str);
-				_escape_string(tmp_str, decl->constant.value.rng.begin, decl->constant.value.rng.end);
-
-				vm::pkg_constant_add(
-					pkg,
-					decl->constant.name.str,
-					mn::block_from(tmp_str)
-				);
+				mn::buf_push(rodata_constants, _rodata_constant_new(decl->constant, name.str));
+				mn::map_insert(constants, mn::str_lit(name.str), true);
 				break;
-			}
 
 			default:
 				assert(false && "unreachable");
 				break;
 			}
+
+			if (src_has_err(src))
+				break;
 		}
-		return pkg;
+
+		if (src_has_err(src))
+			return false;
+
+		auto rodata = _rodata_build(rodata_constants);
+		mn_defer(_rodata_free(rodata));
+		if (rodata.offsets.count > 0)
+			vm::pkg_writer_constant(writer, mn::str_lit(vm::RODATA_SECTION), mn::block_from(rodata.bytes));
+
+		for (const auto& reloc: relocs)
+		{
+			if (auto it = mn::map_lookup(rodata.offsets, mn::str_lit(reloc.target)))
+				vm::pkg_writer_reloc(writer, mn::str_lit(reloc.source), reloc.source_offset, mn::str_lit(vm::RODATA_SECTION), reloc.width, it->value);
+			else
+				vm::pkg_writer_reloc(writer, mn::str_lit(reloc.source), reloc.source_offset, mn::str_lit(reloc.target), reloc.width);
+		}
+
+		if (auto stack_size = vm::stack_bound_compute(stack_bound))
+			vm::pkg_writer_stack_size(writer, stack_size);
+		return true;
 	}
 }
@@ -0,0 +1,549 @@
+#include "as/Opt.h"
+#include "as/CFG.h"
+
+#include <mn/Map.h>
+#include <mn/Defer.h>
+#include <mn/IO.h>
+#include <mn/Memory.h>
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace as
+{
+	// type and name of typed instructions, i32.add is {'i', 32, "add"}
+	struct Op_Info
+	{
+		char type;
+		int bits;
+		const char* name;
+	};
+
+	inline static bool
+	_op_info(Tkn::KIND kind, Op_Info& info)
+	{
+		const char* name = Tkn::NAMES[kind];
+		if (name[0] != 'i' && name[0] != 'u' && name[0] != 'f')
+			return false;
+
+		char* end = nullptr;
+		auto bits = ::strtol(name + 1, &end, 10);
+		if (end == name + 1 || *end != '.')
+			return false;
+
+		info.type = name[0];
+		info.bits = int(bits);
+		info.name = end + 1;
+		return true;
+	}
+
+	inline static bool
+	_op_is(const Op_Info& info, const char* name)
+	{
+		return info.type != 'f' && ::strcmp(info.name, name) == 0;
+	}
+
+	inline static bool
+	_imm_value(const Operand& op, int64_t& value)
+	{
+		if (op.kind != Operand::KIND_IMM || op.imm.kind != Tkn::KIND_INTEGER)
+			return false;
+		return mn::reads(op.imm.str, value) == 1;
+	}
+
+	inline static bool
+	_imm_fits(const Op_Info& info, int64_t value)
+	{
+		if (info.bits >= 64)
+			return true;
+		if (info.type == 'u')
+			return value >= 0 && value < (int64_t(1) << info.bits);
+		return value >= -(int64_t(1) << (info.bits - 1)) && value < (int64_t(1) << (info.bits - 1));
+	}
+
+	inline static bool
+	_ins_is_label(const Ins& ins)
+	{
+		return ins.op.kind == Tkn::KIND_ID;
+	}
+
+	inline static bool
+	_ins_is_jump(const Ins& ins)
+	{
+		return is_pure_jump(ins.op.kind) || is_cond_jump(ins.op.kind);
+	}
+
+	// instructions which don't change anything, only registers are considered since memory operands
+	// may fault
+	inline static bool
+	_ins_is_nop(const Ins& ins)
+	{
+		if (ins.dst.kind != Operand::KIND_REG)
+			return false;
+
+		if (is_mov(ins.op.kind))
+			return ins.src.kind == Operand::KIND_REG && ins.src.reg.kind == ins.dst.reg.kind;
+
+		Op_Info info{};
+		int64_t value = 0;
+		if (_op_info(ins.op.kind, info) == false || _imm_value(ins.src, value) == false)
+			return false;
+
+		if (_op_is(info, "add") || _op_is(info, "sub") ||
+			_op_is(info, "or") || _op_is(info, "xor") ||
+			_op_is(info, "shl") || _op_is(info, "shr") || _op_is(info, "sar") ||
+			_op_is(info, "rol") || _op_is(info, "ror"))
+			return value == 0;
+
+		if (_op_is(info, "mul") || _op_is(info, "div"))
+			return value == 1;
+
+		return false;
+	}
+
+	// index of the first non label instruction starting from the given index
+	inline static size_t
+	_next_ins(const Proc& proc, size_t ix)
+	{
+		while (ix < proc.ins.count && _ins_is_label(proc.ins[ix]))
+			++ix;
+		return ix;
+	}
+
+	// jump to one of the labels right after it
+	inline static bool
+	_jump_is_next(const Proc& proc, size_t ix)
+	{
+		const auto& ins = proc.ins[ix];
+		if (_ins_is_jump(ins) == false || ins.dst.kind == Operand::KIND_MEM || ins.src.kind == Operand::KIND_MEM)
+			return false;
+
+		for (size_t i = ix + 1; i < proc.ins.count && _ins_is_label(proc.ins[i]); ++i)
+			if (::strcmp(proc.ins[i].op.str, ins.lbl.str) == 0)
+				return true;
+		return false;
+	}
+
+	// the compare of a typed conditional jump, it's kept when the jump is removed since the instructions
+	// after it may read the flags
+	inline static Ins
+	_cond_jump_cmp(Src* src, const Ins& ins)
+	{
+		Op_Info info{};
+		_op_info(ins.op.kind, info);
+
+		// the cmp keywords are listed as i8, i16, i32, i64, u8, u16, u32, u64
+		int index = info.type == 'u' ? 4 : 0;
+		for (int bits = 8; bits < info.bits; bits *= 2)
+			++index;
+
+		auto kind = Tkn::KIND(Tkn::KIND_KEYWORD_I8_CMP + index);
+		auto res = ins;
+		res.op.kind = kind;
+		res.op.str = mn::str_intern(src->str_table, Tkn::NAMES[kind]);
+		res.lbl = Tkn{};
+		return res;
+	}
+
+	// follows the chain of unconditional jumps starting at the label, jump cycles are left as is
+	inline static Tkn
+	_jump_thread(const Proc& proc, const mn::Map<mn::Str, size_t>& labels, const Tkn& lbl)
+	{
+		auto target = lbl;
+		for (size_t hops = 0; hops <= proc.ins.count; ++hops)
+		{
+			auto it = mn::map_lookup(labels, mn::str_lit(target.str));
+			if (it == nullptr)
+				return target;
+
+			auto ix = _next_ins(proc, it->value);
+			if (ix >= proc.ins.count || proc.ins[ix].op.kind != Tkn::KIND_KEYWORD_JMP)
+				return target;
+
+			target = proc.ins[ix].lbl;
+		}
+		return lbl;
+	}
+
+	// merges add/sub of immediates into the same register, the merged value is kept in prev
+	inline static bool
+	_ins_merge(Src* src, Ins& prev, const Ins& ins)
+	{
+		if (prev.op.kind != ins.op.kind ||
+			prev.dst.kind != Operand::KIND_REG || ins.dst.kind != Operand::KIND_REG ||
+			prev.dst.reg.kind != ins.dst.reg.kind)
+			return false;
+
+		Op_Info info{};
+		if (_op_info(ins.op.kind, info) == false || (_op_is(info, "add") == false && _op_is(info, "sub") == false))
+			return false;
+
+		int64_t a = 0, b = 0;
+		if (_imm_value(prev.src, a) == false || _imm_value(ins.src, b) == false)
+			return false;
+
+		if ((b > 0 && a > INT64_MAX - b) || (b < 0 && a < INT64_MIN - b))
+			return false;
+
+		int64_t value = a + b;
+		if (_imm_fits(info, value) == false)
+			return false;
+
+		auto str = mn::str_tmpf("{}", value);
+		prev.src.imm.str = mn::str_intern(src->str_table, str.ptr, str.ptr + str.count);
+		prev.src.imm.rng = Rng{prev.src.imm.str, prev.src.imm.str + str.count};
+		return true;
+	}
+
+	// the generator reports jumps to labels which aren't in the proc, labels defined twice and labels
+	// named after a global, dead blocks may hold them so they're kept to report the same errors as -O0
+	inline static bool
+	_proc_labels_valid(const CFG& cfg, const mn::Map<mn::Str, bool>& globals)
+	{
+		auto labels = mn::map_new<mn::Str, bool>();
+		mn_defer(mn::map_free(labels));
+		for (const auto& block: cfg.blocks)
+		{
+			if (block.escapes)
+				return false;
+
+			for (const auto& label: block.labels)
+			{
+				auto name = mn::str_lit(label.str);
+				if (mn::map_lookup(labels, name) || mn::map_lookup(globals, name))
+					return false;
+				mn::map_insert(labels, name, true);
+			}
+		}
+		return true;
+	}
+
+	// jump threading and dead block elimination over the proc control flow graph
+	inline static bool
+	_proc_cfg_opt(Proc& proc, const mn::Map<mn::Str, bool>& globals)
+	{
+		auto cfg = cfg_build(proc);
+		mn_defer(cfg_free(cfg));
+
+		bool changed = cfg_jumps_thread(cfg);
+		if (_proc_labels_valid(cfg, globals))
+			changed |= cfg_dead_blocks_remove(cfg);
+		if (changed)
+			cfg_lower(cfg, proc);
+		return changed;
+	}
+
+	// leaf procs up to this number of instructions, labels excluded, are inlined at their call sites
+	constexpr static size_t INLINE_MAX_INS = 16;
+
+	struct Inline_Candidate
+	{
+		Src* src;
+		// null if the proc can't be inlined
+		Decl* decl;
+		// number of call sites it was inlined into
+		size_t inlined;
+	};
+
+	// small leaf procs which don't touch sp, fp or ip, since those depend on the return address
+	// pushed by the call
+	inline static bool
+	_proc_is_inlinable(const Proc& proc)
+	{
+		auto frame_regs =
+			reg_list_bit(Tkn{Tkn::KIND_KEYWORD_SP}) |
+			reg_list_bit(Tkn{Tkn::KIND_KEYWORD_FP}) |
+			reg_list_bit(Tkn{Tkn::KIND_KEYWORD_IP});
+
+		size_t count = 0;
+		for (const auto& ins: proc.ins)
+		{
+			if (_ins_is_label(ins))
+				continue;
+
+			if (ins.op.kind == Tkn::KIND_KEYWORD_CALL)
+				return false;
+
+			if (ins.op.kind != Tkn::KIND_KEYWORD_RET && ins.op.kind != Tkn::KIND_KEYWORD_HALT)
+			{
+				auto regs = ins_regs(ins);
+				if ((regs.def | regs.use) & frame_regs)
+					return false;
+			}
+
+			if (++count > INLINE_MAX_INS)
+				return false;
+		}
+		return true;
+	}
+
+	inline static Tkn
+	_tkn_rename(Src* src, const Tkn& tkn, const mn::Str& name)
+	{
+		auto res = tkn;
+		res.str = mn::str_intern(src->str_table, name.ptr, name.ptr + name.count);
+		res.rng = Rng{res.str, res.str + name.count};
+		return res;
+	}
+
+	// appends the callee body to the caller instructions, callee labels get a name which can't clash
+	// with the caller labels or the globals and rets jump to the end of the inlined body, the inlined
+	// instructions take the call position since the debug lines are written under the caller file
+	inline static void
+	_proc_inline_call(Src* src, mn::Buf<Ins>& out, const Proc& callee, const Tkn& site, size_t id)
+	{
+		auto labels = mn::map_new<mn::Str, Tkn>();
+		mn_defer(mn::map_free(labels));
+		for (const auto& ins: callee.ins)
+		{
+			if (_ins_is_label(ins))
+			{
+				auto name = mn::str_tmpf("{}@{}#{}", callee.name.str, ins.op.str, id);
+				mn::map_insert(labels, mn::str_lit(ins.op.str), _tkn_rename(src, ins.op, name));
+			}
+		}
+
+		size_t last = callee.ins.count;
+		while (last > 0 && _ins_is_label(callee.ins[last - 1]))
+			--last;
+
+		auto end_label = _tkn_rename(src, callee.name, mn::str_tmpf("{}@ret#{}", callee.name.str, id));
+		bool end_label_used = false;
+
+		for (size_t i = 0; i < callee.ins.count; ++i)
+		{
+			auto ins = callee.ins[i];
+			if (_ins_is_label(ins))
+			{
+				ins.op = mn::map_lookup(labels, mn::str_lit(ins.op.str))->value;
+			}
+			else if (ins.op.kind == Tkn::KIND_KEYWORD_RET)
+			{
+				// the last ret falls through to the rest of the caller
+				if (i + 1 == last)
+					continue;
+
+				auto jmp = _tkn_rename(src, ins.op, mn::str_lit("jmp"));
+				jmp.kind = Tkn::KIND_KEYWORD_JMP;
+				ins = Ins{};
+				ins.op = jmp;
+				ins.lbl = end_label;
+				end_label_used = true;
+			}
+			else if (_ins_is_jump(ins))
+			{
+				if (auto it = mn::map_lookup(labels, mn::str_lit(ins.lbl.str)))
+					ins.lbl = it->value;
+			}
+			ins.op.pos = site.pos;
+			mn::buf_push(out, ins);
+		}
+
+		if (end_label_used)
+		{
+			Ins ins{};
+			ins.op = end_label;
+			ins.op.pos = site.pos;
+			mn::buf_push(out, ins);
+		}
+	}
+
+	inline static void
+	_name_ref(mn::Map<mn::Str, bool>& refs, const Operand& op)
+	{
+		if (op.kind == Operand::KIND_ID)
+			mn::map_insert(refs, mn::str_lit(op.id.str), true);
+	}
+
+	// inlines small leaf procs into their callers and drops the ones left without references
+	inline static void
+	_srcs_inline(const mn::Buf<Src*>& srcs)
+	{
+		auto candidates = mn::map_new<mn::Str, Inline_Candidate>();
+		mn_defer(mn::map_free(candidates));
+
+		for (auto src: srcs)
+		{
+			for (auto decl: src->decls)
+			{
+				if (decl->kind != Decl::KIND_PROC)
+					continue;
+
+				// leave symbol redefinitions for the generator to report
+				auto name = mn::str_lit(decl->proc.name.str);
+				if (auto it = mn::map_lookup(candidates, name))
+					it->value.decl = nullptr;
+				else
+					mn::map_insert(candidates, name, Inline_Candidate{src, _proc_is_inlinable(decl->proc) ? decl : nullptr, 0});
+			}
+		}
+
+		auto ins = mn::buf_with_allocator<Ins>(mn::memory::tmp());
+		for (auto src: srcs)
+		{
+			for (auto decl: src->decls)
+			{
+				if (decl->kind != Decl::KIND_PROC)
+					continue;
+
+				auto& proc = decl->proc;
+				mn::buf_clear(ins);
+				size_t inlined = 0;
+				for (const auto& call: proc.ins)
+				{
+					auto it = call.op.kind == Tkn::KIND_KEYWORD_CALL ? mn::map_lookup(candidates, mn::str_lit(call.lbl.str)) : nullptr;
+					if (it == nullptr || it->value.decl == nullptr || it->value.decl == decl)
+					{
+						mn::buf_push(ins, call);
+						continue;
+					}
+
+					_proc_inline_call(src, ins, it->value.decl->proc, call.op, inlined++);
+					++it->value.inlined;
+				}
+
+				if (inlined == 0)
+					continue;
+
+				mn::buf_clear(proc.ins);
+				for (const auto& i: ins)
+					mn::buf_push(proc.ins, i);
+			}
+		}
+
+		// names still referenced after inlining
+		auto refs = mn::map_new<mn::Str, bool>();
+		mn_defer(mn::map_free(refs));
+		mn::map_insert(refs, mn::str_lit("main"), true);
+		for (auto src: srcs)
+		{
+			for (auto decl: src->decls)
+			{
+				if (decl->kind != Decl::KIND_PROC)
+					continue;
+
+				for (const auto& i: decl->proc.ins)
+				{
+					if (i.lbl)
+						mn::map_insert(refs, mn::str_lit(i.lbl.str), true);
+					_name_ref(refs, i.dst);
+					_name_ref(refs, i.src);
+					_name_ref(refs, i.src2);
+				}
+			}
+		}
+
+		for (const auto& [name, candidate]: candidates)
+		{
+			if (candidate.decl == nullptr || candidate.inlined == 0 || mn::map_lookup(refs, name))
+				continue;
+
+			auto& decls = candidate.src->decls;
+			for (size_t i = 0; i < decls.count; ++i)
+			{
+				if (decls[i] == candidate.decl)
+				{
+					mn::buf_remove_ordered(decls, i);
+					break;
+				}
+			}
+		}
+	}
+
+	// API
+	void
+	proc_peephole(Src* src, Proc& proc)
+	{
+		auto labels = mn::map_new<mn::Str, size_t>();
+		mn_defer(mn::map_free(labels));
+
+		bool changed = true;
+		while (changed)
+		{
+			changed = false;
+
+			mn::map_clear(labels);
+			for (size_t i = 0; i < proc.ins.count; ++i)
+				if (_ins_is_label(proc.ins[i]))
+					mn::map_insert(labels, mn::str_lit(proc.ins[i].op.str), i);
+
+			for (auto& ins: proc.ins)
+			{
+				if (_ins_is_jump(ins) == false)
+					continue;
+
+				auto target = _jump_thread(proc, labels, ins.lbl);
+				if (::strcmp(target.str, ins.lbl.str) != 0)
+				{
+					ins.lbl.str = target.str;
+					ins.lbl.rng = target.rng;
+					changed = true;
+				}
+			}
+
+			size_t count = 0;
+			for (size_t i = 0; i < proc.ins.count; ++i)
+			{
+				const auto ins = proc.ins[i];
+				if (_ins_is_nop(ins))
+				{
+					changed = true;
+					continue;
+				}
+
+				if (_jump_is_next(proc, i))
+				{
+					changed = true;
+					if (is_cond_jump(ins.op.kind))
+						proc.ins[count++] = _cond_jump_cmp(src, ins);
+					continue;
+				}
+
+				if (count > 0 && _ins_merge(src, proc.ins[count - 1], ins))
+				{
+					changed = true;
+					continue;
+				}
+
+				proc.ins[count++] = ins;
+			}
+			proc.ins.count = count;
+		}
+	}
+
+	void
+	srcs_opt(const mn::Buf<Src*>& srcs, OPT_LEVEL level)
+	{
+		if (level == OPT_LEVEL_NONE)
+			return;
+
+		auto globals = mn::map_new<mn::Str, bool>();
+		mn_defer(mn::map_free(globals));
+		for (auto src: srcs)
+			for (auto decl: src->decls)
+				mn::map_insert(globals, mn::str_lit(decl_name(decl).str), true);
+
+		// procs are optimized before inlining so more of them fit the threshold and again after to clean
+		// up the inlined bodies
+		for (int pass = 0; pass < (level >= OPT_LEVEL_2 ? 2 : 1); ++pass)
+		{
+			if (pass > 0)
+				_srcs_inline(srcs);
+
+			for (auto src: srcs)
+			{
+				for (auto decl: src->decls)
+				{
+					if (decl->kind != Decl::KIND_PROC)
+						continue;
+
+					proc_peephole(src, decl->proc);
+					// removing blocks may leave jumps to the next instruction behind
+					if (_proc_cfg_opt(decl->proc, globals))
+						proc_peephole(src, decl->proc);
+				}
+			}
+		}
+	}
+}
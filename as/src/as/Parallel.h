@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <stddef.h>
+
+namespace as
+{
+	// calls fn(i) for each i in [0, count) on the given number of workers, 0 means a worker per hardware
+	// thread, each worker takes the next index which isn't taken yet until all of them are done
+	template<typename TFunc>
+	inline static void
+	parallel_for(size_t count, size_t workers, TFunc&& fn)
+	{
+		if (workers == 0)
+			workers = std::thread::hardware_concurrency();
+		if (workers > count)
+			workers = count;
+
+		std::atomic<size_t> next{0};
+		auto worker = [&]() {
+			for(size_t i = next++; i < count; i = next++)
+				fn(i);
+		};
+
+		std::vector<std::thread> threads;
+		for(size_t i = 1; i < workers; ++i)
+			threads.emplace_back(worker);
+		worker();
+		for(auto& thread: threads)
+			thread.join();
+	}
+}
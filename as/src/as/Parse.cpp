@@ -1,15 +1,26 @@
 #include "as/Parse.h"
+#include "as/Scan.h"
+#include "Parallel.h"
 
 #include <mn/IO.h>
 #include <mn/Defer.h>
+#include <mn/Memory.h>
 
 namespace as
 {
+	// the parser walks the src tokens in place, ix always points to a token which isn't ignored
 	struct Parser
 	{
 		Src* src;
-		mn::Buf<Tkn> tkns;
 		size_t ix;
+		// where the decls are allocated, it's the src arena unless the decls are streamed
+		mn::Allocator arena;
+		// streamed parsers scan the tokens on demand into the src tokens and release each decl with
+		// its tokens and strings before parsing the next one, the scanner mark before each token is kept
+		// so the next decl is scanned again from its first token
+		Scanner* scanner;
+		mn::Str_Intern str_table;
+		mn::Buf<Scanner_Mark> marks;
 	};
 
 	inline static bool
@@ -18,36 +29,56 @@ namespace as
 		return tkn.kind == Tkn::KIND_COMMENT;
 	}
 
+	// makes sure the token at ix is loaded, streamed parsers scan it on demand
+	inline static bool
+	parser_fetch(Parser* self, size_t ix)
+	{
+		while(ix >= self->src->tkns.count && self->scanner)
+		{
+			auto mark = scanner_mark(self->scanner);
+			auto tkn = scanner_next(self->scanner);
+			if (tkn == false)
+				return false;
+			src_tkn(self->src, tkn);
+			mn::buf_push(self->marks, mark);
+		}
+		return ix < self->src->tkns.count;
+	}
+
+	// returns the index of the first token which isn't ignored starting from ix
+	inline static size_t
+	parser_skip_ignore(Parser* self, size_t ix)
+	{
+		while(parser_fetch(self, ix) && tkn_is_ignore(self->src->tkns[ix]))
+			++ix;
+		return ix;
+	}
+
 	inline static Parser
 	parser_new(Src* src)
 	{
 		Parser self{};
 		self.src = src;
-		self.tkns = mn::buf_clone(src->tkns);
-		self.ix = 0;
-		// remove ignore tokens
-		mn::buf_remove_if(self.tkns, [](const Tkn& tkn) { return tkn_is_ignore(tkn); });
+		self.arena = src->arena;
+		self.ix = parser_skip_ignore(&self, 0);
 		return self;
 	}
 
-	inline static void
-	parser_free(Parser& self)
-	{
-		mn::buf_free(self.tkns);
-	}
-
-	inline static void
-	destruct(Parser& self)
+	inline static bool
+	parser_eof(Parser* self)
 	{
-		parser_free(self);
+		return parser_fetch(self, self->ix) == false;
 	}
 
 	inline static Tkn
 	parser_look(Parser* self, size_t k)
 	{
-		if(self->ix + k >= self->tkns.count)
+		auto ix = self->ix;
+		for(size_t i = 0; i < k && parser_fetch(self, ix); ++i)
+			ix = parser_skip_ignore(self, ix + 1);
+		if(parser_fetch(self, ix) == false)
 			return Tkn{};
-		return self->tkns[self->ix + k];
+		return self->src->tkns[ix];
 	}
 
 	inline static Tkn
@@ -68,9 +99,11 @@ namespace as
 	inline static Tkn
 	parser_eat(Parser* self)
 	{
-		if(self->ix >= self->tkns.count)
+		if(parser_eof(self))
 			return Tkn{};
-		return self->tkns[self->ix++];
+		auto tkn = self->src->tkns[self->ix];
+		self->ix = parser_skip_ignore(self, self->ix + 1);
+		return tkn;
 	}
 
 	inline static Tkn
@@ -85,7 +118,7 @@ namespace as
 	inline static Tkn
 	parser_eat_must(Parser* self, Tkn::KIND kind)
 	{
-		if(self->ix >= self->tkns.count)
+		if(parser_eof(self))
 		{
 			src_err(
 				self->src,
@@ -119,6 +152,15 @@ namespace as
 		return Tkn{};
 	}
 
+	// register lists only hold r0 to r7 and fp, popping into sp or ip would move the stack or jump in the
+	// middle of the instruction
+	inline static void
+	parser_reg_list_check(Parser* self, const Tkn& reg)
+	{
+		if (reg.kind == Tkn::KIND_KEYWORD_SP || reg.kind == Tkn::KIND_KEYWORD_IP)
+			src_err(self->src, reg, mn::strf("'{}' can't be in a register list, only r0 to r7 and fp can", reg.str));
+	}
+
 	inline static Tkn
 	parser_imm(Parser* self, bool constant_allowed)
 	{
@@ -166,8 +208,24 @@ namespace as
 
 			auto base = parser_reg(self);
 
+			// optional displacement [reg + disp], [reg - disp] or [reg -disp]
+			Tkn disp_op{};
+			Tkn disp{};
+			auto next = parser_look(self);
+			if (next.kind == Tkn::KIND_PLUS || next.kind == Tkn::KIND_MINUS)
+			{
+				disp_op = parser_eat(self);
+				disp = parser_eat_must(self, Tkn::KIND_INTEGER);
+			}
+			else if (next.kind == Tkn::KIND_INTEGER && (next.str[0] == '-' || next.str[0] == '+'))
+			{
+				disp = parser_eat(self);
+			}
+
 			// eat the ]
 			parser_eat_must(self, Tkn::KIND_CLOSE_BRACKET);
+			if (disp)
+				return operand_mem_disp(base, disp_op, disp);
 			return operand_mem(base);
 		}
 
@@ -211,6 +269,35 @@ namespace as
 			ins.dst = parser_operand(self, OPERAND_FLAG_REG | OPERAND_FLAG_MEM);
 			ins.src = parser_operand(self, OPERAND_FLAG_REG | OPERAND_FLAG_MEM | OPERAND_FLAG_IMM);
 		}
+		else if (is_bitwise(op.kind))
+		{
+			ins.op = parser_eat(self);
+			ins.dst = parser_operand(self, OPERAND_FLAG_REG | OPERAND_FLAG_MEM);
+			ins.src = parser_operand(self, OPERAND_FLAG_REG | OPERAND_FLAG_MEM | OPERAND_FLAG_IMM);
+		}
+		else if (is_bitwise_unary(op.kind))
+		{
+			ins.op = parser_eat(self);
+			ins.dst = parser_operand(self, OPERAND_FLAG_REG | OPERAND_FLAG_MEM);
+		}
+		else if (is_float_unary(op.kind))
+		{
+			ins.op = parser_eat(self);
+			ins.dst = parser_operand(self, OPERAND_FLAG_REG | OPERAND_FLAG_MEM);
+		}
+		else if (is_fma(op.kind))
+		{
+			ins.op = parser_eat(self);
+			ins.dst = parser_operand(self, OPERAND_FLAG_REG | OPERAND_FLAG_MEM);
+			ins.src = parser_operand(self, OPERAND_FLAG_REG | OPERAND_FLAG_MEM | OPERAND_FLAG_IMM);
+			ins.src2 = parser_operand(self, OPERAND_FLAG_REG | OPERAND_FLAG_MEM | OPERAND_FLAG_IMM);
+		}
+		else if (is_conversion(op.kind))
+		{
+			ins.op = parser_eat(self);
+			ins.dst = parser_operand(self, OPERAND_FLAG_REG | OPERAND_FLAG_MEM);
+			ins.src = parser_operand(self, OPERAND_FLAG_REG | OPERAND_FLAG_MEM | OPERAND_FLAG_IMM);
+		}
 		else if (is_cond_jump(op.kind))
 		{
 			ins.op = parser_eat(self);
@@ -222,6 +309,29 @@ namespace as
 		{
 			ins.op = parser_eat(self);
 			ins.dst = parser_operand(self, OPERAND_FLAG_REG);
+
+			// push r0 r1 r2, multiple registers are pushed/popped in a single instruction
+			if (ins.dst.kind == Operand::KIND_REG && is_reg(parser_look(self).kind))
+			{
+				auto reg_list = reg_list_bit(ins.dst.reg);
+				parser_reg_list_check(self, ins.dst.reg);
+				while (is_reg(parser_look(self).kind))
+				{
+					auto reg = parser_eat(self);
+					parser_reg_list_check(self, reg);
+					reg_list |= reg_list_bit(reg);
+				}
+				ins.dst = operand_reg_list(reg_list);
+			}
+		}
+		else if(op.kind == Tkn::KIND_KEYWORD_ENTER)
+		{
+			ins.op = parser_eat(self);
+			ins.dst = parser_operand(self, OPERAND_FLAG_IMM);
+		}
+		else if(op.kind == Tkn::KIND_KEYWORD_LEAVE)
+		{
+			ins.op = parser_eat(self);
 		}
 		else if (is_pure_jump(op.kind))
 		{
@@ -234,6 +344,17 @@ namespace as
 			ins.dst = parser_operand(self, OPERAND_FLAG_REG | OPERAND_FLAG_MEM | OPERAND_FLAG_IMM);
 			ins.src = parser_operand(self, OPERAND_FLAG_REG | OPERAND_FLAG_MEM | OPERAND_FLAG_IMM);
 		}
+		else if(is_cmov(op.kind))
+		{
+			ins.op = parser_eat(self);
+			ins.dst = parser_operand(self, OPERAND_FLAG_REG | OPERAND_FLAG_MEM);
+			ins.src = parser_operand(self, OPERAND_FLAG_REG | OPERAND_FLAG_MEM | OPERAND_FLAG_IMM);
+		}
+		else if(is_set(op.kind))
+		{
+			ins.op = parser_eat(self);
+			ins.dst = parser_operand(self, OPERAND_FLAG_REG | OPERAND_FLAG_MEM);
+		}
 		else if (op.kind == Tkn::KIND_KEYWORD_CALL)
 		{
 			ins.op = parser_eat(self);
@@ -261,7 +382,7 @@ namespace as
 	parser_proc(Parser* self)
 	{
 		parser_eat_must(self, Tkn::KIND_KEYWORD_PROC);
-		auto proc = proc_new();
+		auto proc = proc_new(self->arena);
 		proc.name = parser_eat_must(self, Tkn::KIND_ID);
 
 		while (parser_look_kind(self, Tkn::KIND_KEYWORD_END) == false)
@@ -282,7 +403,7 @@ namespace as
 	parser_c_proc(Parser* self)
 	{
 		parser_eat_must(self, Tkn::KIND_KEYWORD_PROC);
-		auto proc = c_proc_new();
+		auto proc = c_proc_new(self->arena);
 		proc.name = parser_eat_must(self, Tkn::KIND_ID);
 
 		parser_eat_must(self, Tkn::KIND_OPEN_PAREN);
@@ -349,53 +470,144 @@ namespace as
 		mn::print_to(out, ") {}\n", proc->ret.str);
 	}
 
+	// parses the top level declaration at the cursor, returns nullptr on errors
+	inline static Decl*
+	parser_decl(Parser* self)
+	{
+		auto tkn = parser_look(self);
+		if (tkn.kind == Tkn::KIND_KEYWORD_PROC)
+		{
+			// check if the proc is C proc
+			auto proc_name = parser_look(self, 1);
+			if(mn::str_prefix(proc_name.str, "C."))
+			{
+				// the proc is allocated from the parser arena so it's released with it on errors
+				auto c_proc = parser_c_proc(self);
+				if(src_has_err(self->src))
+					return nullptr;
+				return decl_c_proc_new(c_proc, self->arena);
+			}
+			else
+			{
+				auto proc = parser_proc(self);
+				if (src_has_err(self->src))
+					return nullptr;
+				return decl_proc_new(proc, self->arena);
+			}
+		}
+		else if(tkn.kind == Tkn::KIND_KEYWORD_CONSTANT)
+		{
+			auto constant = parser_constant(self);
+			if (src_has_err(self->src))
+				return nullptr;
+			return decl_constant_new(constant, self->arena);
+		}
+
+		src_err(self->src, tkn, mn::strf("unexpected token '{}', expected a proc or a constant", tkn.str));
+		return nullptr;
+	}
+
+	// releases the last streamed decl with its tokens and strings and moves the scanner to the mark
+	inline static void
+	parser_stream_reset(Parser* self, const Scanner_Mark& mark)
+	{
+		mn::buf_clear(self->src->tkns);
+		mn::buf_clear(self->marks);
+		self->ix = 0;
+
+		mn::str_intern_free(self->str_table);
+		self->str_table = mn::str_intern_new();
+
+		mn::allocator_free(self->arena);
+		self->arena = mn::allocator_arena_new();
+
+		scanner_restart(self->scanner, mark);
+	}
+
 	// API
 	bool
 	parse(Src* src)
 	{
 		auto parser = parser_new(src);
-		mn_defer(parser_free(parser));
 
-		while(parser.ix < parser.tkns.count)
+		while(parser_eof(&parser) == false)
 		{
-			auto tkn = parser_look(&parser);
-			if (tkn.kind == Tkn::KIND_KEYWORD_PROC)
-			{
-				// check if the proc is C proc
-				auto proc_name = parser_look(&parser, 1);
-				if(mn::str_prefix(proc_name.str, "C."))
-				{
-					auto c_proc = parser_c_proc(&parser);
-					if(src_has_err(src))
-					{
-						c_proc_free(c_proc);
-						break;
-					}
-					mn::buf_push(src->decls, decl_c_proc_new(c_proc));
-				}
-				else
-				{
-					auto proc = parser_proc(&parser);
-					if (src_has_err(src))
-					{
-						proc_free(proc);
-						break;
-					}
-					mn::buf_push(src->decls, decl_proc_new(proc));
-				}
-			}
-			else if(tkn.kind == Tkn::KIND_KEYWORD_CONSTANT)
-			{
-				auto constant = parser_constant(&parser);
-				if (src_has_err(src))
-					break;
-				mn::buf_push(src->decls, decl_constant_new(constant));
-			}
+			if (auto decl = parser_decl(&parser))
+				mn::buf_push(src->decls, decl);
+			else
+				break;
 		}
 
 		return src_has_err(src) == false;
 	}
 
+	bool
+	srcs_parse(const mn::Buf<Src*>& srcs, size_t workers)
+	{
+		// srcs don't share any state so each one is scanned and parsed on its own worker
+		parallel_for(srcs.count, workers, [&](size_t i) {
+			if (scan(srcs[i]))
+				parse(srcs[i]);
+		});
+
+		for (auto src: srcs)
+			if (src_has_err(src))
+				return false;
+		return true;
+	}
+
+	Parser*
+	parser_stream_new(Src* src)
+	{
+		auto self = mn::alloc_zerod<Parser>();
+		self->src = src;
+		self->arena = mn::allocator_arena_new();
+		self->str_table = mn::str_intern_new();
+		self->scanner = scanner_new(src, &self->str_table);
+		self->marks = mn::buf_new<Scanner_Mark>();
+		return self;
+	}
+
+	void
+	parser_stream_free(Parser* self)
+	{
+		scanner_free(self->scanner);
+		mn::str_intern_free(self->str_table);
+		mn::allocator_free(self->arena);
+		mn::buf_free(self->marks);
+		mn::free(self);
+	}
+
+	Decl*
+	parser_stream_decl(Parser* self)
+	{
+		if (src_has_err(self->src))
+			return nullptr;
+
+		// the decl starts at the first token after the last one, the lines before it are released
+		auto mark = self->ix < self->marks.count ? self->marks[self->ix] : scanner_mark(self->scanner);
+		mark.offset -= src_stream_release(self->src, mark.offset, mark.pos.line);
+
+		auto errs_count = self->src->errs.count;
+		while (true)
+		{
+			parser_stream_reset(self, mark);
+			self->ix = parser_skip_ignore(self, 0);
+			Decl* decl = nullptr;
+			if (parser_eof(self) == false)
+				decl = parser_decl(self);
+
+			// the scanner only reaches the end of the content if the decl might go on past the lines read
+			// so far, in which case it's scanned again with more lines and its errors are dropped
+			if (scanner_mark(self->scanner).offset < self->src->content.count || src_stream_read(self->src) == false)
+				return decl;
+
+			for (size_t i = errs_count; i < self->src->errs.count; ++i)
+				err_free(self->src->errs[i]);
+			mn::buf_resize(self->src->errs, errs_count);
+		}
+	}
+
 	mn::Str
 	decl_dump(Src* self, mn::Allocator allocator)
 	{
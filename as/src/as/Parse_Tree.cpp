@@ -6,27 +6,27 @@ namespace as
 {
 	// API
 	Decl*
-	decl_proc_new(Proc proc)
+	decl_proc_new(Proc proc, mn::Allocator allocator)
 	{
-		auto self = mn::alloc_zerod<Decl>();
+		auto self = mn::alloc_zerod_from<Decl>(allocator);
 		self->kind = Decl::KIND_PROC;
 		self->proc = proc;
 		return self;
 	}
 
 	Decl*
-	decl_constant_new(Constant constant)
+	decl_constant_new(Constant constant, mn::Allocator allocator)
 	{
-		auto self = mn::alloc_zerod<Decl>();
+		auto self = mn::alloc_zerod_from<Decl>(allocator);
 		self->kind = Decl::KIND_CONSTANT;
 		self->constant = constant;
 		return self;
 	}
 
 	Decl*
-	decl_c_proc_new(C_Proc c_proc)
+	decl_c_proc_new(C_Proc c_proc, mn::Allocator allocator)
 	{
-		auto self = mn::alloc_zerod<Decl>();
+		auto self = mn::alloc_zerod_from<Decl>(allocator);
 		self->kind = Decl::KIND_C_PROC;
 		self->c_proc = c_proc;
 		return self;
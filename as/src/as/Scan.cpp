@@ -1,8 +1,20 @@
 #include "as/Scan.h"
 
 #include <mn/IO.h>
+#include <mn/Memory.h>
 #include <mn/Rune.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AS_SCAN_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace as
 {
 	struct Scanner
@@ -11,18 +23,25 @@ namespace as
 		const char* it;
 		mn::Rune c;
 		Pos pos;
+		// table where the tokens strings are interned, it's the src table unless the tokens are streamed
+		mn::Str_Intern* str_table;
+		// streamed tokens don't record the src lines to keep the memory bounded
+		bool record_lines;
 	};
 
 	inline static Scanner
-	scanner_new(Src* src)
+	_scanner_init(Src* src, mn::Str_Intern* str_table, bool record_lines)
 	{
 		Scanner self{};
 		self.src = src;
 		self.it = begin(src->content);
 		self.c = mn::rune_read(self.it);
 		self.pos = Pos{1, 0};
+		self.str_table = str_table;
+		self.record_lines = record_lines;
 
-		src_line_begin(self.src, self.it);
+		if (self.record_lines)
+			src_line_begin(self.src, self.it);
 		return self;
 	}
 
@@ -74,28 +93,402 @@ namespace as
 		{
 			self->pos.col = 1;
 			self->pos.line++;
-			src_line_end(self->src, prev_it);
-			src_line_begin(self->src, self->it);
+			if (self->record_lines)
+			{
+				src_line_end(self->src, prev_it);
+				src_line_begin(self->src, self->it);
+			}
 		}
 		return true;
 	}
 
+	// ascii fast paths, the scanner spends most of its time in whitespaces, comments and identifiers
+	// which are almost always ascii so we classify a chunk of bytes at a time and only fall back to
+	// the rune by rune path when we hit a non ascii byte
+#if defined(__AVX2__)
+	typedef __m256i Chunk;
+	constexpr size_t CHUNK_SIZE = 32;
+	constexpr uint32_t CHUNK_FULL = 0xFFFFFFFF;
+
+	inline static Chunk
+	chunk_load(const char* ptr)
+	{
+		return _mm256_loadu_si256((const __m256i*)ptr);
+	}
+
+	inline static Chunk
+	chunk_eq(Chunk c, char b)
+	{
+		return _mm256_cmpeq_epi8(c, _mm256_set1_epi8(b));
+	}
+
+	// signed compare so non ascii bytes are never in range
+	inline static Chunk
+	chunk_in_range(Chunk c, char lo, char hi)
+	{
+		return _mm256_and_si256(
+			_mm256_cmpgt_epi8(c, _mm256_set1_epi8(lo - 1)),
+			_mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), c)
+		);
+	}
+
+	inline static Chunk
+	chunk_or(Chunk a, Chunk b)
+	{
+		return _mm256_or_si256(a, b);
+	}
+
+	inline static Chunk
+	chunk_lower(Chunk c)
+	{
+		return _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+	}
+
+	inline static uint32_t
+	chunk_mask(Chunk c)
+	{
+		return uint32_t(_mm256_movemask_epi8(c));
+	}
+#elif AS_SCAN_SSE2
+	typedef __m128i Chunk;
+	constexpr size_t CHUNK_SIZE = 16;
+	constexpr uint32_t CHUNK_FULL = 0xFFFF;
+
+	inline static Chunk
+	chunk_load(const char* ptr)
+	{
+		return _mm_loadu_si128((const __m128i*)ptr);
+	}
+
+	inline static Chunk
+	chunk_eq(Chunk c, char b)
+	{
+		return _mm_cmpeq_epi8(c, _mm_set1_epi8(b));
+	}
+
+	// signed compare so non ascii bytes are never in range
+	inline static Chunk
+	chunk_in_range(Chunk c, char lo, char hi)
+	{
+		return _mm_and_si128(
+			_mm_cmpgt_epi8(c, _mm_set1_epi8(lo - 1)),
+			_mm_cmplt_epi8(c, _mm_set1_epi8(hi + 1))
+		);
+	}
+
+	inline static Chunk
+	chunk_or(Chunk a, Chunk b)
+	{
+		return _mm_or_si128(a, b);
+	}
+
+	inline static Chunk
+	chunk_lower(Chunk c)
+	{
+		return _mm_or_si128(c, _mm_set1_epi8(0x20));
+	}
+
+	inline static uint32_t
+	chunk_mask(Chunk c)
+	{
+		return uint32_t(_mm_movemask_epi8(c));
+	}
+#endif
+
+	inline static size_t
+	mask_ctz(uint32_t mask)
+	{
+	#if defined(_MSC_VER)
+		unsigned long index = 0;
+		_BitScanForward(&index, mask);
+		return index;
+	#else
+		return __builtin_ctz(mask);
+	#endif
+	}
+
+	enum ASCII_RUN
+	{
+		ASCII_RUN_COMMENT,
+		ASCII_RUN_ID,
+	};
+
+	inline static bool
+	ascii_run_stop(uint8_t c, ASCII_RUN run)
+	{
+		switch(run)
+		{
+		case ASCII_RUN_COMMENT:
+			return c == '\n' || c >= 0x80;
+		case ASCII_RUN_ID:
+			return (
+				((c | 0x20) >= 'a' && (c | 0x20) <= 'z') ||
+				(c >= '0' && c <= '9') ||
+				c == '_' ||
+				c == '.'
+			) == false;
+		default:
+			assert(false && "unreachable");
+			return true;
+		}
+	}
+
+#if defined(__AVX2__) || AS_SCAN_SSE2
+	// bit i is set if the i-th byte of the chunk ends the run
+	inline static uint32_t
+	ascii_run_stop_mask(Chunk c, ASCII_RUN run)
+	{
+		switch(run)
+		{
+		case ASCII_RUN_COMMENT:
+			// the sign bit of each byte is the non ascii mask
+			return chunk_mask(c) | chunk_mask(chunk_eq(c, '\n'));
+		case ASCII_RUN_ID:
+		{
+			auto id = chunk_or(
+				chunk_or(chunk_in_range(chunk_lower(c), 'a', 'z'), chunk_in_range(c, '0', '9')),
+				chunk_or(chunk_eq(c, '_'), chunk_eq(c, '.'))
+			);
+			return ~chunk_mask(id) & CHUNK_FULL;
+		}
+		default:
+			assert(false && "unreachable");
+			return CHUNK_FULL;
+		}
+	}
+#endif
+
+	// eats the ascii run of the given kind, none of the eaten bytes is a newline so only the column changes
+	inline static void
+	scanner_eat_ascii_run(Scanner* self, ASCII_RUN run)
+	{
+		auto it = self->it;
+		auto end_it = end(self->src->content);
+	#if defined(__AVX2__) || AS_SCAN_SSE2
+		while (size_t(end_it - it) >= CHUNK_SIZE)
+		{
+			auto stop = ascii_run_stop_mask(chunk_load(it), run);
+			if (stop)
+			{
+				it += mask_ctz(stop);
+				break;
+			}
+			it += CHUNK_SIZE;
+		}
+	#endif
+		while (it < end_it && ascii_run_stop(uint8_t(*it), run) == false)
+			++it;
+
+		self->pos.col += uint32_t(it - self->it);
+		self->it = it;
+		self->c = mn::rune_read(self->it);
+	}
+
+	inline static void
+	scanner_newline(Scanner* self, const char* newline)
+	{
+		self->pos.line++;
+		if (self->record_lines)
+		{
+			src_line_end(self->src, newline);
+			src_line_begin(self->src, newline + 1);
+		}
+	}
+
+	// keywords perfect hash, it's built at compile time using hash and displace, keywords are split
+	// into buckets by their hash then the buckets are placed into the table from the largest to the
+	// smallest each with a displacement which puts all of its keywords into empty slots, so a lookup
+	// is a hash, a table read and a single compare
+	constexpr size_t KEYWORD_COUNT = size_t(Tkn::KIND_KEYWORDS__END) - size_t(Tkn::KIND_KEYWORDS__BEGIN) - 1;
+	constexpr size_t KEYWORD_TABLE_SIZE = 2048;
+	constexpr size_t KEYWORD_BUCKET_COUNT = 512;
+	constexpr size_t KEYWORD_BUCKET_CAPACITY = 16;
+	static_assert((KEYWORD_TABLE_SIZE & (KEYWORD_TABLE_SIZE - 1)) == 0, "keyword table size should be a power of 2");
+	static_assert(KEYWORD_TABLE_SIZE >= 2 * KEYWORD_COUNT, "keyword table is too small for the keywords count");
+
+	// fnv-1a hash of the ascii lower case string, all the keywords are ascii
+	constexpr inline uint64_t
+	keyword_hash(const char* str)
+	{
+		uint64_t h = 14695981039346656037ULL;
+		for(; *str; ++str)
+		{
+			auto c = uint8_t(*str);
+			if (c >= 'A' && c <= 'Z')
+				c += 'a' - 'A';
+			h ^= c;
+			h *= 1099511628211ULL;
+		}
+		return h;
+	}
+
+	constexpr inline size_t
+	keyword_slot(uint64_t h, uint32_t displacement)
+	{
+		h ^= displacement * 0x9E3779B97F4A7C15ULL;
+		h ^= h >> 29;
+		h *= 0xBF58476D1CE4E5B9ULL;
+		h ^= h >> 32;
+		return size_t(h & (KEYWORD_TABLE_SIZE - 1));
+	}
+
+	struct Keyword_Table
+	{
+		uint32_t displacements[KEYWORD_BUCKET_COUNT];
+		Tkn::KIND kinds[KEYWORD_TABLE_SIZE];
+	};
+
+	constexpr inline Keyword_Table
+	keyword_table_build()
+	{
+		Keyword_Table self{};
+		for(auto& kind: self.kinds)
+			kind = Tkn::KIND_NONE;
+
+		uint64_t hashes[KEYWORD_COUNT]{};
+		size_t buckets[KEYWORD_BUCKET_COUNT][KEYWORD_BUCKET_CAPACITY]{};
+		size_t bucket_sizes[KEYWORD_BUCKET_COUNT]{};
+		for(size_t i = 0; i < KEYWORD_COUNT; ++i)
+		{
+			hashes[i] = keyword_hash(Tkn::NAMES[Tkn::KIND_KEYWORDS__BEGIN + 1 + i]);
+			auto b = hashes[i] % KEYWORD_BUCKET_COUNT;
+			if (bucket_sizes[b] == KEYWORD_BUCKET_CAPACITY)
+				throw "keyword bucket overflow, increase the bucket count";
+			buckets[b][bucket_sizes[b]++] = i;
+		}
+
+		// place the largest buckets first while the table is still empty
+		for(size_t size = KEYWORD_BUCKET_CAPACITY; size > 0; --size)
+		{
+			for(size_t b = 0; b < KEYWORD_BUCKET_COUNT; ++b)
+			{
+				if (bucket_sizes[b] != size)
+					continue;
+
+				size_t slots[KEYWORD_BUCKET_CAPACITY]{};
+				for(uint32_t d = 0; ; ++d)
+				{
+					bool found = true;
+					for(size_t i = 0; i < size && found; ++i)
+					{
+						slots[i] = keyword_slot(hashes[buckets[b][i]], d);
+						if (self.kinds[slots[i]] != Tkn::KIND_NONE)
+							found = false;
+						for(size_t j = 0; j < i && found; ++j)
+							if (slots[j] == slots[i])
+								found = false;
+					}
+
+					if (found)
+					{
+						self.displacements[b] = d;
+						for(size_t i = 0; i < size; ++i)
+							self.kinds[slots[i]] = Tkn::KIND(Tkn::KIND_KEYWORDS__BEGIN + 1 + buckets[b][i]);
+						break;
+					}
+				}
+			}
+		}
+		return self;
+	}
+
+	constexpr Keyword_Table KEYWORD_TABLE = keyword_table_build();
+
+	inline static bool
+	keyword_equal(const char* a, const char* b, bool case_insensitive)
+	{
+		for(; *a && *b; ++a, ++b)
+		{
+			auto x = uint8_t(*a);
+			auto y = uint8_t(*b);
+			if (case_insensitive)
+			{
+				if (x >= 'A' && x <= 'Z')
+					x += 'a' - 'A';
+				if (y >= 'A' && y <= 'Z')
+					y += 'a' - 'A';
+			}
+			if (x != y)
+				return false;
+		}
+		return *a == *b;
+	}
+
+	inline static Tkn::KIND
+	keyword_lookup(const char* str)
+	{
+		auto h = keyword_hash(str);
+		auto d = KEYWORD_TABLE.displacements[h % KEYWORD_BUCKET_COUNT];
+		auto kind = KEYWORD_TABLE.kinds[keyword_slot(h, d)];
+		if (kind != Tkn::KIND_NONE && keyword_equal(str, Tkn::NAMES[kind], !is_ctype(kind)))
+			return kind;
+		return Tkn::KIND_ID;
+	}
+
+	// all the whitespaces are ascii so they are skipped in bulk, every newline is still recorded in
+	// the lines table and the column ends up the same as eating them one by one
 	inline static void
 	scanner_skip_whitespaces(Scanner* self)
 	{
-		while(is_whitespace(self->c))
-			if(scanner_eat(self) == false)
+		auto it = self->it;
+		auto end_it = end(self->src->content);
+		const char* last_newline = nullptr;
+	#if defined(__AVX2__) || AS_SCAN_SSE2
+		while (size_t(end_it - it) >= CHUNK_SIZE)
+		{
+			auto c = chunk_load(it);
+			auto newlines = chunk_eq(c, '\n');
+			auto whitespaces = chunk_or(
+				chunk_or(newlines, chunk_eq(c, ' ')),
+				chunk_or(chunk_or(chunk_eq(c, '\r'), chunk_eq(c, '\t')), chunk_eq(c, '\v'))
+			);
+			auto stop = ~chunk_mask(whitespaces) & CHUNK_FULL;
+			// only the newlines before the first non whitespace byte are eaten
+			auto newlines_mask = chunk_mask(newlines);
+			if (stop)
+				newlines_mask &= (stop & (0 - stop)) - 1;
+			for (; newlines_mask; newlines_mask &= newlines_mask - 1)
+			{
+				last_newline = it + mask_ctz(newlines_mask);
+				scanner_newline(self, last_newline);
+			}
+
+			if (stop)
+			{
+				it += mask_ctz(stop);
 				break;
+			}
+			it += CHUNK_SIZE;
+		}
+	#endif
+		for (; it < end_it && is_whitespace(uint8_t(*it)); ++it)
+		{
+			if (*it == '\n')
+			{
+				last_newline = it;
+				scanner_newline(self, last_newline);
+			}
+		}
+
+		// eating a newline resets the column to 1
+		if (last_newline)
+			self->pos.col = uint32_t(it - last_newline);
+		else
+			self->pos.col += uint32_t(it - self->it);
+		self->it = it;
+		self->c = mn::rune_read(self->it);
 	}
 
 	inline static const char*
 	scanner_id(Scanner* self)
 	{
 		auto begin_it = self->it;
+		scanner_eat_ascii_run(self, ASCII_RUN_ID);
+		// the rest of the identifier, if any, has non ascii letters
 		while(is_letter(self->c) || is_digit(self->c) || self->c == '.')
 			if(scanner_eat(self) == false)
 				break;
-		return mn::str_intern(self->src->str_table, begin_it, self->it);
+		return mn::str_intern(*self->str_table, begin_it, self->it);
 	}
 
 	inline static int
@@ -159,7 +552,7 @@ namespace as
 						mn::strf("illegal int literal {}", self->c)
 					});
 				}
-				tkn.str = str_intern(self->src->str_table, begin_it, self->it);
+				tkn.str = str_intern(*self->str_table, begin_it, self->it);
 				return;
 			}
 
@@ -214,34 +607,7 @@ namespace as
 		}
 
 		//finished the parsing of the number whether it's a float or int
-		tkn.str = str_intern(self->src->str_table, begin_it, self->it);
-	}
-
-	inline static bool
-	is_same_keyword(const char* a, const char* b, bool case_insensitive)
-	{
-		auto a_count = mn::rune_count(a);
-		auto b_count = mn::rune_count(b);
-		if(a_count != b_count)
-			return false;
-
-		if(case_insensitive)
-		{
-			for(size_t i = 0; i < a_count; ++i)
-			{
-				if(mn::rune_lower(mn::rune_read(a)) != mn::rune_lower(mn::rune_read(b)))
-				{
-					return false;
-				}
-				a = mn::rune_next(a);
-				b = mn::rune_next(b);
-			}
-			return true;
-		}
-		else
-		{
-			return ::strcmp(a, b) == 0;
-		}
+		tkn.str = str_intern(*self->str_table, begin_it, self->it);
 	}
 
 	inline static const char*
@@ -249,6 +615,10 @@ namespace as
 	{
 		auto begin_it = self->it;
 		auto prev = self->c;
+		scanner_eat_ascii_run(self, ASCII_RUN_COMMENT);
+		if (self->it != begin_it)
+			prev = self->it[-1];
+		// the rest of the comment, if any, has non ascii runes
 		while (self->c != '\n')
 		{
 			prev = self->c;
@@ -260,7 +630,7 @@ namespace as
 		if (prev == '\r')
 			--end_it;
 
-		return mn::str_intern(self->src->str_table, begin_it, end_it);
+		return mn::str_intern(*self->str_table, begin_it, end_it);
 	}
 
 	inline static void
@@ -283,7 +653,7 @@ namespace as
 
 		end_it = self->it;
 		scanner_eat(self); // for the "
-		tkn->str = mn::str_intern(self->src->str_table, begin_it, end_it);
+		tkn->str = mn::str_intern(*self->str_table, begin_it, end_it);
 		tkn->rng.begin = begin_it;
 		tkn->rng.end = end_it;
 	}
@@ -302,30 +672,16 @@ namespace as
 		bool no_rng = false;
 		if(is_letter(self->c))
 		{
-			tkn.kind = Tkn::KIND_ID;
 			tkn.str = scanner_id(self);
-
-			//let's loop over all the keywords and check them
-			for(size_t i = size_t(Tkn::KIND_KEYWORDS__BEGIN + 1);
-				i < size_t(Tkn::KIND_KEYWORDS__END);
-				++i)
-			{
-				if(is_same_keyword(tkn.str, Tkn::NAMES[i], !is_ctype(Tkn::KIND(i))))
-				{
-					tkn.kind = Tkn::KIND(i);
-					break;
-				}
-			}
+			tkn.kind = keyword_lookup(tkn.str);
 		}
 		else if(is_digit(self->c))
 		{
 			scanner_num(self, tkn);
 		}
-		else if(self->c == '-' || self->c == '+')
+		else if((self->c == '-' || self->c == '+') && is_digit(mn::rune_read(mn::rune_next(self->it))))
 		{
-			auto next = mn::rune_read(mn::rune_next(self->it));
-			if(is_digit(next))
-				scanner_num(self, tkn);
+			scanner_num(self, tkn);
 		}
 		else
 		{
@@ -341,6 +697,16 @@ namespace as
 				tkn.str = ":";
 				no_intern = true;
 				break;
+			case '+':
+				tkn.kind = Tkn::KIND_PLUS;
+				tkn.str = "+";
+				no_intern = true;
+				break;
+			case '-':
+				tkn.kind = Tkn::KIND_MINUS;
+				tkn.str = "-";
+				no_intern = true;
+				break;
 			case '(':
 				tkn.kind = Tkn::KIND_OPEN_PAREN;
 				tkn.str = "(";
@@ -383,7 +749,7 @@ namespace as
 			}
 
 			if (no_intern == false)
-				tkn.str = mn::str_intern(self->src->str_table, tkn.rng.begin, self->it);
+				tkn.str = mn::str_intern(*self->str_table, tkn.rng.begin, self->it);
 		}
 		if(no_rng == false)
 			tkn.rng.end = self->it;
@@ -394,7 +760,7 @@ namespace as
 	bool
 	scan(Src* src)
 	{
-		auto scanner = scanner_new(src);
+		auto scanner = _scanner_init(src, &src->str_table, true);
 		while(true)
 		{
 			if(auto tkn = scanner_tkn(&scanner))
@@ -404,4 +770,38 @@ namespace as
 		}
 		return src_has_err(src) == false;
 	}
-}
\ No newline at end of file
+
+	Scanner*
+	scanner_new(Src* src, mn::Str_Intern* str_table)
+	{
+		auto self = mn::alloc<Scanner>();
+		*self = _scanner_init(src, str_table, false);
+		return self;
+	}
+
+	void
+	scanner_free(Scanner* self)
+	{
+		mn::free(self);
+	}
+
+	Tkn
+	scanner_next(Scanner* self)
+	{
+		return scanner_tkn(self);
+	}
+
+	Scanner_Mark
+	scanner_mark(const Scanner* self)
+	{
+		return Scanner_Mark{size_t(self->it - begin(self->src->content)), self->pos};
+	}
+
+	void
+	scanner_restart(Scanner* self, const Scanner_Mark& mark)
+	{
+		self->it = begin(self->src->content) + mark.offset;
+		self->c = mn::rune_read(self->it);
+		self->pos = mark.pos;
+	}
+}
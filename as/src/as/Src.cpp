@@ -5,19 +5,30 @@
 #include <mn/Defer.h>
 #include <mn/IO.h>
 
+#include <string.h>
+
 namespace as
 {
+	constexpr size_t SRC_ARENA_BLOCK_SIZE = 1024 * 1024;
+
 	inline static Src*
 	src_new(const mn::Str& path, const mn::Str& code)
 	{
 		auto self = mn::alloc<Src>();
+		self->arena = mn::allocator_arena_new(SRC_ARENA_BLOCK_SIZE);
 		self->path = path;
 		self->content = code;
-		self->lines = mn::buf_new<Line>();
+		self->lines = mn::buf_with_allocator<Line>(self->arena);
+		mn::allocator_push(self->arena);
 		self->str_table = mn::str_intern_new();
-		self->errs = mn::buf_new<Err>();
-		self->tkns = mn::buf_new<Tkn>();
-		self->decls = mn::buf_new<Decl*>();
+		mn::allocator_pop();
+		self->errs = mn::buf_with_allocator<Err>(self->arena);
+		self->tkns = mn::buf_with_allocator<Tkn>(self->arena);
+		self->decls = mn::buf_with_allocator<Decl*>(self->arena);
+		self->file = nullptr;
+		self->pending = mn::str_new();
+		self->chunk_size = SRC_STREAM_CHUNK_SIZE;
+		self->content_line = 1;
 		return self;
 	}
 
@@ -34,16 +45,86 @@ namespace as
 		return src_new(mn::str_from_c("<STRING>"), mn::str_from_c(code));
 	}
 
+	Src*
+	src_stream_from_file(const char* path, size_t chunk_size)
+	{
+		auto content = mn::str_new();
+		mn::str_null_terminate(content);
+		auto self = src_new(mn::str_from_c(path), content);
+		self->file = mn::file_open(path, mn::IO_MODE::READ, mn::OPEN_MODE::OPEN_ONLY);
+		if (chunk_size > 0)
+			self->chunk_size = chunk_size;
+		return self;
+	}
+
+	bool
+	src_stream_read(Src* self)
+	{
+		if (self->file == nullptr)
+			return false;
+
+		auto size = self->content.count > self->chunk_size ? self->content.count : self->chunk_size;
+		size_t lines_end = 0;
+		while (true)
+		{
+			auto count = self->pending.count;
+			mn::str_resize(self->pending, count + size);
+			auto read = mn::stream_read(self->file, mn::Block{self->pending.ptr + count, size});
+			mn::str_resize(self->pending, count + read);
+
+			// the end of the file ends the last line
+			if (read == 0)
+			{
+				mn::file_close(self->file);
+				self->file = nullptr;
+				lines_end = self->pending.count;
+				break;
+			}
+
+			for (size_t i = self->pending.count; i > count; --i)
+			{
+				if (self->pending[i - 1] == '\n')
+				{
+					lines_end = i;
+					break;
+				}
+			}
+			if (lines_end > 0)
+				break;
+		}
+
+		mn::str_push(self->content, self->pending.ptr, self->pending.ptr + lines_end);
+		::memmove(self->pending.ptr, self->pending.ptr + lines_end, self->pending.count - lines_end);
+		mn::str_resize(self->pending, self->pending.count - lines_end);
+		return lines_end > 0;
+	}
+
+	size_t
+	src_stream_release(Src* self, size_t offset, uint32_t line)
+	{
+		auto line_begin = offset;
+		while (line_begin > 0 && self->content[line_begin - 1] != '\n')
+			--line_begin;
+		if (line_begin == 0 || line_begin < self->content.count / 2)
+			return 0;
+
+		::memmove(self->content.ptr, self->content.ptr + line_begin, self->content.count - line_begin);
+		mn::str_resize(self->content, self->content.count - line_begin);
+		self->content_line = line;
+		return line_begin;
+	}
+
 	void
 	src_free(Src* self)
 	{
+		if (self->file)
+			mn::file_close(self->file);
+		mn::str_free(self->pending);
 		mn::str_free(self->path);
 		mn::str_free(self->content);
-		destruct(self->lines);
-		mn::str_intern_free(self->str_table);
+		// error messages are allocated by whoever reported them, not always from the arena
 		destruct(self->errs);
-		mn::buf_free(self->tkns);
-		destruct(self->decls);
+		mn::allocator_free(self->arena);
 		mn::free(self);
 	}
 
@@ -69,6 +150,35 @@ namespace as
 		return mn::memory_stream_str(out);
 	}
 
+	// streamed sources don't record the lines table so we look for the line in the content instead
+	inline static Line
+	_src_line(Src* self, uint32_t line)
+	{
+		// errors without a position or on lines a streamed src released
+		if (line < self->content_line)
+			return Line{};
+
+		if (line <= self->lines.count)
+			return self->lines[line - 1];
+
+		line -= self->content_line - 1;
+
+		Line res{begin(self->content), end(self->content)};
+		for (const char* it = begin(self->content); it != end(self->content); ++it)
+		{
+			if (*it != '\n')
+				continue;
+
+			if (--line == 0)
+			{
+				res.end = it;
+				break;
+			}
+			res.begin = it + 1;
+		}
+		return res;
+	}
+
 	mn::Str
 	src_errs_dump(Src* self, mn::Allocator allocator)
 	{
@@ -77,9 +187,9 @@ namespace as
 
 		for(const Err& e: self->errs)
 		{
-			Line l = self->lines[e.pos.line - 1];
+			Line l = _src_line(self, e.pos.line);
 			//we need to put ^^^ under the word the compiler means by the error
-			if(e.rng.begin && e.rng.end)
+			if(e.rng.begin && e.rng.end && l.begin)
 			{
 				mn::print_to(out, ">> {}\n", mn::str_from_substr(l.begin, l.end, mn::memory::tmp()));
 				mn::print_to(out, ">> ");
@@ -0,0 +1,380 @@
+#include "as/Synth.h"
+
+#include <mn/Buf.h>
+#include <mn/Defer.h>
+
+#include <string.h>
+#include <assert.h>
+
+namespace as
+{
+	struct Synth_C_Proc
+	{
+		const char* name;
+		const char* type;
+		// size of the argument and the return value on the stack
+		size_t size;
+	};
+
+	// libc procs which are defined for any argument in [0, 127]
+	constexpr static Synth_C_Proc SYNTH_C_PROCS[] = {
+		{"abs", "C.int32", 4},
+		{"labs", "C.int64", 8},
+		{"toupper", "C.int32", 4},
+		{"tolower", "C.int32", 4},
+		{"isdigit", "C.int32", 4},
+		{"isalpha", "C.int32", 4},
+		{"isspace", "C.int32", 4},
+		{"llabs", "C.int64", 8},
+	};
+	constexpr static size_t SYNTH_C_PROCS_COUNT = sizeof(SYNTH_C_PROCS) / sizeof(*SYNTH_C_PROCS);
+
+	// 8 bytes stack slots of each proc frame, they're all written before anything reads them
+	constexpr static size_t SYNTH_FRAME_SLOTS = 4;
+	// r7 is the loop counter so the random instructions use r0 to r6
+	constexpr static uint64_t SYNTH_REGS_COUNT = 7;
+
+	struct Synth
+	{
+		const Synth_Config* config;
+		uint64_t state;
+		mn::Str out;
+	};
+
+	inline static uint64_t
+	_synth_rand(Synth& self)
+	{
+		self.state ^= self.state << 13;
+		self.state ^= self.state >> 7;
+		self.state ^= self.state << 17;
+		return self.state;
+	}
+
+	// random number in [0, n)
+	inline static uint64_t
+	_synth_range(Synth& self, uint64_t n)
+	{
+		return n ? _synth_rand(self) % n : 0;
+	}
+
+	inline static const char*
+	_synth_int_type(Synth& self)
+	{
+		const char* types[] = {"i32", "i64", "u32", "u64"};
+		return types[_synth_range(self, 4)];
+	}
+
+	inline static void
+	_synth_proc_name(Synth& self, size_t index)
+	{
+		if (index == 0)
+			mn::str_push(self.out, "main");
+		else
+			self.out = mn::strf(self.out, "p{}", index);
+	}
+
+	inline static size_t
+	_synth_constant_size(size_t index)
+	{
+		return mn::str_tmpf("synth constant {}", index).count;
+	}
+
+	// reads a byte of a constant, the address is masked out so the checksum doesn't depend on where the
+	// constants are loaded
+	inline static void
+	_synth_constant_read(Synth& self, uint64_t reg)
+	{
+		auto index = _synth_range(self, self.config->constants);
+		auto offset = _synth_range(self, _synth_constant_size(index));
+		self.out = mn::strf(self.out, "\tu64.mov r{} c{}\n", reg, index);
+		self.out = mn::strf(self.out, "\tu8.mov r{} [r{} + {}]\n", reg, reg, offset);
+		self.out = mn::strf(self.out, "\tu64.and r{} 255\n", reg);
+	}
+
+	// the return value slot is at sp and the argument is right after it
+	inline static void
+	_synth_c_call(Synth& self, uint64_t arg, uint64_t res)
+	{
+		const auto& c_proc = SYNTH_C_PROCS[_synth_range(self, self.config->c_procs)];
+		auto type = c_proc.size == 4 ? "i32" : "i64";
+		self.out = mn::strf(self.out, "\tu64.and r{} 127\n", arg);
+		self.out = mn::strf(self.out, "\ti64.sub sp {}\n", c_proc.size * 2);
+		self.out = mn::strf(self.out, "\t{}.mov [sp + {}] r{}\n", type, c_proc.size, arg);
+		self.out = mn::strf(self.out, "\tcall C.{}\n", c_proc.name);
+		self.out = mn::strf(self.out, "\t{}.mov r{} [sp]\n", type, res);
+		self.out = mn::strf(self.out, "\ti64.add sp {}\n", c_proc.size * 2);
+	}
+
+	inline static void
+	_synth_ins(Synth& self)
+	{
+		auto a = _synth_range(self, SYNTH_REGS_COUNT);
+		auto b = _synth_range(self, SYNTH_REGS_COUNT);
+		switch (_synth_range(self, 16))
+		{
+		case 0:
+			self.out = mn::strf(self.out, "\t{}.add r{} r{}\n", _synth_int_type(self), a, b);
+			break;
+		case 1:
+			self.out = mn::strf(self.out, "\t{}.sub r{} {}\n", _synth_int_type(self), a, _synth_range(self, 1000));
+			break;
+		case 2:
+			self.out = mn::strf(self.out, "\t{}.mul r{} {}\n", _synth_int_type(self), a, _synth_range(self, 8) * 2 + 1);
+			break;
+		case 3:
+			self.out = mn::strf(self.out, "\tu64.xor r{} r{}\n", a, b);
+			break;
+		case 4:
+			self.out = mn::strf(self.out, "\tu64.and r{} r{}\n", a, b);
+			break;
+		case 5:
+			self.out = mn::strf(self.out, "\tu64.or r{} {}\n", a, _synth_range(self, 256));
+			break;
+		case 6:
+			self.out = mn::strf(self.out, "\tu64.shl r{} {}\n", a, _synth_range(self, 7) + 1);
+			break;
+		case 7:
+			self.out = mn::strf(self.out, "\tu64.shr r{} {}\n", a, _synth_range(self, 7) + 1);
+			break;
+		case 8:
+			self.out = mn::strf(self.out, "\tu64.rol r{} {}\n", a, _synth_range(self, 7) + 1);
+			break;
+		case 9:
+			self.out = mn::strf(self.out, "\ti64.mov r{} {}\n", a, int64_t(_synth_range(self, 2000)) - 1000);
+			break;
+		case 10:
+			self.out = mn::strf(self.out, "\ti64.mov [fp - {}] r{}\n", (_synth_range(self, SYNTH_FRAME_SLOTS) + 1) * 8, a);
+			break;
+		case 11:
+			self.out = mn::strf(self.out, "\ti64.mov r{} [fp - {}]\n", a, (_synth_range(self, SYNTH_FRAME_SLOTS) + 1) * 8);
+			break;
+		case 12:
+			self.out = mn::strf(self.out, "\tpush r{}\n\tpop r{}\n", a, b);
+			break;
+		case 13:
+			self.out = mn::strf(self.out, "\tu64.div r{} {}\n", a, _synth_range(self, 9) + 1);
+			break;
+		case 14:
+			if (self.config->constants > 0)
+				_synth_constant_read(self, a);
+			else
+				self.out = mn::strf(self.out, "\ti64.add r{} r{}\n", a, b);
+			break;
+		case 15:
+			if (self.config->c_procs > 0)
+				_synth_c_call(self, a, b);
+			else
+				self.out = mn::strf(self.out, "\tu64.xor r{} r{}\n", a, b);
+			break;
+		default:
+			assert(false && "unreachable");
+			break;
+		}
+	}
+
+	// the proc body is split into segments by its labels, the odd labels are loop heads and their segment
+	// loops back to them, the even labels are the targets of a forward jump at the start of the segment
+	// before them, the calls go at the end of the segments which don't loop
+	inline static void
+	_synth_proc(Synth& self, size_t index, const size_t* children, size_t children_count)
+	{
+		const auto& config = *self.config;
+		auto segments_count = config.labels_per_proc + 1;
+
+		auto calls = mn::buf_new<size_t>();
+		mn_defer(mn::buf_free(calls));
+		mn::buf_resize_fill(calls, segments_count, size_t(0));
+		auto straight_count = segments_count / 2 + segments_count % 2;
+		for (size_t i = 0; i < children_count; ++i)
+			++calls[_synth_range(self, straight_count) * 2];
+
+		mn::str_push(self.out, "\nproc ");
+		_synth_proc_name(self, index);
+		mn::str_push(self.out, "\n");
+		self.out = mn::strf(self.out, "\tenter {}\n", SYNTH_FRAME_SLOTS * 8);
+		for (size_t i = 0; i < SYNTH_FRAME_SLOTS; ++i)
+			self.out = mn::strf(self.out, "\ti64.mov [fp - {}] r{}\n", (i + 1) * 8, i);
+
+		const size_t* next_child = children;
+		for (size_t segment = 0; segment < segments_count; ++segment)
+		{
+			bool is_loop = segment % 2 == 1;
+			if (is_loop)
+				self.out = mn::strf(self.out, "\ti64.mov r7 {}\n", config.loop_count);
+			if (segment > 0)
+				self.out = mn::strf(self.out, "l{}:\n", segment);
+			if (is_loop && segment + 1 < segments_count)
+			{
+				self.out = mn::strf(
+					self.out,
+					"\tu64.jl r{} {} l{}\n",
+					_synth_range(self, SYNTH_REGS_COUNT),
+					_synth_range(self, 1024),
+					segment + 1
+				);
+			}
+
+			auto ins_count = config.ins_per_proc / segments_count;
+			if (segment == 0)
+				ins_count += config.ins_per_proc % segments_count;
+			for (size_t i = 0; i < ins_count; ++i)
+				_synth_ins(self);
+
+			if (is_loop)
+			{
+				self.out = mn::strf(self.out, "\ti64.sub r7 1\n");
+				self.out = mn::strf(self.out, "\ti64.jg r7 0 l{}\n", segment);
+			}
+
+			for (size_t i = 0; i < calls[segment]; ++i)
+			{
+				mn::str_push(self.out, "\tcall ");
+				_synth_proc_name(self, *next_child++);
+				mn::str_push(self.out, "\n");
+			}
+		}
+
+		// the random instructions can clear r0 so each proc folds another register into it
+		self.out = mn::strf(self.out, "\tu64.mul r0 31\n");
+		self.out = mn::strf(self.out, "\tu64.add r0 r{}\n", _synth_range(self, SYNTH_REGS_COUNT - 1) + 1);
+		mn::str_push(self.out, "\tleave\n");
+		mn::str_push(self.out, index == 0 ? "\thalt\n" : "\tret\n");
+		mn::str_push(self.out, "end\n");
+	}
+
+	// API
+	Synth_Config
+	synth_config_default()
+	{
+		Synth_Config self{};
+		self.seed = 0x9E3779B97F4A7C15ULL;
+		self.procs = 100;
+		self.ins_per_proc = 32;
+		self.labels_per_proc = 4;
+		self.loop_count = 3;
+		self.constants = 8;
+		self.c_procs = 2;
+		self.shape = SYNTH_SHAPE_RANDOM;
+		self.fanout = 2;
+		return self;
+	}
+
+	mn::Str
+	synth_generate(const Synth_Config& config, mn::Allocator allocator)
+	{
+		auto procs_count = config.procs ? config.procs : 1;
+
+		Synth self{};
+		self.state = config.seed ? config.seed : 1;
+		self.out = mn::str_with_allocator(allocator);
+
+		auto clamped = config;
+		if (clamped.c_procs > SYNTH_C_PROCS_COUNT)
+			clamped.c_procs = SYNTH_C_PROCS_COUNT;
+		if (clamped.loop_count == 0)
+			clamped.loop_count = 1;
+		self.config = &clamped;
+
+		// the children of each proc are sorted by their parent and each proc's children start at its
+		// first index
+		auto parents = mn::buf_new<size_t>();
+		mn_defer(mn::buf_free(parents));
+		mn::buf_resize_fill(parents, procs_count, size_t(0));
+		for (size_t i = 1; i < procs_count; ++i)
+		{
+			switch (clamped.shape)
+			{
+			case SYNTH_SHAPE_CHAIN:
+				parents[i] = i - 1;
+				break;
+			case SYNTH_SHAPE_TREE:
+				parents[i] = (i - 1) / (clamped.fanout ? clamped.fanout : 1);
+				break;
+			case SYNTH_SHAPE_RANDOM:
+				parents[i] = _synth_range(self, i);
+				break;
+			default:
+				assert(false && "unreachable");
+				break;
+			}
+		}
+
+		auto first = mn::buf_new<size_t>();
+		mn_defer(mn::buf_free(first));
+		mn::buf_resize_fill(first, procs_count + 1, size_t(0));
+		for (size_t i = 1; i < procs_count; ++i)
+			++first[parents[i] + 1];
+		for (size_t i = 0; i < procs_count; ++i)
+			first[i + 1] += first[i];
+
+		auto children = mn::buf_new<size_t>();
+		mn_defer(mn::buf_free(children));
+		mn::buf_resize_fill(children, procs_count, size_t(0));
+		auto fill = mn::buf_new<size_t>();
+		mn_defer(mn::buf_free(fill));
+		mn::buf_concat(fill, first);
+		for (size_t i = 1; i < procs_count; ++i)
+			children[fill[parents[i]]++] = i;
+
+		self.out = mn::strf(
+			self.out,
+			"; generated program, seed: {}, procs: {}, ins per proc: {}, labels per proc: {}, shape: {}\n",
+			config.seed,
+			procs_count,
+			clamped.ins_per_proc,
+			clamped.labels_per_proc,
+			synth_shape_name(clamped.shape)
+		);
+
+		for (size_t i = 0; i < clamped.constants; ++i)
+			self.out = mn::strf(self.out, "constant c{} \"synth constant {}\"\n", i, i);
+
+		for (size_t i = 0; i < clamped.c_procs; ++i)
+		{
+			const auto& c_proc = SYNTH_C_PROCS[i];
+			self.out = mn::strf(self.out, "proc C.{}({}) {}\n", c_proc.name, c_proc.type, c_proc.type);
+		}
+
+		for (size_t i = 0; i < procs_count; ++i)
+			_synth_proc(self, i, children.ptr + first[i], first[i + 1] - first[i]);
+
+		return self.out;
+	}
+
+	size_t
+	synth_procs_for_size(const Synth_Config& config, size_t size_in_bytes)
+	{
+		constexpr size_t SAMPLE_PROCS = 64;
+		auto sample_config = config;
+		sample_config.procs = SAMPLE_PROCS;
+		auto sample = synth_generate(sample_config, mn::memory::tmp());
+		auto proc_size = sample.count / SAMPLE_PROCS;
+		return size_in_bytes / (proc_size ? proc_size : 1) + 1;
+	}
+
+	const char*
+	synth_shape_name(SYNTH_SHAPE shape)
+	{
+		switch (shape)
+		{
+		case SYNTH_SHAPE_CHAIN: return "chain";
+		case SYNTH_SHAPE_TREE: return "tree";
+		case SYNTH_SHAPE_RANDOM: return "random";
+		default: assert(false && "unreachable"); return "<UNKNOWN>";
+		}
+	}
+
+	bool
+	synth_shape_from_name(const char* name, SYNTH_SHAPE& shape)
+	{
+		if (::strcmp(name, "chain") == 0)
+			shape = SYNTH_SHAPE_CHAIN;
+		else if (::strcmp(name, "tree") == 0)
+			shape = SYNTH_SHAPE_TREE;
+		else if (::strcmp(name, "random") == 0)
+			shape = SYNTH_SHAPE_RANDOM;
+		else
+			return false;
+		return true;
+	}
+}
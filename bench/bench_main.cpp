@@ -0,0 +1,616 @@
+#include <mn/IO.h>
+#include <mn/Str.h>
+#include <mn/Buf.h>
+#include <mn/File.h>
+#include <mn/Path.h>
+#include <mn/Defer.h>
+
+#include <as/Src.h>
+#include <as/Scan.h>
+#include <as/Parse.h>
+#include <as/Gen.h>
+#include <as/Synth.h>
+
+#include <vm/Pkg.h>
+#include <vm/Core.h>
+#include <vm/Verify.h>
+
+#include <chrono>
+#include <algorithm>
+#include <initializer_list>
+
+const char* HELP_MSG = R"MSG(tethys_bench tethys benchmarks
+tethys_bench [size in MB] [iterations] [flags]
+  runs the benchmarks and prints the best and median time of the given number of iterations, each
+  benchmark has an extra warm up run which isn't counted, the assembler and package benchmarks run
+  over generated inputs of the given size and the inputs are the same in every run
+  'tethys_bench 32 5'
+FLAGS:
+  --json: writes the results to the given file as json so runs can be compared
+    'tethys_bench 32 5 --json results.json'
+  --filter: only runs the benchmarks which have the given string in their name
+    'tethys_bench 32 5 --filter vm.'
+)MSG";
+
+// loop iterations of the vm benchmarks, they don't depend on the input size
+constexpr static uint64_t VM_LOOPS = 4000000;
+constexpr static uint64_t VM_C_CALLS = 1000000;
+constexpr static size_t VM_PROGRAM_PROCS = 20000;
+// file used by the package benchmarks, it's removed afterwards
+constexpr static const char* BENCH_PKG_FILE = "tethys_bench.zyc";
+
+struct Bench_Result
+{
+	mn::Str name;
+	// what the items are, like bytes or instructions
+	const char* unit;
+	uint64_t items;
+	size_t runs;
+	double best;
+	double median;
+};
+
+inline static void
+destruct(Bench_Result& self)
+{
+	mn::str_free(self.name);
+}
+
+struct Bench
+{
+	size_t iterations;
+	const char* filter;
+	mn::Buf<Bench_Result> results;
+};
+
+inline static double
+time_now_in_seconds()
+{
+	auto now = std::chrono::high_resolution_clock::now().time_since_epoch();
+	return std::chrono::duration<double>(now).count();
+}
+
+inline static bool
+bench_enabled(const Bench& self, const char* name)
+{
+	return self.filter == nullptr || ::strstr(name, self.filter) != nullptr;
+}
+
+// used to skip the setup shared by a group of benchmarks when all of them are filtered out
+inline static bool
+bench_any_enabled(const Bench& self, std::initializer_list<const char*> names)
+{
+	for(auto name: names)
+		if(bench_enabled(self, name))
+			return true;
+	return false;
+}
+
+// runs the benchmark the given number of iterations after a warm up run, each run returns the seconds
+// it measured or a negative value if it failed and sets the number of items it processed
+template<typename TRun>
+inline static void
+bench_run(Bench& self, const char* name, const char* unit, TRun&& run)
+{
+	if (bench_enabled(self, name) == false)
+		return;
+
+	auto times = mn::buf_new<double>();
+	mn_defer(mn::buf_free(times));
+
+	uint64_t items = 0;
+	for(size_t i = 0; i < self.iterations + 1; ++i)
+	{
+		auto elapsed = run(items);
+		if(elapsed < 0)
+		{
+			mn::printerr("{}: failed\n", name);
+			return;
+		}
+		if(i > 0)
+			mn::buf_push(times, elapsed);
+	}
+	std::sort(times.ptr, times.ptr + times.count);
+
+	Bench_Result result{};
+	result.name = mn::str_from_c(name);
+	result.unit = unit;
+	result.items = items;
+	result.runs = times.count;
+	result.best = times[0];
+	result.median = times[times.count / 2];
+	mn::buf_push(self.results, result);
+
+	mn::print(
+		"{}: {:.2f} M{}/s, {} {}, best {:.3f}ms, median {:.3f}ms of {} runs\n",
+		result.name,
+		double(result.items) / 1000000.0 / result.best,
+		result.unit,
+		result.items,
+		result.unit,
+		result.best * 1000,
+		result.median * 1000,
+		result.runs
+	);
+}
+
+inline static void
+bench_json_save(const Bench& self, size_t size_in_mb, const char* filename)
+{
+	auto out = mn::str_new();
+	mn_defer(mn::str_free(out));
+
+	out = mn::strf(out, "{{\n");
+	out = mn::strf(out, "\t\"size_mb\": {},\n", size_in_mb);
+	out = mn::strf(out, "\t\"iterations\": {},\n", self.iterations);
+	out = mn::strf(out, "\t\"results\": [\n");
+	for(size_t i = 0; i < self.results.count; ++i)
+	{
+		const auto& result = self.results[i];
+		out = mn::strf(
+			out,
+			"\t\t{{\"name\": \"{}\", \"unit\": \"{}\", \"items\": {}, \"runs\": {}, \"best_s\": {:.9f}, \"median_s\": {:.9f}, \"items_per_s\": {:.1f}}}{}\n",
+			result.name,
+			result.unit,
+			result.items,
+			result.runs,
+			result.best,
+			result.median,
+			double(result.items) / result.best,
+			i + 1 < self.results.count ? "," : ""
+		);
+	}
+	out = mn::strf(out, "\t]\n}}\n");
+
+	auto f = mn::file_open(filename, mn::IO_MODE::WRITE, mn::OPEN_MODE::CREATE_OVERWRITE);
+	if(f == nullptr)
+	{
+		mn::printerr("failed to write the results to '{}'\n", filename);
+		return;
+	}
+	mn::stream_write(f, mn::block_from(out));
+	mn::file_close(f);
+}
+
+// generated program of about the given size, the default config has a fixed seed so it's the same each time
+inline static mn::Str
+src_generate(size_t size_in_bytes)
+{
+	auto config = as::synth_config_default();
+	config.procs = as::synth_procs_for_size(config, size_in_bytes);
+	return as::synth_generate(config);
+}
+
+inline static void
+bench_scan(Bench& bench, const mn::Str& content)
+{
+	bench_run(bench, "as.scan", "bytes", [&](uint64_t& items) {
+		auto src = as::src_from_str(content.ptr);
+		mn_defer(as::src_free(src));
+
+		auto start = time_now_in_seconds();
+		bool ok = as::scan(src);
+		auto elapsed = time_now_in_seconds() - start;
+		if(ok == false)
+		{
+			mn::printerr("{}", as::src_errs_dump(src, mn::memory::tmp()));
+			return -1.0;
+		}
+
+		items = content.count;
+		return elapsed;
+	});
+}
+
+inline static void
+bench_parse(Bench& bench, const mn::Str& content)
+{
+	bench_run(bench, "as.parse", "bytes", [&](uint64_t& items) {
+		auto src = as::src_from_str(content.ptr);
+		mn_defer(as::src_free(src));
+
+		if(as::scan(src) == false)
+		{
+			mn::printerr("{}", as::src_errs_dump(src, mn::memory::tmp()));
+			return -1.0;
+		}
+
+		auto start = time_now_in_seconds();
+		bool ok = as::parse(src);
+		auto elapsed = time_now_in_seconds() - start;
+		if(ok == false)
+		{
+			mn::printerr("{}", as::src_errs_dump(src, mn::memory::tmp()));
+			return -1.0;
+		}
+
+		items = content.count;
+		return elapsed;
+	});
+}
+
+inline static void
+bench_gen(Bench& bench, const char* name, const mn::Str& content, size_t workers)
+{
+	if(bench_enabled(bench, name) == false)
+		return;
+
+	auto src = as::src_from_str(content.ptr);
+	mn_defer(as::src_free(src));
+
+	if(as::scan(src) == false || as::parse(src) == false)
+	{
+		mn::printerr("{}", as::src_errs_dump(src, mn::memory::tmp()));
+		return;
+	}
+
+	bench_run(bench, name, "bytes", [&](uint64_t& items) {
+		auto start = time_now_in_seconds();
+		auto pkg = as::src_gen(src, workers);
+		auto elapsed = time_now_in_seconds() - start;
+		mn_defer(vm::pkg_free(pkg));
+
+		items = content.count;
+		return elapsed;
+	});
+}
+
+inline static vm::Pkg
+pkg_from_src(const mn::Str& code, bool& ok)
+{
+	auto src = as::src_from_str(code.ptr);
+	mn_defer(as::src_free(src));
+
+	ok = as::scan(src) && as::parse(src);
+	if(ok == false)
+	{
+		mn::printerr("{}", as::src_errs_dump(src, mn::memory::tmp()));
+		return vm::pkg_new();
+	}
+
+	auto pkg = as::src_gen(src, 1);
+	ok = as::src_has_err(src) == false;
+	if(ok == false)
+		mn::printerr("{}", as::src_errs_dump(src, mn::memory::tmp()));
+	return pkg;
+}
+
+// runs the program to the end on a fresh core each run, loading and verification aren't measured
+inline static void
+bench_vm(Bench& bench, const char* name, const mn::Str& code, const char* unit, uint64_t items_count)
+{
+	if(bench_enabled(bench, name) == false)
+		return;
+
+	bool ok = false;
+	auto pkg = pkg_from_src(code, ok);
+	mn_defer(vm::pkg_free(pkg));
+	if(ok == false)
+		return;
+
+	bench_run(bench, name, unit, [&](uint64_t& items) {
+		auto cpu = vm::core_new();
+		mn_defer(vm::core_free(cpu));
+		if(auto err = vm::pkg_core_load(pkg, cpu))
+		{
+			mn::printerr("[Error]: {}\n", err);
+			return -1.0;
+		}
+		if(cpu.verified == false)
+			mn::printerr("[Warning]: '{}' didn't pass verification, running in the checked mode\n", name);
+
+		auto start = time_now_in_seconds();
+		vm::core_run(cpu);
+		auto elapsed = time_now_in_seconds() - start;
+		if(cpu.state != vm::Core::STATE_HALT)
+			return -1.0;
+
+		items = items_count;
+		return elapsed;
+	});
+}
+
+// tight loop which does nothing but count down so it's bound by the instruction dispatch
+inline static void
+bench_vm_dispatch(Bench& bench)
+{
+	auto code = mn::strf(R"""(
+	proc main
+		i64.mov r0 {}
+	loop:
+		i64.sub r0 1
+		i64.cmp r0 0
+		jne loop
+		halt
+	end
+	)""", VM_LOOPS);
+	mn_defer(mn::str_free(code));
+	bench_vm(bench, "vm.dispatch", code, "instructions", VM_LOOPS * 3);
+}
+
+// the values stay the same each iteration so the floats never overflow
+inline static void
+bench_vm_arithmetic(Bench& bench, const char* type)
+{
+	bool is_float = type[0] == 'f';
+	auto code = mn::strf(R"""(
+	proc main
+		i64.mov r7 {}
+		{}.mov r0 {}
+		{}.mov r1 {}
+	loop:
+		{}.add r0 r1
+		{}.mul r0 r1
+		{}.sub r0 r1
+		{}.add r2 r0
+		i64.sub r7 1
+		i64.cmp r7 0
+		jne loop
+		halt
+	end
+	)""",
+		VM_LOOPS,
+		type, is_float ? "2.0" : "2",
+		type, is_float ? "1.0" : "1",
+		type, type, type, type
+	);
+	mn_defer(mn::str_free(code));
+	auto name = mn::strf("vm.arithmetic.{}", type);
+	mn_defer(mn::str_free(name));
+	bench_vm(bench, name.ptr, code, "instructions", VM_LOOPS * 7);
+}
+
+// loads and stores through the frame pointer with a displacement and through a plain register
+inline static void
+bench_vm_memory(Bench& bench)
+{
+	auto code = mn::strf(R"""(
+	proc main
+		enter 32
+		i64.mov r7 {}
+		u64.mov r4 sp
+	loop:
+		i64.mov [fp - 8] r7
+		i64.mov r1 [fp - 8]
+		i32.mov [fp - 16] r1
+		i32.mov r2 [fp - 16]
+		i64.mov [r4] r2
+		i64.mov r3 [r4]
+		i64.sub r7 1
+		i64.cmp r7 0
+		jne loop
+		leave
+		halt
+	end
+	)""", VM_LOOPS);
+	mn_defer(mn::str_free(code));
+	bench_vm(bench, "vm.memory", code, "instructions", VM_LOOPS * 9);
+}
+
+// recursion to the given depth repeated until about VM_LOOPS calls are made
+inline static void
+bench_vm_calls(Bench& bench, uint64_t depth)
+{
+	auto repeats = VM_LOOPS / (depth + 1);
+	auto code = mn::strf(R"""(
+	proc rec
+		i64.je r0 0 done
+		i64.sub r0 1
+		call rec
+	done:
+		ret
+	end
+
+	proc main
+		i64.mov r7 {}
+	loop:
+		i64.mov r0 {}
+		call rec
+		i64.sub r7 1
+		i64.cmp r7 0
+		jne loop
+		halt
+	end
+	)""", repeats, depth);
+	mn_defer(mn::str_free(code));
+	auto name = mn::strf("vm.calls.depth_{}", depth);
+	mn_defer(mn::str_free(name));
+	bench_vm(bench, name.ptr, code, "calls", repeats * (depth + 1));
+}
+
+// calls into libc through libffi, the pushed register is the return value and argument slot
+inline static void
+bench_vm_c_calls(Bench& bench)
+{
+	auto code = mn::strf(R"""(
+	proc C.abs(C.int32) C.int32
+
+	proc main
+		i64.mov r7 {}
+		push r0
+	loop:
+		call C.abs
+		i64.sub r7 1
+		i64.cmp r7 0
+		jne loop
+		pop r0
+		halt
+	end
+	)""", VM_C_CALLS);
+	mn_defer(mn::str_free(code));
+	bench_vm(bench, "vm.c_calls", code, "calls", VM_C_CALLS);
+}
+
+// a generated program with loops, frames, constants and c calls which is closer to what a compiler emits
+// than the single loop benchmarks
+inline static void
+bench_vm_program(Bench& bench)
+{
+	auto config = as::synth_config_default();
+	config.procs = VM_PROGRAM_PROCS;
+	auto code = as::synth_generate(config);
+	mn_defer(mn::str_free(code));
+	bench_vm(bench, "vm.program", code, "procs", VM_PROGRAM_PROCS);
+}
+
+inline static uint64_t
+xorshift64(uint64_t& state)
+{
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+// synthetic package of about the given size, procs of random bytes with a few relocations each to other
+// procs so loading it into a core has relocations to patch, the seed is fixed so it's the same each time
+inline static vm::Pkg
+pkg_generate(size_t size_in_bytes)
+{
+	constexpr size_t PROC_SIZE = 256;
+	constexpr size_t PROC_RELOCS = 4;
+	uint64_t seed = 0x9E3779B97F4A7C15ULL;
+
+	auto procs_count = std::max(size_in_bytes / PROC_SIZE, size_t(1));
+	auto names = mn::buf_with_capacity<mn::Str>(procs_count);
+	mn_defer(destruct(names));
+	for(size_t i = 0; i < procs_count; ++i)
+		mn::buf_push(names, i == 0 ? mn::str_from_c("main") : mn::strf("proc_{}", i));
+
+	auto pkg = vm::pkg_new();
+	auto bytes = mn::buf_new<uint8_t>();
+	mn_defer(mn::buf_free(bytes));
+	mn::buf_resize(bytes, PROC_SIZE);
+	for(size_t i = 0; i < procs_count; ++i)
+	{
+		for(auto& b: bytes)
+			b = uint8_t(xorshift64(seed));
+		vm::pkg_proc_add(pkg, names[i], mn::block_from(bytes));
+		for(size_t j = 0; j < PROC_RELOCS; ++j)
+			vm::pkg_reloc_add(pkg, names[i], j * (PROC_SIZE / PROC_RELOCS), names[xorshift64(seed) % procs_count], sizeof(uint32_t));
+	}
+	return pkg;
+}
+
+inline static void
+bench_pkg(Bench& bench, size_t size_in_bytes)
+{
+	if(bench_any_enabled(bench, {"pkg.save", "pkg.load", "pkg.core_load"}) == false)
+		return;
+
+	auto pkg = pkg_generate(size_in_bytes);
+	mn_defer(vm::pkg_free(pkg));
+	mn_defer(mn::file_remove(BENCH_PKG_FILE));
+
+	uint64_t bytecode_size = 0;
+	for(const auto& [_, section]: pkg.sections)
+		bytecode_size += section.bytes.size;
+
+	bench_run(bench, "pkg.save", "bytes", [&](uint64_t& items) {
+		auto start = time_now_in_seconds();
+		vm::pkg_save(pkg, BENCH_PKG_FILE);
+		auto elapsed = time_now_in_seconds() - start;
+		items = bytecode_size;
+		return elapsed;
+	});
+
+	// the file is needed by the load benchmark even when the save one is filtered out
+	if(mn::path_is_file(BENCH_PKG_FILE) == false)
+		vm::pkg_save(pkg, BENCH_PKG_FILE);
+
+	bench_run(bench, "pkg.load", "bytes", [&](uint64_t& items) {
+		auto start = time_now_in_seconds();
+		auto loaded = vm::pkg_load(BENCH_PKG_FILE);
+		auto elapsed = time_now_in_seconds() - start;
+		if(loaded.err)
+			mn::printerr("[Error]: {}\n", loaded.err);
+		vm::pkg_free(loaded.val);
+		items = bytecode_size;
+		return elapsed;
+	});
+
+	bench_run(bench, "pkg.core_load", "bytes", [&](uint64_t& items) {
+		auto cpu = vm::core_new();
+		mn_defer(vm::core_free(cpu));
+
+		auto start = time_now_in_seconds();
+		auto err = vm::pkg_core_load(pkg, cpu, 64 * 1024);
+		auto elapsed = time_now_in_seconds() - start;
+		if(err)
+		{
+			mn::printerr("[Error]: {}\n", err);
+			return -1.0;
+		}
+		items = bytecode_size;
+		return elapsed;
+	});
+}
+
+int
+main(int argc, char** argv)
+{
+	size_t size_in_mb = 32;
+	size_t iterations = 5;
+	const char* json_filename = nullptr;
+	const char* filter = nullptr;
+
+	size_t positional = 0;
+	for(int i = 1; i < argc; ++i)
+	{
+		if(::strcmp(argv[i], "help") == 0)
+		{
+			mn::print("{}\n", HELP_MSG);
+			return 0;
+		}
+		else if(::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+		{
+			json_filename = argv[++i];
+		}
+		else if(::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+		{
+			filter = argv[++i];
+		}
+		else if(positional == 0)
+		{
+			mn::reads(argv[i], size_in_mb);
+			++positional;
+		}
+		else if(positional == 1)
+		{
+			mn::reads(argv[i], iterations);
+			++positional;
+		}
+	}
+
+	Bench bench{};
+	bench.iterations = std::max(iterations, size_t(1));
+	bench.filter = filter;
+	bench.results = mn::buf_new<Bench_Result>();
+	mn_defer(destruct(bench.results));
+
+	if(bench_any_enabled(bench, {"as.scan", "as.parse", "as.gen.serial", "as.gen.parallel"}))
+	{
+		auto content = src_generate(size_in_mb * 1024 * 1024);
+		mn_defer(mn::str_free(content));
+
+		bench_scan(bench, content);
+		bench_parse(bench, content);
+		bench_gen(bench, "as.gen.serial", content, 1);
+		bench_gen(bench, "as.gen.parallel", content, 0);
+	}
+
+	bench_vm_dispatch(bench);
+	for(auto type: {"i8", "i16", "i32", "i64", "f32", "f64"})
+		bench_vm_arithmetic(bench, type);
+	bench_vm_memory(bench);
+	bench_vm_calls(bench, 8);
+	bench_vm_calls(bench, 1024);
+	bench_vm_c_calls(bench);
+	bench_vm_program(bench);
+
+	bench_pkg(bench, size_in_mb * 1024 * 1024);
+
+	if(json_filename)
+		bench_json_save(bench, size_in_mb, json_filename);
+	return 0;
+}
@@ -2,30 +2,62 @@
 #include <mn/Buf.h>
 #include <mn/Defer.h>
 #include <mn/Path.h>
+#include <mn/File.h>
 
 #include <as/Src.h>
 #include <as/Scan.h>
 #include <as/Parse.h>
 #include <as/Gen.h>
+#include <as/Cache.h>
+#include <as/Opt.h>
 
 #include <vm/Core.h>
+#include <vm/Verify.h>
+#include <vm/Op.h>
+#include <vm/Sample.h>
+
+#include <chrono>
+#include <algorithm>
 
 const char* HELP_MSG = R"MSG(tas tethys assembler
 tas [command] [targets] [flags]
 COMMANDS:
   help: prints this message
     'tas help'
-  scan: scans the file
-    'tas scan path/to/file.zy'
-  parse: parses the file
-    'tas parse path/to/file.zy'
-  build: builds the file
-    'tas build -o pkg_name.zyc path/to/file.zy'
+  scan: scans the files, the tokens of each file follow its path if there's more than one
+    'tas scan path/to/file.zy path/to/other.zy'
+  parse: parses the files, the declarations of each file follow its path if there's more than one
+    'tas parse path/to/file.zy path/to/other.zy'
+  build: builds the files into a single package
+    'tas build -o pkg_name.zyc path/to/file.zy path/to/other.zy'
   run: loads and runs the specified package
     'tas run path/to/pkg_name.zyc'
 FLAGS:
   -o: specifies output file
     'tas build -o pkg.zyc path/to/file.zy'
+  --stream: reads the file a chunk at a time and builds each declaration as soon as it's parsed
+    and writes it to the package directly, the memory grows with the globals, constants and calls
+    but not with the size of the code, only a single file is supported
+    'tas build --stream -o pkg.zyc path/to/file.zy'
+  -O: optimizes the procs before generating them, it runs the peephole optimizer then jump
+    threading and dead block elimination over the control flow graph, -O2 also inlines small
+    leaf procs at their call sites
+    'tas build -O -o pkg.zyc path/to/file.zy'
+  --cache: reuses the bytecode of unchanged procs from the previous build, the cache is kept
+    next to the package in 'pkg_name.zyc.cache'
+    'tas build --cache -o pkg.zyc path/to/file.zy'
+  --stats: prints the build time of each stage, the cache hit rate and the stack size of the
+    package
+    'tas build --cache --stats -o pkg.zyc path/to/file.zy'
+  -g: adds the source line of each instruction and the labels of each proc to the package, the
+    profile report and runtime errors show them
+    'tas build -g -o pkg.zyc path/to/file.zy'
+  --profile: prints the executed instructions count of each opcode, proc and bytecode offset and
+    the time spent in c procs after the run, it needs tas built with the VM_PROFILE option
+    'tas run --profile pkg.zyc'
+  --sample-hz: samples the running procs stacks the given number of times per second and writes
+    them in the folded format of the flamegraph tools to 'pkg_name.zyc.folded'
+    'tas run --sample-hz 1000 pkg.zyc'
 )MSG";
 
 inline static void
@@ -40,6 +72,8 @@ struct Args
 	mn::Buf<mn::Str> targets;
 	mn::Buf<mn::Str> flags;
 	mn::Str out_name;
+	// samples per second of the sampling profiler, 0 when it's off
+	uint64_t sample_hz;
 };
 
 inline static bool
@@ -65,6 +99,22 @@ args_parse(Args& self, int argc, char** argv)
 			self.out_name = mn::str_from_c(argv[i + 1]);
 			++i;
 		}
+		else if(::strcmp(argv[i], "--sample-hz") == 0)
+		{
+			if(i + 1 >= size_t(argc))
+			{
+				mn::printerr("you need to specify the sampling frequency\n");
+				return false;
+			}
+
+			self.sample_hz = ::strtoull(argv[i + 1], nullptr, 10);
+			if(self.sample_hz == 0)
+			{
+				mn::printerr("invalid sampling frequency '{}'\n", argv[i + 1]);
+				return false;
+			}
+			++i;
+		}
 		else if (mn::str_prefix(argv[i], "--"))
 		{
 			buf_push(self.flags, mn::str_from_c(argv[i] + 2));
@@ -110,6 +160,147 @@ args_has_flag(Args& self, const char* search)
 	return false;
 }
 
+inline static double
+time_now_in_seconds()
+{
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration<double>(now).count();
+}
+
+// readable location of the bytecode offset, it names the proc or the closest label before the offset
+// and adds the source position when the package has debug info
+inline static mn::Str
+code_location(const vm::Core& cpu, uint64_t offset)
+{
+	auto res = mn::str_new();
+	auto proc = vm::core_proc_at(cpu, offset);
+	if(proc == cpu.procs.count)
+		return mn::strf(res, "{}", offset);
+
+	if(auto label = vm::core_label_at(cpu, offset))
+		res = mn::strf(res, "{}:{}+{}", cpu.procs_name[proc], label->name, offset - label->offset);
+	else
+		res = mn::strf(res, "{}+{}", cpu.procs_name[proc], offset - cpu.procs[proc]);
+
+	vm::Source_Location location{};
+	if(vm::core_location_at(cpu, offset, location))
+		res = mn::strf(res, " {}:{}:{}", location.file, location.line, location.col);
+	return res;
+}
+
+#if VM_PROFILE
+// number of entries printed in each section of the profile report
+constexpr static size_t PROFILE_REPORT_TOP = 20;
+
+// indices of the non zero counts sorted from the biggest count to the smallest
+template<typename TCount>
+inline static mn::Buf<size_t>
+profile_sorted(size_t count, TCount&& count_of)
+{
+	auto indices = mn::buf_new<size_t>();
+	for(size_t i = 0; i < count; ++i)
+		if(count_of(i) > 0)
+			mn::buf_push(indices, i);
+	std::stable_sort(indices.ptr, indices.ptr + indices.count, [&](size_t a, size_t b) {
+		return count_of(a) > count_of(b);
+	});
+	return indices;
+}
+
+inline static double
+profile_percent(uint64_t count, uint64_t total)
+{
+	return total ? count * 100.0 / total : 0.0;
+}
+
+inline static void
+profile_report(const vm::Core& cpu)
+{
+	const auto& profile = cpu.profile;
+	uint64_t total = 0;
+	for(auto count: profile.ops)
+		total += count;
+	mn::print("\nPROFILE: {} instructions executed\n", total);
+
+	auto ops = profile_sorted(256, [&](size_t i) { return profile.ops[i]; });
+	mn_defer(mn::buf_free(ops));
+	mn::print("\nopcodes:\n");
+	for(size_t i = 0; i < ops.count && i < PROFILE_REPORT_TOP; ++i)
+	{
+		auto count = profile.ops[ops[i]];
+		mn::print("  {:>12} {:>6.2f}%  {}\n", count, profile_percent(count, total), vm::op_name(vm::Op(ops[i])));
+	}
+
+	// the instructions executed inside each proc and the calls which landed at its start
+	auto procs_ins = mn::buf_new<uint64_t>();
+	mn_defer(mn::buf_free(procs_ins));
+	mn::buf_resize_fill(procs_ins, cpu.procs.count, uint64_t(0));
+	auto procs_calls = mn::buf_new<uint64_t>();
+	mn_defer(mn::buf_free(procs_calls));
+	mn::buf_resize_fill(procs_calls, cpu.procs.count, uint64_t(0));
+	for(size_t offset = 0; offset < profile.ins.count; ++offset)
+	{
+		if(profile.ins[offset] == 0 && profile.calls[offset] == 0)
+			continue;
+		auto proc = vm::core_proc_at(cpu, offset);
+		if(proc == cpu.procs.count)
+			continue;
+		procs_ins[proc] += profile.ins[offset];
+		procs_calls[proc] += profile.calls[offset];
+	}
+
+	auto procs = profile_sorted(cpu.procs.count, [&](size_t i) { return procs_ins[i]; });
+	mn_defer(mn::buf_free(procs));
+	mn::print("\nprocs:\n");
+	for(size_t i = 0; i < procs.count && i < PROFILE_REPORT_TOP; ++i)
+	{
+		auto proc = procs[i];
+		mn::print(
+			"  {:>12} {:>6.2f}%  {} ({} calls)\n",
+			procs_ins[proc],
+			profile_percent(procs_ins[proc], total),
+			cpu.procs_name[proc],
+			procs_calls[proc]
+		);
+	}
+
+	auto hot = profile_sorted(profile.ins.count, [&](size_t i) { return profile.ins[i]; });
+	mn_defer(mn::buf_free(hot));
+	mn::print("\nhot instructions:\n");
+	for(size_t i = 0; i < hot.count && i < PROFILE_REPORT_TOP; ++i)
+	{
+		auto offset = hot[i];
+		auto location = code_location(cpu, offset);
+		mn_defer(mn::str_free(location));
+		mn::print(
+			"  {:>12} {:>6.2f}%  {} {}\n",
+			profile.ins[offset],
+			profile_percent(profile.ins[offset], total),
+			vm::op_name(vm::Op(cpu.bytecode[offset])),
+			location
+		);
+	}
+
+	auto c_procs = profile_sorted(profile.c_time.count, [&](size_t i) { return profile.c_time[i]; });
+	mn_defer(mn::buf_free(c_procs));
+	if(c_procs.count > 0)
+	{
+		mn::print("\nc procs:\n");
+		for(auto ix: c_procs)
+		{
+			const auto& c_proc = cpu.c_procs_desc[ix];
+			mn::print(
+				"  {:>12.3f}ms  {}.{} ({} calls)\n",
+				profile.c_time[ix] / 1000000.0,
+				c_proc.lib,
+				c_proc.name,
+				profile.c_calls[ix]
+			);
+		}
+	}
+}
+#endif
+
 int
 main(int argc, char** argv)
 {
@@ -127,112 +318,162 @@ main(int argc, char** argv)
 		print_help();
 		return 0;
 	}
-	else if(args.command == "scan")
+	else if(args.command == "scan" || args.command == "parse")
 	{
 		if(args.targets.count == 0)
 		{
 			mn::printerr("no input files\n");
 			return -1;
 		}
-		else if(args.targets.count > 1)
+
+		for(const auto& target: args.targets)
 		{
-			mn::printerr("multiple input files are not supported yet\n");
-			return -1;
+			if(mn::path_is_file(target) == false)
+			{
+				mn::printerr("'{}' is not a file \n", target);
+				return -1;
+			}
 		}
 
-		if(mn::path_is_file(args.targets[0]) == false)
+		// every file is dumped even if an earlier one has errors, the same as build reports them
+		int res = 0;
+		for(const auto& target: args.targets)
 		{
-			mn::printerr("'{}' is not a file \n", args.targets[0]);
-			return -1;
-		}
+			auto src = as::src_from_file(target.ptr);
+			mn_defer(as::src_free(src));
 
-		auto src = as::src_from_file(args.targets[0].ptr);
-		mn_defer(as::src_free(src));
+			if(as::scan(src) == false || (args.command == "parse" && as::parse(src) == false))
+			{
+				mn::printerr("{}", as::src_errs_dump(src, mn::memory::tmp()));
+				res = -1;
+				continue;
+			}
 
-		if(as::scan(src) == false)
-		{
-			mn::printerr("{}", as::src_errs_dump(src, mn::memory::tmp()));
-			return -1;
+			if(args.targets.count > 1)
+				mn::print("{}:\n", target);
+			if(args.command == "scan")
+				mn::print("{}", as::src_tkns_dump(src, mn::memory::tmp()));
+			else
+				mn::print("{}", as::decl_dump(src, mn::memory::tmp()));
 		}
-
-		mn::print("{}", as::src_tkns_dump(src, mn::memory::tmp()));
-		return 0;
+		return res;
 	}
-	else if(args.command == "parse")
+	else if(args.command == "build")
 	{
 		if(args.targets.count == 0)
 		{
 			mn::printerr("no input files\n");
 			return -1;
 		}
-		else if(args.targets.count > 1)
+
+		auto srcs = mn::buf_new<as::Src*>();
+		mn_defer(destruct(srcs));
+
+		bool stream = args_has_flag(args, "stream");
+		for(const auto& target: args.targets)
 		{
-			mn::printerr("multiple input files are not supported yet\n");
-			return -1;
+			if(mn::path_is_file(target) == false)
+			{
+				mn::printerr("'{}' is not a file \n", target);
+				return -1;
+			}
+			mn::buf_push(srcs, stream ? as::src_stream_from_file(target.ptr) : as::src_from_file(target.ptr));
 		}
 
-		if(mn::path_is_file(args.targets[0]) == false)
+		if(stream)
 		{
-			mn::printerr("'{}' is not a file \n", args.targets[0]);
-			return -1;
-		}
+			if(srcs.count > 1)
+			{
+				mn::printerr("streaming build doesn't support multiple input files\n");
+				return -1;
+			}
 
-		auto src = as::src_from_file(args.targets[0].ptr);
-		mn_defer(as::src_free(src));
+			if(args_has_flag(args, "O") || args_has_flag(args, "O1") || args_has_flag(args, "O2"))
+			{
+				mn::printerr("streaming build doesn't support optimizations\n");
+				return -1;
+			}
 
-		if(as::scan(src) == false)
-		{
-			mn::printerr("{}", as::src_errs_dump(src, mn::memory::tmp()));
-			return -1;
-		}
+			auto writer = vm::pkg_writer_new(args.out_name);
+			mn_defer(vm::pkg_writer_free(writer));
 
-		if(as::parse(src) == false)
-		{
-			mn::printerr("{}", as::src_errs_dump(src, mn::memory::tmp()));
-			return -1;
+			if(as::src_gen_stream(srcs[0], writer, args_has_flag(args, "g")) == false)
+			{
+				mn::printerr("{}", as::src_errs_dump(srcs[0], mn::memory::tmp()));
+				return -1;
+			}
+			return 0;
 		}
 
-		mn::print("{}", as::decl_dump(src, mn::memory::tmp()));
-		return 0;
-	}
-	else if(args.command == "build")
-	{
-		if(args.targets.count == 0)
-		{
-			mn::printerr("no input files\n");
-			return -1;
-		}
-		else if(args.targets.count > 1)
-		{
-			mn::printerr("multiple input files are not supported yet\n");
-			return -1;
-		}
+		bool use_cache = args_has_flag(args, "cache");
+		auto cache_name = mn::strf("{}.cache", args.out_name);
+		mn_defer(mn::str_free(cache_name));
 
-		if(mn::path_is_file(args.targets[0]) == false)
+		auto start = time_now_in_seconds();
+		auto cache = use_cache ? as::cache_load(cache_name) : as::cache_new();
+		mn_defer(as::cache_free(cache));
+		auto cache_load_end = time_now_in_seconds();
+
+		if(as::srcs_parse(srcs) == false)
 		{
-			mn::printerr("'{}' is not a file \n", args.targets[0]);
+			for(auto src: srcs)
+				mn::printerr("{}", as::src_errs_dump(src, mn::memory::tmp()));
 			return -1;
 		}
+		auto parse_end = time_now_in_seconds();
 
-		auto src = as::src_from_file(args.targets[0].ptr);
-		mn_defer(as::src_free(src));
+		auto opt_level = as::OPT_LEVEL_NONE;
+		if(args_has_flag(args, "O2"))
+			opt_level = as::OPT_LEVEL_2;
+		else if(args_has_flag(args, "O") || args_has_flag(args, "O1"))
+			opt_level = as::OPT_LEVEL_1;
+		as::srcs_opt(srcs, opt_level);
+		auto opt_end = time_now_in_seconds();
 
-		if(as::scan(src) == false)
-		{
-			mn::printerr("{}", as::src_errs_dump(src, mn::memory::tmp()));
-			return -1;
-		}
+		auto pkg = as::srcs_gen(srcs, 0, use_cache ? &cache : nullptr, args_has_flag(args, "g"));
+		mn_defer(vm::pkg_free(pkg));
+		auto gen_end = time_now_in_seconds();
 
-		if(as::parse(src) == false)
+		bool has_err = false;
+		for(auto src: srcs)
 		{
-			mn::printerr("{}", as::src_errs_dump(src, mn::memory::tmp()));
-			return -1;
+			if(as::src_has_err(src))
+			{
+				mn::printerr("{}", as::src_errs_dump(src, mn::memory::tmp()));
+				has_err = true;
+			}
 		}
-
-		auto pkg = as::src_gen(src);
-		mn_defer(vm::pkg_free(pkg));
+		if(has_err)
+			return -1;
 
 		vm::pkg_save(pkg, args.out_name);
+		if(use_cache)
+			as::cache_save(cache, cache_name);
+		auto end = time_now_in_seconds();
+
+		if(args_has_flag(args, "stats"))
+		{
+			mn::print("parse: {:.3f}ms\n", (parse_end - cache_load_end) * 1000);
+			mn::print("opt: {:.3f}ms\n", (opt_end - parse_end) * 1000);
+			mn::print("gen: {:.3f}ms\n", (gen_end - opt_end) * 1000);
+			mn::print("save: {:.3f}ms\n", (end - gen_end) * 1000);
+			if(use_cache)
+			{
+				auto lookups = cache.hits + cache.misses;
+				mn::print("cache load: {:.3f}ms\n", (cache_load_end - start) * 1000);
+				mn::print(
+					"cache: {} hits, {} misses, {:.1f}% hit rate\n",
+					cache.hits,
+					cache.misses,
+					lookups ? cache.hits * 100.0 / lookups : 0.0
+				);
+			}
+			mn::print("total: {:.3f}ms\n", (end - start) * 1000);
+			if(pkg.stack_size != 0)
+				mn::print("stack: {} bytes\n", pkg.stack_size);
+			else
+				mn::print("stack: unbounded, cores get the default {} bytes\n", vm::DEFAULT_STACK_SIZE);
+		}
 		return 0;
 	}
 	else if(args.command == "run")
@@ -254,7 +495,13 @@ main(int argc, char** argv)
 			return -1;
 		}
 
-		auto pkg = vm::pkg_load(args.targets[0].ptr);
+		auto loaded = vm::pkg_load(args.targets[0].ptr);
+		if(loaded.err)
+		{
+			mn::printerr("[Error]: {}\n", loaded.err);
+			return -1;
+		}
+		auto pkg = loaded.val;
 		mn_defer(vm::pkg_free(pkg));
 
 		auto cpu = vm::core_new();
@@ -267,12 +514,50 @@ main(int argc, char** argv)
 			return -1;
 		}
 
-		while (cpu.state == vm::Core::STATE_OK)
-			vm::core_ins_execute(cpu);
+		// the loader verified the bytecode, unverified bytecode still runs but with every fetch checked
+		if(cpu.verified == false)
+			if(auto verify_err = vm::core_verify(cpu))
+				mn::printerr("[Warning]: {}, running in the checked mode\n", verify_err);
+
+		if(args.sample_hz > 0)
+		{
+			auto sampler = vm::sampler_new(cpu, args.sample_hz);
+			mn_defer(vm::sampler_free(sampler));
+			vm::core_run_sampled(cpu, sampler);
+
+			auto folded_name = mn::strf("{}.folded", args.targets[0]);
+			mn_defer(mn::str_free(folded_name));
+			auto folded = vm::sampler_folded(sampler);
+			mn_defer(mn::str_free(folded));
+			auto f = mn::file_open(folded_name, mn::IO_MODE::WRITE, mn::OPEN_MODE::CREATE_OVERWRITE);
+			if(f == nullptr)
+			{
+				mn::printerr("failed to write the samples to '{}'\n", folded_name);
+				return -1;
+			}
+			mn::stream_write(f, mn::block_from(folded));
+			mn::file_close(f);
+			mn::print("{} samples written to '{}'\n", sampler.samples, folded_name);
+		}
+		else
+		{
+			vm::core_run(cpu);
+		}
+
+		if(args_has_flag(args, "profile"))
+		{
+		#if VM_PROFILE
+			profile_report(cpu);
+		#else
+			mn::printerr("tas was built without the VM_PROFILE option, rebuild it with -DVM_PROFILE=ON to use --profile\n");
+		#endif
+		}
 
 		if(cpu.state == vm::Core::STATE_ERR)
 		{
-			mn::print("CPU errored\n");
+			auto location = code_location(cpu, cpu.r[vm::Reg_IP].u64);
+			mn_defer(mn::str_free(location));
+			mn::print("CPU errored near {}\n", location);
 			return -1;
 		}
 
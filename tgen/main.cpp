@@ -0,0 +1,190 @@
+#include <mn/IO.h>
+#include <mn/Defer.h>
+#include <mn/File.h>
+
+#include <as/Synth.h>
+
+#include <string.h>
+#include <stdlib.h>
+
+const char* HELP_MSG = R"MSG(tgen tethys program generator
+tgen [flags]
+it generates a valid program which runs to a halt with a checksum of the run in r0, the same flags
+always generate the same program
+FLAGS:
+  -o: specifies output file, the program is printed if it's not specified
+    'tgen -o big.zy'
+  --seed: seed of the random instructions and the random call graph
+    'tgen --seed 42'
+  --procs: procs count including main
+    'tgen --procs 10000'
+  --size: generates as many procs as needed for a program of about the given size in MB, it
+    overrides --procs
+    'tgen --size 64 -o big.zy'
+  --ins: random instructions of each proc
+    'tgen --ins 64'
+  --labels: labels of each proc, the odd labels are loop heads and the even ones are forward jumps
+    targets
+    'tgen --labels 8'
+  --loops: iterations of each loop
+    'tgen --loops 10'
+  --constants: string constants the procs read from
+    'tgen --constants 16'
+  --c-procs: libc procs which are declared and called, up to 8
+    'tgen --c-procs 4'
+  --shape: shape of the call graph, it's one of chain, tree or random, every proc is called once
+    'tgen --shape tree --fanout 4'
+  --fanout: children of each proc in the tree shape
+    'tgen --shape tree --fanout 4'
+)MSG";
+
+inline static void
+print_help()
+{
+	mn::print("{}\n", HELP_MSG);
+}
+
+struct Args
+{
+	as::Synth_Config config;
+	// size of the program in MB, 0 when the procs count is used
+	size_t size_in_mb;
+	const char* out_name;
+};
+
+inline static bool
+args_uint(int argc, char** argv, size_t& i, size_t& value)
+{
+	if(i + 1 >= size_t(argc))
+	{
+		mn::printerr("you need to specify a value for '{}'\n", argv[i]);
+		return false;
+	}
+
+	char* end = nullptr;
+	value = ::strtoull(argv[i + 1], &end, 10);
+	if(end == argv[i + 1] || *end != '\0')
+	{
+		mn::printerr("invalid value '{}' for '{}'\n", argv[i + 1], argv[i]);
+		return false;
+	}
+	++i;
+	return true;
+}
+
+inline static bool
+args_parse(Args& self, int argc, char** argv)
+{
+	self.config = as::synth_config_default();
+	for(size_t i = 1; i < size_t(argc); ++i)
+	{
+		bool ok = true;
+		size_t seed = 0;
+		if(::strcmp(argv[i], "help") == 0 || ::strcmp(argv[i], "--help") == 0)
+		{
+			return false;
+		}
+		else if(::strcmp(argv[i], "-o") == 0)
+		{
+			if(i + 1 >= size_t(argc))
+			{
+				mn::printerr("you need to specify output name\n");
+				return false;
+			}
+			self.out_name = argv[++i];
+		}
+		else if(::strcmp(argv[i], "--seed") == 0)
+		{
+			ok = args_uint(argc, argv, i, seed);
+			self.config.seed = seed;
+		}
+		else if(::strcmp(argv[i], "--procs") == 0)
+		{
+			ok = args_uint(argc, argv, i, self.config.procs);
+		}
+		else if(::strcmp(argv[i], "--size") == 0)
+		{
+			ok = args_uint(argc, argv, i, self.size_in_mb);
+		}
+		else if(::strcmp(argv[i], "--ins") == 0)
+		{
+			ok = args_uint(argc, argv, i, self.config.ins_per_proc);
+		}
+		else if(::strcmp(argv[i], "--labels") == 0)
+		{
+			ok = args_uint(argc, argv, i, self.config.labels_per_proc);
+		}
+		else if(::strcmp(argv[i], "--loops") == 0)
+		{
+			ok = args_uint(argc, argv, i, self.config.loop_count);
+		}
+		else if(::strcmp(argv[i], "--constants") == 0)
+		{
+			ok = args_uint(argc, argv, i, self.config.constants);
+		}
+		else if(::strcmp(argv[i], "--c-procs") == 0)
+		{
+			ok = args_uint(argc, argv, i, self.config.c_procs);
+		}
+		else if(::strcmp(argv[i], "--fanout") == 0)
+		{
+			ok = args_uint(argc, argv, i, self.config.fanout);
+		}
+		else if(::strcmp(argv[i], "--shape") == 0)
+		{
+			if(i + 1 >= size_t(argc))
+			{
+				mn::printerr("you need to specify the call graph shape\n");
+				return false;
+			}
+			if(as::synth_shape_from_name(argv[i + 1], self.config.shape) == false)
+			{
+				mn::printerr("unknown call graph shape '{}'\n", argv[i + 1]);
+				return false;
+			}
+			++i;
+		}
+		else
+		{
+			mn::printerr("unknown flag '{}'\n", argv[i]);
+			return false;
+		}
+
+		if(ok == false)
+			return false;
+	}
+	return true;
+}
+
+int
+main(int argc, char** argv)
+{
+	Args args{};
+	if(args_parse(args, argc, argv) == false)
+	{
+		print_help();
+		return -1;
+	}
+
+	if(args.size_in_mb > 0)
+		args.config.procs = as::synth_procs_for_size(args.config, args.size_in_mb * 1024 * 1024);
+
+	auto code = as::synth_generate(args.config);
+	mn_defer(mn::str_free(code));
+
+	if(args.out_name == nullptr)
+	{
+		mn::print("{}", code);
+		return 0;
+	}
+
+	auto f = mn::file_open(args.out_name, mn::IO_MODE::WRITE, mn::OPEN_MODE::CREATE_OVERWRITE);
+	if(f == nullptr)
+	{
+		mn::printerr("failed to open '{}' for writing\n", args.out_name);
+		return -1;
+	}
+	mn_defer(mn::file_close(f));
+	mn::stream_write(f, mn::block_from(code));
+	return 0;
+}
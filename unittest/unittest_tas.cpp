@@ -3,11 +3,24 @@
 #include <as/Src.h>
 #include <as/Scan.h>
 #include <as/Parse.h>
+#include <as/Gen.h>
+#include <as/Cache.h>
+#include <as/Opt.h>
+#include <as/CFG.h>
+#include <as/Synth.h>
+
+#include <vm/Core.h>
+#include <vm/Verify.h>
+#include <vm/Asm.h>
+#include <vm/Sample.h>
+#include <vm/Debug.h>
 
 #include <mn/Defer.h>
 #include <mn/IO.h>
 #include <mn/Path.h>
+#include <mn/File.h>
 
+#include <algorithm>
 
 // scanning tests
 
@@ -254,6 +267,85 @@ line: 8, col: 2, kind: "END" str: "end"
 }
 
 
+TEST_CASE("scan: long whitespace, comment and identifier runs")
+{
+	// runs of different lengths to cross the chunk boundaries of the scanner fast paths with some
+	// non ascii runes in the middle, expected positions are computed the same way the scanner counts
+	auto code = mn::str_new();
+	mn_defer(mn::str_free(code));
+
+	struct Expected { uint32_t line, col; as::Tkn::KIND kind; mn::Str str; };
+	auto expected = mn::buf_new<Expected>();
+	mn_defer({
+		for (auto& e: expected)
+			mn::str_free(e.str);
+		mn::buf_free(expected);
+	});
+
+	uint32_t line = 1, col = 0;
+	for (uint32_t i = 0; i < 150; ++i)
+	{
+		for (uint32_t j = 0; j < i % 41 + 1; ++j)
+		{
+			mn::str_push(code, (j % 7 == 6) ? "\t" : " ");
+			++col;
+		}
+		if (i % 5 == 0)
+		{
+			for (uint32_t j = 0; j < i % 3 + 1; ++j)
+				mn::str_push(code, "\r\n");
+			line += i % 3 + 1;
+			col = 1;
+		}
+
+		auto text = mn::str_new();
+		uint32_t runes = 0;
+		for (uint32_t j = 0; j < i % 53 + 1; ++j, ++runes)
+			mn::str_push(text, (j % 10 == 9) ? "." : (j % 3 == 0) ? "x" : "y");
+		if (i % 4 == 3)
+		{
+			mn::str_push(text, "\xC3\xA9_z");
+			runes += 3;
+		}
+
+		if (i % 3 == 2)
+		{
+			mn::str_push(code, ";");
+			mn::str_push(code, text);
+			mn::str_push(code, "\n");
+			mn::buf_push(expected, Expected{line, col, as::Tkn::KIND_COMMENT, text});
+			++line;
+			col = 1;
+		}
+		else
+		{
+			mn::str_push(code, "x");
+			mn::str_push(code, text);
+			auto id = mn::str_new();
+			mn::str_push(id, "x");
+			mn::str_push(id, text);
+			mn::str_free(text);
+			mn::buf_push(expected, Expected{line, col, as::Tkn::KIND_ID, id});
+			col += runes + 1;
+		}
+	}
+
+	auto unit = as::src_from_str(code.ptr);
+	mn_defer(as::src_free(unit));
+	REQUIRE(as::scan(unit));
+	REQUIRE(unit->tkns.count == expected.count);
+	for (size_t i = 0; i < expected.count; ++i)
+	{
+		CHECK(unit->tkns[i].pos.line == expected[i].line);
+		CHECK(unit->tkns[i].pos.col == expected[i].col);
+		CHECK(unit->tkns[i].kind == expected[i].kind);
+		CHECK(expected[i].str == unit->tkns[i].str);
+	}
+	CHECK(unit->lines.count == line);
+	for (size_t i = 0; i + 1 < unit->lines.count; ++i)
+		CHECK(*unit->lines[i].end == '\n');
+}
+
 // parsing tests
 inline static mn::Str
 parse_str(const char* str)
@@ -336,6 +428,44 @@ Error[<STRING>:4:31]: expected a type token
 	CHECK(answer == expected);
 }
 
+TEST_CASE("parse: comments between tokens")
+{
+	auto answer = parse_str(R"""(
+	; leading comment
+	proc ; comment after proc
+	main
+		i32.mov ; comment inside an instruction
+		r0 ; another one
+		-1
+		halt ; trailing comment
+	end
+	; last comment)""");
+
+	const char* expected =R"""(
+PROC main
+  i32.mov r0 -1
+  halt
+END
+)""";
+
+	CHECK(answer == expected);
+}
+
+TEST_CASE("parse: unexpected top level token")
+{
+	auto answer = parse_str(R"""(
+	halt
+	)""");
+
+	const char* expected =R"""(
+>> 	halt
+>> 	^^^^
+Error[<STRING>:2:2]: unexpected token 'halt', expected a proc or a constant
+)""";
+
+	CHECK(answer == expected);
+}
+
 TEST_CASE("parse: constant debugstr")
 {
 	auto answer = parse_str(R"""(
@@ -662,3 +792,1833 @@ END
 
 	CHECK(answer == expected);
 }
+
+
+// running tests
+
+// generates the package of the code optimized on the given level, the code has to be free of errors
+inline static vm::Pkg
+pkg_from_str(const char* str, as::OPT_LEVEL level = as::OPT_LEVEL_NONE)
+{
+	auto srcs = mn::buf_new<as::Src*>();
+	mn_defer(destruct(srcs));
+	mn::buf_push(srcs, as::src_from_str(str));
+	REQUIRE(as::srcs_parse(srcs));
+	as::srcs_opt(srcs, level);
+
+	auto pkg = as::srcs_gen(srcs);
+	REQUIRE(as::src_has_err(srcs[0]) == false);
+	return pkg;
+}
+
+inline static int32_t
+run_str(const char* str)
+{
+	auto pkg = pkg_from_str(str);
+	mn_defer(vm::pkg_free(pkg));
+
+	auto cpu = vm::core_new();
+	mn_defer(vm::core_free(cpu));
+
+	auto err = vm::pkg_core_load(pkg, cpu);
+	REQUIRE(!err);
+
+	// the loader verified it so the checked mode has to be forced
+	cpu.verified = false;
+	while (cpu.state == vm::Core::STATE_OK)
+		vm::core_ins_execute(cpu);
+
+	REQUIRE(cpu.state == vm::Core::STATE_HALT);
+
+	// the generated bytecode passes verification and gives the same result in the unchecked mode
+	auto fast = vm::core_new();
+	mn_defer(vm::core_free(fast));
+	REQUIRE(!vm::pkg_core_load(pkg, fast));
+	if (fast.verified == false)
+		mn::printerr("{}\n", vm::core_verify(fast));
+	REQUIRE(fast.verified);
+	vm::core_run(fast);
+	REQUIRE(fast.state == vm::Core::STATE_HALT);
+	CHECK(fast.r[vm::Reg_R0].u64 == cpu.r[vm::Reg_R0].u64);
+	return cpu.r[vm::Reg_R0].i32;
+}
+
+TEST_CASE("run: simple jump")
+{
+	auto answer = run_str(R"""(
+	proc main
+		i32.mov r2 -2
+		i32.mov r1 0
+		i32.jl r2 r1 negative
+		jmp maybe_positive
+	negative:
+		i32.mov r0 -1
+		jmp exit
+	maybe_positive:
+		i32.jg r2 r1 positive
+		i32.mov r0 0
+		jmp exit
+	positive:
+		i32.mov r0 1
+	exit:
+		halt
+	end
+	)""");
+
+	CHECK(answer == -1);
+}
+
+TEST_CASE("run: long jump")
+{
+	// the loop body is larger than the range of the short jump so both jumps must be relaxed
+	auto answer = run_str(R"""(
+	proc main
+		i32.mov r0 0
+		i32.mov r1 0
+		jmp loop
+	skip:
+		i32.mov r0 -1
+		halt
+	loop:
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r0 1
+		i32.add r1 1
+		i32.jl r1 3 loop
+		halt
+	end
+	)""");
+
+	CHECK(answer == 60);
+}
+
+TEST_CASE("run: call")
+{
+	auto answer = run_str(R"""(
+	proc add_two
+		i32.add r0 2
+		ret
+	end
+
+	proc main
+		i32.mov r0 1
+		call add_two
+		call add_two
+		halt
+	end
+	)""");
+
+	CHECK(answer == 5);
+}
+
+TEST_CASE("parse: conditional move and set")
+{
+	auto answer = parse_str(R"""(
+	proc main
+		i32.cmp r0 r1
+		i32.cmovl r0 r1
+		u8.sete r2
+		u64.cmovge [sp] 5
+	end
+	)""");
+
+	const char* expected =R"""(
+PROC main
+  i32.cmp r0 r1
+  i32.cmovl r0 r1
+  u8.sete r2
+  u64.cmovge [sp] 5
+END
+)""";
+
+	CHECK(answer == expected);
+}
+
+TEST_CASE("run: conditional move")
+{
+	// branch free max(r0, r1)
+	auto answer = run_str(R"""(
+	proc main
+		i32.mov r0 -7
+		i32.mov r1 3
+		i32.cmp r0 r1
+		i32.cmovl r0 r1
+		halt
+	end
+	)""");
+
+	CHECK(answer == 3);
+}
+
+TEST_CASE("run: set on condition")
+{
+	// counts the values less than 10 in r1, r2, r3 without branches
+	auto answer = run_str(R"""(
+	proc main
+		i32.mov r0 0
+		i32.mov r1 4
+		i32.mov r2 12
+		i32.mov r3 9
+
+		i32.cmp r1 10
+		i32.setl r4
+		i32.add r0 r4
+
+		i32.cmp r2 10
+		i32.setl r4
+		i32.add r0 r4
+
+		i32.cmp r3 10
+		i32.setl r4
+		i32.add r0 r4
+		halt
+	end
+	)""");
+
+	CHECK(answer == 2);
+}
+
+TEST_CASE("run: bitwise")
+{
+	CHECK(run_str(R"""(
+	proc main
+		u32.mov r0 12
+		u32.and r0 10
+		u32.mov r1 12
+		u32.or r1 3
+		u32.xor r0 r1
+		halt
+	end
+	)""") == (8 ^ 15));
+
+	CHECK(run_str(R"""(
+	proc main
+		i32.mov r0 0
+		i32.not r0
+		halt
+	end
+	)""") == -1);
+}
+
+TEST_CASE("run: shift and rotate")
+{
+	CHECK(run_str(R"""(
+	proc main
+		i32.mov r0 -16
+		i32.shr r0 2
+		halt
+	end
+	)""") == -4);
+
+	CHECK(run_str(R"""(
+	proc main
+		u32.mov r0 4294967280
+		u32.shr r0 28
+		halt
+	end
+	)""") == 15);
+
+	CHECK(run_str(R"""(
+	proc main
+		u32.mov r0 1
+		u32.shl r0 4
+		u32.ror r0 5
+		u32.rol r0 1
+		halt
+	end
+	)""") == 1);
+
+	CHECK(run_str(R"""(
+	proc main
+		u8.mov r0 129
+		u8.rol r0 1
+		halt
+	end
+	)""") == 3);
+}
+
+TEST_CASE("run: bit count and byte swap")
+{
+	CHECK(run_str(R"""(
+	proc main
+		u32.mov r1 255
+		u32.popcnt r0 r1
+		halt
+	end
+	)""") == 8);
+
+	CHECK(run_str(R"""(
+	proc main
+		u16.mov r1 1
+		u32.mov r0 0
+		u16.clz r0 r1
+		halt
+	end
+	)""") == 15);
+
+	CHECK(run_str(R"""(
+	proc main
+		u64.mov r1 0
+		u64.ctz r0 r1
+		halt
+	end
+	)""") == 64);
+
+	CHECK(run_str(R"""(
+	proc main
+		u32.mov r0 305419896
+		u32.bswap r0
+		halt
+	end
+	)""") == 0x78563412);
+}
+
+TEST_CASE("parse: float")
+{
+	auto answer = parse_str(R"""(
+	proc main
+		f64.mov r1 -2.5
+		f64.fma r0 r1 4.0
+		f32.from.i32 r2 r0
+		f32.abs r2
+	end
+	)""");
+
+	const char* expected =R"""(
+PROC main
+  f64.mov r1 -2.5
+  f64.fma r0 r1 4.0
+  f32.from.i32 r2 r0
+  f32.abs r2
+END
+)""";
+
+	CHECK(answer == expected);
+}
+
+TEST_CASE("run: float arithmetic")
+{
+	CHECK(run_str(R"""(
+	proc main
+		f64.mov r1 2.5
+		f64.mov r2 4
+		f64.mul r1 r2
+		f64.fma r1 r2 0.5
+		f64.sqrt r1 r1
+		f64.sub r1 0.25
+		i32.from.f64 r0 r1
+		halt
+	end
+	)""") == 3);
+
+	CHECK(run_str(R"""(
+	proc main
+		i32.mov r1 -7
+		f32.from.i32 r1 r1
+		f32.abs r1
+		f32.max r1 2
+		f32.min r1 5.5
+		f32.neg r1
+		f64.from.f32 r1 r1
+		i32.from.f64 r0 r1
+		halt
+	end
+	)""") == -5);
+}
+
+TEST_CASE("run: float compare and conversion")
+{
+	// NaN compares as unordered
+	CHECK(run_str(R"""(
+	proc main
+		f64.mov r1 0
+		f64.div r1 r1
+		f64.cmp r1 r1
+		i32.mov r0 0
+		i32.sete r0
+		i32.mov r2 0
+		i32.setl r2
+		i32.add r0 r2
+		halt
+	end
+	)""") == 0);
+
+	CHECK(run_str(R"""(
+	proc main
+		f32.mov r1 1.5
+		f32.cmp r1 2.5
+		i32.mov r0 0
+		i32.setl r0
+		halt
+	end
+	)""") == 1);
+
+	// out of range values saturate
+	CHECK(run_str(R"""(
+	proc main
+		f32.mov r1 1e20
+		i32.from.f32 r0 r1
+		halt
+	end
+	)""") == INT32_MAX);
+}
+
+TEST_CASE("parse: stack frame")
+{
+	auto answer = parse_str(R"""(
+	proc main
+		push r0 r1 fp
+		enter 16
+		i64.mov [fp - 8] r0
+		i64.mov r1 [fp-8]
+		i64.add r1 [sp + 4]
+		leave
+		pop r0 r1 fp
+		call main
+		ret
+	end
+	)""");
+
+	const char* expected =R"""(
+PROC main
+  push r0 r1 fp
+  enter 16
+  i64.mov [fp - 8] r0
+  i64.mov r1 [fp -8]
+  i64.add r1 [sp + 4]
+  leave
+  pop r0 r1 fp
+  call main
+  ret
+END
+)""";
+
+	CHECK(answer == expected);
+}
+
+TEST_CASE("parse: register lists only hold r0 to r7 and fp")
+{
+	auto answer = parse_str(R"""(
+	proc main
+		push r0 sp ip
+		halt
+	end
+	)""");
+
+	const char* expected = R"""(
+>> 		push r0 sp ip
+>> 		        ^^   
+Error[<STRING>:3:11]: 'sp' can't be in a register list, only r0 to r7 and fp can
+>> 		push r0 sp ip
+>> 		           ^^
+Error[<STRING>:3:14]: 'ip' can't be in a register list, only r0 to r7 and fp can
+)""";
+
+	CHECK(answer == expected);
+}
+
+TEST_CASE("run: stack frame")
+{
+	auto answer = run_str(R"""(
+	proc main
+		enter 16
+		i64.mov [fp - 8] 40
+		i64.mov [fp - 16] 2
+		i64.mov r1 [fp-8]
+		i64.add r1 [fp -16]
+		leave
+		i32.mov r0 r1
+		halt
+	end
+	)""");
+
+	CHECK(answer == 42);
+}
+
+TEST_CASE("run: push and pop multiple registers")
+{
+	auto answer = run_str(R"""(
+	proc main
+		i32.mov r0 1
+		i32.mov r1 2
+		i32.mov r2 3
+		push r0 r1 r2
+		i32.mov r0 0
+		i32.mov r1 0
+		i32.mov r2 0
+		pop r0 r1 r2
+		i32.mul r1 10
+		i32.mul r2 100
+		i32.add r0 r1
+		i32.add r0 r2
+		halt
+	end
+	)""");
+
+	CHECK(answer == 321);
+}
+
+TEST_CASE("run: tail call")
+{
+	// the recursion depth doesn't grow the stack, only the first return address is on it
+	auto answer = run_str(R"""(
+	proc count
+		i32.je r1 0 done
+		i32.sub r1 1
+		call count
+		ret
+	done:
+		u64.mov r0 r2
+		u64.sub r0 sp
+		ret
+	end
+
+	proc main
+		u64.mov r2 sp
+		i32.mov r1 1000
+		call count
+		halt
+	end
+	)""");
+
+	CHECK(answer == 8);
+}
+
+TEST_CASE("build: stream")
+{
+	const char* code = R"""(
+	; procs call each other before and after they're declared
+	constant msg "Hello, World!\0"
+
+	proc C.puts(C.ptr) C.int32
+
+	proc twice
+		i32.add r0 r0
+		call inc
+		ret
+	end
+
+	proc inc
+		i32.add r0 1
+		ret
+	end
+
+	proc main
+		i32.mov r0 20
+		u64.mov r1 msg
+		u64.mov r2 world
+		u64.mov r3 other
+		call twice
+		halt
+	end
+
+	; pooled with msg
+	constant world "World!\0"
+	constant other "Hello, World!\0"
+	)""";
+
+	auto unit = as::src_from_str(code);
+	mn_defer(as::src_free(unit));
+	REQUIRE(as::scan(unit));
+	REQUIRE(as::parse(unit));
+	auto pkg = as::src_gen(unit);
+	mn_defer(vm::pkg_free(pkg));
+	REQUIRE(as::src_has_err(unit) == false);
+
+	{
+		auto f = mn::file_open("stream_test.zy", mn::IO_MODE::WRITE, mn::OPEN_MODE::CREATE_OVERWRITE);
+		REQUIRE(f != nullptr);
+		mn::stream_write(f, mn::block_from(mn::str_lit(code)));
+		mn::file_close(f);
+	}
+	// small chunks so that decls are read in multiple chunks and scanned again
+	auto stream_unit = as::src_stream_from_file("stream_test.zy", 16);
+	mn_defer(as::src_free(stream_unit));
+	{
+		auto writer = vm::pkg_writer_new("stream_test.zyc");
+		mn_defer(vm::pkg_writer_free(writer));
+		REQUIRE(as::src_gen_stream(stream_unit, writer));
+	}
+	mn::file_remove("stream_test.zy");
+	// nothing but the globals names should be kept and the lines of the first decls are released
+	CHECK(stream_unit->decls.count == 0);
+	CHECK(stream_unit->content_line > 1);
+	CHECK(stream_unit->content.count < ::strlen(code));
+
+	auto stream_loaded = vm::pkg_load("stream_test.zyc");
+	REQUIRE(!stream_loaded.err);
+	auto stream_pkg = stream_loaded.val;
+	mn_defer(vm::pkg_free(stream_pkg));
+	mn::file_remove("stream_test.zyc");
+
+	// both builds give the same package
+	REQUIRE(stream_pkg.sections.count == pkg.sections.count);
+	for (const auto& [name, section]: pkg.sections)
+	{
+		auto it = mn::map_lookup(stream_pkg.sections, name);
+		REQUIRE(it != nullptr);
+		CHECK(it->value.kind == section.kind);
+		REQUIRE(it->value.bytes.size == section.bytes.size);
+		CHECK(::memcmp(it->value.bytes.ptr, section.bytes.ptr, section.bytes.size) == 0);
+	}
+	// relocs to the procs declared before their use are written first
+	auto reloc_less = [](const vm::Reloc& a, const vm::Reloc& b) {
+		auto cmp = ::strcmp(a.source_name.ptr, b.source_name.ptr);
+		if (cmp != 0)
+			return cmp < 0;
+		return a.source_offset < b.source_offset;
+	};
+	std::sort(begin(pkg.relocs), end(pkg.relocs), reloc_less);
+	std::sort(begin(stream_pkg.relocs), end(stream_pkg.relocs), reloc_less);
+	REQUIRE(stream_pkg.relocs.count == pkg.relocs.count);
+	for (size_t i = 0; i < pkg.relocs.count; ++i)
+	{
+		CHECK(stream_pkg.relocs[i].source_name == pkg.relocs[i].source_name);
+		CHECK(stream_pkg.relocs[i].target_name == pkg.relocs[i].target_name);
+		CHECK(stream_pkg.relocs[i].source_offset == pkg.relocs[i].source_offset);
+		CHECK(stream_pkg.relocs[i].width == pkg.relocs[i].width);
+		CHECK(stream_pkg.relocs[i].target_offset == pkg.relocs[i].target_offset);
+	}
+	REQUIRE(stream_pkg.c_procs.count == pkg.c_procs.count);
+	CHECK(stream_pkg.c_procs[0].name == pkg.c_procs[0].name);
+	CHECK(pkg.stack_size != 0);
+	CHECK(stream_pkg.stack_size == pkg.stack_size);
+
+	auto cpu = vm::core_new();
+	mn_defer(vm::core_free(cpu));
+	auto err = vm::pkg_core_load(stream_pkg, cpu);
+	REQUIRE(!err);
+	while (cpu.state == vm::Core::STATE_OK)
+		vm::core_ins_execute(cpu);
+	REQUIRE(cpu.state == vm::Core::STATE_HALT);
+	CHECK(cpu.r[vm::Reg_R0].i32 == 41);
+}
+
+TEST_CASE("build: stream errors")
+{
+	auto unit = as::src_from_str(R"""(
+	proc main
+		halt
+	end
+
+	proc main
+		halt
+	end
+	)""");
+	mn_defer(as::src_free(unit));
+
+	{
+		auto writer = vm::pkg_writer_new("stream_test.zyc");
+		mn_defer(vm::pkg_writer_free(writer));
+		CHECK(as::src_gen_stream(unit, writer) == false);
+	}
+	mn::file_remove("stream_test.zyc");
+
+	const char* expected = R"""(
+>> 	proc main
+>> 	     ^^^^
+Error[<STRING>:6:7]: symbol redefinition, it was first defined in 2:7
+)""";
+	CHECK(mn::str_tmpf("\n{}", as::src_errs_dump(unit, mn::memory::tmp())) == expected);
+}
+
+TEST_CASE("build: stream errors after released lines")
+{
+	const char* code = R"""(
+	proc a
+		ret
+	end
+
+	proc b
+		ret
+	end
+
+	proc main
+		i32.mov r0 r1 r2 ]
+		halt
+	end
+	)""";
+
+	{
+		auto f = mn::file_open("stream_test.zy", mn::IO_MODE::WRITE, mn::OPEN_MODE::CREATE_OVERWRITE);
+		REQUIRE(f != nullptr);
+		mn::stream_write(f, mn::block_from(mn::str_lit(code)));
+		mn::file_close(f);
+	}
+	auto unit = as::src_from_file("stream_test.zy");
+	mn_defer(as::src_free(unit));
+	REQUIRE(as::scan(unit));
+	CHECK(as::parse(unit) == false);
+
+	auto stream_unit = as::src_stream_from_file("stream_test.zy", 16);
+	mn_defer(as::src_free(stream_unit));
+	{
+		auto writer = vm::pkg_writer_new("stream_test.zyc");
+		mn_defer(vm::pkg_writer_free(writer));
+		CHECK(as::src_gen_stream(stream_unit, writer) == false);
+	}
+	mn::file_remove("stream_test.zy");
+	mn::file_remove("stream_test.zyc");
+
+	// the error line is found even though the lines before it are released
+	CHECK(stream_unit->content_line > 1);
+	auto expected = as::src_errs_dump(unit, mn::memory::tmp());
+	CHECK(as::src_errs_dump(stream_unit, mn::memory::tmp()) == expected);
+	CHECK(expected.count > 0);
+}
+
+TEST_CASE("build: stream reports labels redefined by later globals")
+{
+	const char* code = R"""(
+	proc main
+	done:
+		halt
+	end
+
+	proc done
+		ret
+	end
+	)""";
+
+	auto unit = as::src_from_str(code);
+	mn_defer(as::src_free(unit));
+	REQUIRE(as::scan(unit));
+	REQUIRE(as::parse(unit));
+	auto pkg = as::src_gen(unit);
+	mn_defer(vm::pkg_free(pkg));
+	REQUIRE(as::src_has_err(unit));
+
+	auto stream_unit = as::src_from_str(code);
+	mn_defer(as::src_free(stream_unit));
+	{
+		auto writer = vm::pkg_writer_new("stream_test.zyc");
+		mn_defer(vm::pkg_writer_free(writer));
+		CHECK(as::src_gen_stream(stream_unit, writer) == false);
+	}
+	mn::file_remove("stream_test.zyc");
+
+	// the label is gone by the time the global is reached so the global is reported instead
+	const char* expected = R"""(
+>> 	proc done
+>> 	     ^^^^
+Error[<STRING>:7:7]: global symbol redefinition, it was first defined as a label in 3:2
+)""";
+	CHECK(mn::str_tmpf("\n{}", as::src_errs_dump(stream_unit, mn::memory::tmp())) == expected);
+}
+
+inline static mn::Str
+gen_procs_str(size_t count, bool with_errors)
+{
+	auto code = mn::str_tmp();
+	for (size_t i = 0; i < count; ++i)
+	{
+		code = mn::strf(code, R"""(
+	proc p{}
+		i32.mov r0 {}
+	loop:
+		i32.add r0 1
+		i32.jl r0 {} loop
+		call p{}
+		ret
+	end
+)""", i, i, i * 7, (i + 1) % count);
+
+		if (with_errors && i % 17 == 3)
+			code = mn::strf(code, "proc bad{}\n\tjmp missing{}\nend\n", i, i);
+	}
+	return code;
+}
+
+// generates the code on 1 and 8 workers and checks the packages are the same, returns the errors count
+inline static size_t
+gen_workers_check(const mn::Str& code)
+{
+	auto serial_unit = as::src_from_str(code.ptr);
+	mn_defer(as::src_free(serial_unit));
+	REQUIRE(as::scan(serial_unit));
+	REQUIRE(as::parse(serial_unit));
+	auto serial = as::src_gen(serial_unit, 1);
+	mn_defer(vm::pkg_free(serial));
+
+	auto parallel_unit = as::src_from_str(code.ptr);
+	mn_defer(as::src_free(parallel_unit));
+	REQUIRE(as::scan(parallel_unit));
+	REQUIRE(as::parse(parallel_unit));
+	auto parallel = as::src_gen(parallel_unit, 8);
+	mn_defer(vm::pkg_free(parallel));
+
+	CHECK(as::src_errs_dump(serial_unit, mn::memory::tmp()) == as::src_errs_dump(parallel_unit, mn::memory::tmp()));
+
+	REQUIRE(serial.sections.count == parallel.sections.count);
+	for (const auto& [name, section]: serial.sections)
+	{
+		auto it = mn::map_lookup(parallel.sections, name);
+		REQUIRE(it != nullptr);
+		REQUIRE(it->value.bytes.size == section.bytes.size);
+		CHECK(::memcmp(it->value.bytes.ptr, section.bytes.ptr, section.bytes.size) == 0);
+	}
+
+	REQUIRE(serial.relocs.count == parallel.relocs.count);
+	for (size_t i = 0; i < serial.relocs.count; ++i)
+	{
+		CHECK(serial.relocs[i].source_name == parallel.relocs[i].source_name);
+		CHECK(serial.relocs[i].target_name == parallel.relocs[i].target_name);
+		CHECK(serial.relocs[i].source_offset == parallel.relocs[i].source_offset);
+	}
+	return serial_unit->errs.count;
+}
+
+TEST_CASE("gen: parallel procs match serial")
+{
+	CHECK(gen_workers_check(gen_procs_str(300, false)) == 0);
+}
+
+TEST_CASE("gen: parallel procs errors match serial")
+{
+	CHECK(gen_workers_check(gen_procs_str(100, true)) == 6);
+}
+
+TEST_CASE("build: multiple srcs")
+{
+	auto srcs = mn::buf_new<as::Src*>();
+	mn_defer(destruct(srcs));
+	mn::buf_push(srcs, as::src_from_str(R"""(
+	proc main
+		i32.mov r1 20
+		call add_22
+		halt
+	end
+	)"""));
+	mn::buf_push(srcs, as::src_from_str(R"""(
+	proc add_22
+		i32.mov r0 r1
+		i32.add r0 22
+		ret
+	end
+	)"""));
+
+	REQUIRE(as::srcs_parse(srcs, 2));
+	auto pkg = as::srcs_gen(srcs, 2);
+	mn_defer(vm::pkg_free(pkg));
+	for (auto src: srcs)
+		REQUIRE(as::src_has_err(src) == false);
+
+	auto cpu = vm::core_new();
+	mn_defer(vm::core_free(cpu));
+
+	auto err = vm::pkg_core_load(pkg, cpu);
+	REQUIRE(!err);
+
+	while (cpu.state == vm::Core::STATE_OK)
+		vm::core_ins_execute(cpu);
+
+	REQUIRE(cpu.state == vm::Core::STATE_HALT);
+	CHECK(cpu.r[vm::Reg_R0].i32 == 42);
+}
+
+TEST_CASE("build: multiple srcs symbol redefinition")
+{
+	auto srcs = mn::buf_new<as::Src*>();
+	mn_defer(destruct(srcs));
+	mn::buf_push(srcs, as::src_from_str(R"""(
+	proc main
+		halt
+	end
+	)"""));
+	mn::buf_push(srcs, as::src_from_str(R"""(
+	proc main
+		halt
+	end
+	)"""));
+	mn::str_free(srcs[0]->path);
+	srcs[0]->path = mn::str_from_c("a.zy");
+
+	REQUIRE(as::srcs_parse(srcs));
+	auto pkg = as::srcs_gen(srcs);
+	mn_defer(vm::pkg_free(pkg));
+
+	CHECK(as::src_has_err(srcs[0]) == false);
+	const char* expected = R"""(
+>> 	proc main
+>> 	     ^^^^
+Error[<STRING>:2:7]: symbol redefinition, it was first defined in a.zy:2:7
+)""";
+	CHECK(mn::str_tmpf("\n{}", as::src_errs_dump(srcs[1], mn::memory::tmp())) == expected);
+}
+
+inline static vm::Pkg
+cache_build(const char* code, as::Cache& cache)
+{
+	auto srcs = mn::buf_new<as::Src*>();
+	mn_defer(destruct(srcs));
+	mn::buf_push(srcs, as::src_from_str(code));
+	REQUIRE(as::srcs_parse(srcs));
+	auto pkg = as::srcs_gen(srcs, 1, &cache);
+	REQUIRE(as::src_has_err(srcs[0]) == false);
+	return pkg;
+}
+
+TEST_CASE("build: cache")
+{
+	const char* code = R"""(
+	proc add
+		i32.add r0 r1
+		ret
+	end
+	proc main
+		i32.mov r0 20
+		i32.mov r1 22
+		call add
+		halt
+	end
+	)""";
+
+	auto cache = as::cache_new();
+	mn_defer(as::cache_free(cache));
+
+	auto first = cache_build(code, cache);
+	mn_defer(vm::pkg_free(first));
+	CHECK(cache.hits == 0);
+	CHECK(cache.misses == 2);
+
+	as::cache_save(cache, mn::str_lit("cache_test.cache"));
+	auto loaded = as::cache_load(mn::str_lit("cache_test.cache"));
+	mn_defer(as::cache_free(loaded));
+	mn::file_remove("cache_test.cache");
+
+	auto second = cache_build(code, loaded);
+	mn_defer(vm::pkg_free(second));
+	CHECK(loaded.hits == 2);
+	CHECK(loaded.misses == 0);
+
+	REQUIRE(first.sections.count == second.sections.count);
+	for (const auto& [name, section]: first.sections)
+	{
+		auto it = mn::map_lookup(second.sections, name);
+		REQUIRE(it != nullptr);
+		REQUIRE(it->value.bytes.size == section.bytes.size);
+		CHECK(::memcmp(it->value.bytes.ptr, section.bytes.ptr, section.bytes.size) == 0);
+	}
+	REQUIRE(first.relocs.count == second.relocs.count);
+	for (size_t i = 0; i < first.relocs.count; ++i)
+	{
+		CHECK(first.relocs[i].target_name == second.relocs[i].target_name);
+		CHECK(first.relocs[i].source_offset == second.relocs[i].source_offset);
+	}
+
+	// main tokens are the same but add is no longer a global so only the unchanged add body hits
+	auto third = cache_build(R"""(
+	proc add2
+		i32.add r0 r1
+		ret
+	end
+	proc main
+		i32.mov r0 20
+		i32.mov r1 22
+		call add
+		halt
+	end
+	)""", loaded);
+	mn_defer(vm::pkg_free(third));
+	CHECK(loaded.hits == 3);
+	CHECK(loaded.misses == 1);
+}
+
+// runs the code on the optimization levels up to the given one in the checked mode, and in the
+// unchecked mode too if asked, and checks they all halt with the same r0
+inline static uint64_t
+opt_run_str(const char* str, as::OPT_LEVEL level = as::OPT_LEVEL_2, bool unchecked = false)
+{
+	uint64_t results[6] = {};
+	size_t count = 0;
+	for (int i = 0; i <= level; ++i)
+	{
+		auto pkg = pkg_from_str(str, as::OPT_LEVEL(i));
+		mn_defer(vm::pkg_free(pkg));
+
+		for (int verify = 0; verify < (unchecked ? 2 : 1); ++verify)
+		{
+			auto cpu = vm::core_new();
+			mn_defer(vm::core_free(cpu));
+			REQUIRE(!vm::pkg_core_load(pkg, cpu));
+			if (unchecked)
+				REQUIRE(cpu.verified);
+			cpu.verified = verify;
+
+			vm::core_run(cpu);
+			REQUIRE(cpu.state == vm::Core::STATE_HALT);
+			results[count++] = cpu.r[vm::Reg_R0].u64;
+		}
+	}
+	for (size_t i = 1; i < count; ++i)
+		CHECK(results[i] == results[0]);
+	return results[0];
+}
+
+TEST_CASE("opt: peephole")
+{
+	auto unit = as::src_from_str(R"""(
+	proc main
+		i64.sub sp 8
+		i64.sub sp 8
+		i32.mov r0 r0
+		i32.add r1 0
+		u32.mul r1 1
+		jmp next
+	next:
+		jmp first
+	first:
+		i32.jl r0 10 second
+		halt
+	second:
+		jmp exit
+	exit:
+		halt
+	end
+	)""");
+	mn_defer(as::src_free(unit));
+	REQUIRE(as::scan(unit));
+	REQUIRE(as::parse(unit));
+
+	auto& proc = unit->decls[0]->proc;
+	as::proc_peephole(unit, proc);
+
+	const char* expected[] = {"i64.sub", "next", "first", "i32.jl", "halt", "second", "exit", "halt"};
+	REQUIRE(proc.ins.count == sizeof(expected) / sizeof(*expected));
+	for (size_t i = 0; i < proc.ins.count; ++i)
+		CHECK(mn::str_lit(expected[i]) == mn::str_lit(proc.ins[i].op.str));
+	CHECK(mn::str_lit(proc.ins[0].src.imm.str) == "16");
+	CHECK(mn::str_lit(proc.ins[3].lbl.str) == "exit");
+}
+
+TEST_CASE("opt: optimized programs give the same results")
+{
+	CHECK(opt_run_str(R"""(
+	proc main
+		i32.mov r0 0
+		i32.mov r1 0
+	loop:
+		i32.add r0 r1
+		i32.add r0 0
+		i32.add r1 1
+		i32.add r1 1
+		i32.mul r0 1
+		i32.jl r1 100 continue
+		jmp exit
+	continue:
+		jmp loop
+	exit:
+		halt
+	end
+	)""") == 2450);
+
+	CHECK(opt_run_str(R"""(
+	proc sum
+		i64.sub sp 8
+		i64.sub sp 8
+		u64.mov [sp] r1
+		i64.add r0 [sp]
+		i64.add sp 8
+		i64.add sp 8
+		ret
+	end
+	proc main
+		i32.mov r0 40
+		i32.mov r1 2
+		i32.mov r1 r1
+		call sum
+		i8.add r0 100
+		i8.add r0 100
+		halt
+	end
+	)""") == 242);
+}
+
+TEST_CASE("opt: conditional jump to the next label keeps its compare")
+{
+	CHECK(opt_run_str(R"""(
+	proc main
+		i32.mov r0 0
+		i32.mov r1 1
+		i32.mov r2 2
+		i32.cmp r2 r1
+		i32.jl r1 r2 next
+	next:
+		i32.setl r0
+		halt
+	end
+	)""") == 1);
+}
+
+TEST_CASE("opt: label errors in dead blocks")
+{
+	// the dead block jumps to an undefined label, redefines a label and defines one named after a proc
+	const char* code = R"""(
+	proc main
+		i32.mov r0 1
+		jmp exit
+	dead:
+		jmp nowhere
+	exit:
+	dead:
+	f:
+		halt
+	end
+
+	proc f
+		ret
+	end
+	)""";
+
+	mn::Str dumps[3] = {};
+	for (int i = 0; i < 3; ++i)
+	{
+		auto srcs = mn::buf_new<as::Src*>();
+		mn_defer(destruct(srcs));
+		mn::buf_push(srcs, as::src_from_str(code));
+		REQUIRE(as::srcs_parse(srcs));
+		as::srcs_opt(srcs, as::OPT_LEVEL(i));
+
+		auto pkg = as::srcs_gen(srcs);
+		mn_defer(vm::pkg_free(pkg));
+		REQUIRE(as::src_has_err(srcs[0]));
+		dumps[i] = as::src_errs_dump(srcs[0], mn::memory::tmp());
+	}
+	CHECK(dumps[1] == dumps[0]);
+	CHECK(dumps[2] == dumps[0]);
+}
+
+TEST_CASE("cfg: blocks, edges and registers")
+{
+	auto unit = as::src_from_str(R"""(
+	proc main
+		i32.mov r0 0
+		i64.mov r1 r2
+	loop:
+		i32.add r0 1
+		i32.jl r0 10 loop
+		jmp exit
+	dead:
+		i32.mov r0 -1
+		jmp hop
+	hop:
+		jmp exit
+	exit:
+		halt
+	end
+	)""");
+	mn_defer(as::src_free(unit));
+	REQUIRE(as::scan(unit));
+	REQUIRE(as::parse(unit));
+
+	auto& proc = unit->decls[0]->proc;
+	auto cfg = as::cfg_build(proc);
+	mn_defer(as::cfg_free(cfg));
+
+	// entry, loop, jmp exit, dead, hop, exit
+	REQUIRE(cfg.blocks.count == 6);
+	CHECK(cfg.blocks[0].succs.count == 1);
+	CHECK(cfg.blocks[0].succs[0] == 1);
+	REQUIRE(cfg.blocks[1].succs.count == 2);
+	CHECK(cfg.blocks[1].succs[0] == 1);
+	CHECK(cfg.blocks[1].succs[1] == 2);
+	CHECK(cfg.blocks[5].succs.count == 0);
+
+	auto r0 = as::reg_list_bit(as::Tkn{as::Tkn::KIND_KEYWORD_R0});
+	auto r1 = as::reg_list_bit(as::Tkn{as::Tkn::KIND_KEYWORD_R1});
+	auto r2 = as::reg_list_bit(as::Tkn{as::Tkn::KIND_KEYWORD_R2});
+	// i32.mov is a partial write so it uses the destination as well
+	CHECK(cfg.blocks[0].regs[0].def == r0);
+	CHECK(cfg.blocks[0].regs[0].use == r0);
+	CHECK(cfg.blocks[0].regs[1].def == r1);
+	CHECK(cfg.blocks[0].regs[1].use == r2);
+	CHECK(cfg.blocks[1].regs[1].def == 0);
+	CHECK(cfg.blocks[1].regs[1].use == r0);
+
+	// pop into memory writes through r1 so it reads it
+	as::Ins pop{};
+	pop.op = as::Tkn{as::Tkn::KIND_KEYWORD_POP};
+	pop.dst = as::operand_mem(as::Tkn{as::Tkn::KIND_KEYWORD_R1});
+	auto sp = as::reg_list_bit(as::Tkn{as::Tkn::KIND_KEYWORD_SP});
+	CHECK(as::ins_regs(pop).def == sp);
+	CHECK(as::ins_regs(pop).use == (r1 | sp));
+
+	CHECK(as::cfg_jumps_thread(cfg));
+	CHECK(mn::str_lit(cfg.blocks[3].ins[1].lbl.str) == "exit");
+	CHECK(as::cfg_dead_blocks_remove(cfg));
+	// dead and hop are gone
+	REQUIRE(cfg.blocks.count == 4);
+	CHECK(cfg.blocks[2].succs[0] == 3);
+
+	as::cfg_lower(cfg, proc);
+	const char* expected[] = {"i32.mov", "i64.mov", "loop", "i32.add", "i32.jl", "jmp", "exit", "halt"};
+	REQUIRE(proc.ins.count == sizeof(expected) / sizeof(*expected));
+	for (size_t i = 0; i < proc.ins.count; ++i)
+		CHECK(mn::str_lit(expected[i]) == mn::str_lit(proc.ins[i].op.str));
+}
+
+TEST_CASE("opt: dead blocks")
+{
+	CHECK(opt_run_str(R"""(
+	proc main
+		i32.mov r0 1
+		jmp skip
+	unused:
+		i32.mov r0 -1
+		jmp unused
+	skip:
+		i32.add r0 41
+		halt
+	end
+	)""") == 42);
+}
+
+TEST_CASE("opt: inline leaf procs")
+{
+	const char* code = R"""(
+	proc abs
+		i32.jl r0 0 negative
+		ret
+	negative:
+		i32.mov r1 0
+		i32.sub r1 r0
+		i32.mov r0 r1
+		ret
+	end
+	proc uses_stack
+		i64.mov r2 [sp + 8]
+		ret
+	end
+	proc main
+		i32.mov r0 -20
+		call abs
+		i32.mov r2 r0
+		i32.mov r0 22
+		call abs
+		i32.add r0 r2
+		halt
+	end
+	)""";
+	CHECK(opt_run_str(code) == 42);
+
+	auto srcs = mn::buf_new<as::Src*>();
+	mn_defer(destruct(srcs));
+	mn::buf_push(srcs, as::src_from_str(code));
+	REQUIRE(as::srcs_parse(srcs));
+	as::srcs_opt(srcs, as::OPT_LEVEL_2);
+
+	// abs is inlined and dropped, uses_stack depends on the return address so it's kept
+	auto decls = srcs[0]->decls;
+	REQUIRE(decls.count == 2);
+	CHECK(mn::str_lit(decls[0]->proc.name.str) == "uses_stack");
+	CHECK(mn::str_lit(decls[1]->proc.name.str) == "main");
+	for (const auto& ins: decls[1]->proc.ins)
+		CHECK(ins.op.kind != as::Tkn::KIND_KEYWORD_CALL);
+
+	// the inlined instructions are at the lines of their calls in main, not the lines of abs
+	for (const auto& ins: decls[1]->proc.ins)
+	{
+		CHECK(ins.op.pos.line >= 16);
+		CHECK(ins.op.pos.line <= 22);
+	}
+	auto sub_lines = mn::buf_with_allocator<uint32_t>(mn::memory::tmp());
+	for (const auto& ins: decls[1]->proc.ins)
+		if (ins.op.kind == as::Tkn::KIND_KEYWORD_I32_SUB)
+			mn::buf_push(sub_lines, uint32_t(ins.op.pos.line));
+	REQUIRE(sub_lines.count == 2);
+	CHECK(sub_lines[0] == 17);
+	CHECK(sub_lines[1] == 20);
+}
+
+TEST_CASE("gen: constants pooling")
+{
+	auto pkg = pkg_from_str(R"""(
+	constant hello "Hello, World!\0"
+	constant world "World!\0"
+	constant hello_again "Hello, World!\0"
+	constant other "other\0"
+
+	proc main
+		u64.mov r1 world
+		u8.mov r0 [r1]
+		u64.mov r1 hello_again
+		u8.mov r2 [r1]
+		u64.mov r1 other
+		u8.mov r3 [r1]
+		halt
+	end
+	)""");
+	mn_defer(vm::pkg_free(pkg));
+
+	// main and the rodata section only, hello and world share the same bytes
+	REQUIRE(pkg.sections.count == 2);
+	auto it = mn::map_lookup(pkg.sections, mn::str_lit(vm::RODATA_SECTION));
+	REQUIRE(it != nullptr);
+	CHECK(it->value.kind == vm::Section::KIND_CONSTANT);
+	CHECK(it->value.bytes.size == sizeof("Hello, World!") + sizeof("other"));
+
+	auto cpu = vm::core_new();
+	mn_defer(vm::core_free(cpu));
+	auto err = vm::pkg_core_load(pkg, cpu);
+	REQUIRE(!err);
+	while (cpu.state == vm::Core::STATE_OK)
+		vm::core_ins_execute(cpu);
+	REQUIRE(cpu.state == vm::Core::STATE_HALT);
+	CHECK(cpu.r[vm::Reg_R0].u8 == 'W');
+	CHECK(cpu.r[vm::Reg_R2].u8 == 'H');
+	CHECK(cpu.r[vm::Reg_R3].u8 == 'o');
+}
+
+TEST_CASE("vm: shared read only image")
+{
+	auto pkg = pkg_from_str(R"""(
+	constant msg "tethys\0"
+
+	proc main
+		u64.mov r1 msg
+		u8.mov r0 [r1]
+		u8.mov [r1] 0
+		halt
+	end
+	)""");
+	mn_defer(vm::pkg_free(pkg));
+
+	auto image = vm::pkg_image_load(pkg);
+	mn_defer(vm::image_free(image));
+
+	auto cpu1 = vm::core_new();
+	mn_defer(vm::core_free(cpu1));
+	auto cpu2 = vm::core_new();
+	mn_defer(vm::core_free(cpu2));
+	REQUIRE(!vm::pkg_core_load(pkg, cpu1, image, 64ULL * 1024ULL));
+	REQUIRE(!vm::pkg_core_load(pkg, cpu2, image, 64ULL * 1024ULL));
+	CHECK(cpu1.rodata.ptr == cpu2.rodata.ptr);
+	CHECK(cpu1.stack.count == 64ULL * 1024ULL);
+
+	// both cores read the constant then fail on the write to it, the image stays intact
+	for (auto cpu: {&cpu1, &cpu2})
+	{
+		while (cpu->state == vm::Core::STATE_OK)
+			vm::core_ins_execute(*cpu);
+		CHECK(cpu->state == vm::Core::STATE_ERR);
+		CHECK(cpu->r[vm::Reg_R0].u8 == 't');
+	}
+	CHECK(::memcmp(image.rodata.ptr, "tethys", 6) == 0);
+}
+
+TEST_CASE("vm: unchecked ret to an overwritten address")
+{
+	auto pkg = pkg_from_str(R"""(
+	proc f
+		u64.mov [sp] 1000000
+		ret
+	end
+
+	proc main
+		call f
+		halt
+	end
+	)""");
+	mn_defer(vm::pkg_free(pkg));
+
+	// the verifier doesn't prove memory writes so the corrupt return address fails the core at the ret
+	auto cpu = vm::core_new();
+	mn_defer(vm::core_free(cpu));
+	REQUIRE(!vm::pkg_core_load(pkg, cpu, 64ULL * 1024ULL));
+	REQUIRE(cpu.verified);
+	vm::core_run(cpu);
+	CHECK(cpu.state == vm::Core::STATE_ERR);
+	CHECK(cpu.r[vm::Reg_IP].u64 < cpu.bytecode.count);
+}
+
+inline static vm::Core
+core_from_code(const mn::Buf<uint8_t>& code)
+{
+	auto cpu = vm::core_new();
+	mn::buf_push(cpu.procs, uint64_t(0));
+	for (auto b: code)
+		mn::buf_push(cpu.bytecode, b);
+	return cpu;
+}
+
+inline static bool
+code_verifies(const mn::Buf<uint8_t>& code)
+{
+	auto cpu = core_from_code(code);
+	mn_defer(vm::core_free(cpu));
+	return !vm::core_verify(cpu);
+}
+
+TEST_CASE("vm: verifier")
+{
+	using namespace vm;
+	auto code = mn::buf_new<uint8_t>();
+	mn_defer(mn::buf_free(code));
+
+	ins_push(code, Op_MOV64, op_reg(Reg_R0), op_imm<uint64_t>(1));
+	ins_push(code, Op_PUSH, op_reg(Reg_R0), op_none());
+	ins_push(code, Op_POP, op_reg(Reg_R1), op_none());
+	ins_push(code, Op_JMP8, op_imm<int8_t>(0), op_none());
+	ins_push(code, Op_HALT, op_none(), op_none());
+	CHECK(code_verifies(code));
+
+	// invalid register
+	mn::buf_clear(code);
+	ins_push(code, Op_MOV64, op_reg(Reg(20)), op_imm<uint64_t>(1));
+	ins_push(code, Op_HALT, op_none(), op_none());
+	CHECK(code_verifies(code) == false);
+
+	// immediate destination
+	mn::buf_clear(code);
+	ins_push(code, Op_MOV64, op_imm<uint64_t>(1), op_reg(Reg_R0));
+	ins_push(code, Op_HALT, op_none(), op_none());
+	CHECK(code_verifies(code) == false);
+
+	// jump into the middle of the mov
+	mn::buf_clear(code);
+	ins_push(code, Op_MOV64, op_reg(Reg_R0), op_imm<uint64_t>(1));
+	ins_push(code, Op_JMP8, op_imm<int8_t>(-5), op_none());
+	CHECK(code_verifies(code) == false);
+
+	// falls through the end of the proc
+	mn::buf_clear(code);
+	ins_push(code, Op_MOV64, op_reg(Reg_R0), op_imm<uint64_t>(1));
+	CHECK(code_verifies(code) == false);
+
+	// returns with a value still pushed on one of the paths
+	mn::buf_clear(code);
+	ins_push(code, Op_CMP64, op_reg(Reg_R0), op_imm<uint64_t>(0));
+	ins_push(code, Op_JE8, op_imm<int8_t>(3), op_none());
+	ins_push(code, Op_PUSH, op_reg(Reg_R0), op_none());
+	ins_push(code, Op_RET, op_none(), op_none());
+	CHECK(code_verifies(code) == false);
+
+	// the stack depth isn't known after sp is written
+	mn::buf_clear(code);
+	ins_push(code, Op_MOV64, op_reg(Reg_SP), op_reg(Reg_R0));
+	ins_push(code, Op_HALT, op_none(), op_none());
+	CHECK(code_verifies(code) == false);
+
+	// pops above the frame of the proc
+	mn::buf_clear(code);
+	ins_push(code, Op_POP, op_reg(Reg_R0), op_none());
+	ins_push(code, Op_HALT, op_none(), op_none());
+	CHECK(code_verifies(code) == false);
+
+	// popping into sp fails the verifier and the checked mode
+	mn::buf_clear(code);
+	ins_push(code, Op_PUSHM, op_imm<uint16_t>(1 << Reg_R0), op_none());
+	ins_push(code, Op_POPM, op_imm<uint16_t>(1 << Reg_SP), op_none());
+	ins_push(code, Op_HALT, op_none(), op_none());
+	CHECK(code_verifies(code) == false);
+	{
+		auto popm = core_from_code(code);
+		mn_defer(vm::core_free(popm));
+		mn::buf_resize(popm.stack, 64);
+		popm.r[Reg_SP].ptr = popm.stack.ptr + 64;
+		vm::core_run(popm);
+		CHECK(popm.state == vm::Core::STATE_ERR);
+		CHECK(popm.r[Reg_SP].ptr == popm.stack.ptr + 56);
+	}
+
+	// truncated immediate fails the checked mode instead of reading past the bytecode
+	mn::buf_clear(code);
+	ins_push(code, Op_MOV64, op_reg(Reg_R0), op_imm<uint64_t>(1));
+	code.count -= 4;
+	CHECK(code_verifies(code) == false);
+	auto cpu = core_from_code(code);
+	mn_defer(vm::core_free(cpu));
+	vm::core_run(cpu);
+	CHECK(cpu.state == vm::Core::STATE_ERR);
+}
+
+TEST_CASE("pkg: packages of other format versions fail to load")
+{
+	auto pkg = pkg_from_str(R"""(
+	proc main
+		halt
+	end
+	)""");
+	mn_defer(vm::pkg_free(pkg));
+
+	vm::pkg_save(pkg, "version_test.zyc");
+	auto loaded = vm::pkg_load("version_test.zyc");
+	CHECK(!loaded.err);
+	vm::pkg_free(loaded.val);
+
+	// packages written before the header start right with a section record
+	{
+		auto f = mn::file_open("version_test.zyc", mn::IO_MODE::WRITE, mn::OPEN_MODE::CREATE_OVERWRITE);
+		REQUIRE(f != nullptr);
+		uint8_t old_pkg[] = {1, 0, 0, 0, 0, 3, 0, 0, 0, 'm', 's', 'g', 0};
+		mn::stream_write(f, mn::block_from(old_pkg));
+		mn::file_close(f);
+	}
+	auto old = vm::pkg_load("version_test.zyc");
+	CHECK(old.err);
+	mn::file_remove("version_test.zyc");
+
+	CHECK(vm::pkg_load("version_test.zyc").err);
+}
+
+TEST_CASE("pkg: truncated and corrupt packages fail to load")
+{
+	auto pkg = pkg_from_str(R"""(
+	constant msg "Hello, World!\0"
+
+	proc C.puts(C.ptr) C.int32
+
+	proc main
+		u64.mov r0 msg
+		halt
+	end
+	)""");
+	mn_defer(vm::pkg_free(pkg));
+	vm::pkg_save(pkg, "corrupt_test.zyc");
+	auto bytes = mn::file_content_str("corrupt_test.zyc");
+	mn_defer(mn::str_free(bytes));
+
+	auto write_bytes = [](const char* ptr, size_t size) {
+		auto f = mn::file_open("corrupt_test.zyc", mn::IO_MODE::WRITE, mn::OPEN_MODE::CREATE_OVERWRITE);
+		REQUIRE(f != nullptr);
+		mn::stream_write(f, mn::Block{(void*)ptr, size});
+		mn::file_close(f);
+	};
+
+	// every prefix of the package misses at least the end record
+	for (size_t size = 0; size < bytes.count; ++size)
+	{
+		write_bytes(bytes.ptr, size);
+		auto loaded = vm::pkg_load("corrupt_test.zyc");
+		CHECK(loaded.err);
+	}
+
+	// the first record kind comes right after the magic and the version
+	auto corrupt = mn::str_clone(bytes);
+	mn_defer(mn::str_free(corrupt));
+	corrupt.ptr[8] = char(0x7F);
+	write_bytes(corrupt.ptr, corrupt.count);
+	auto loaded = vm::pkg_load("corrupt_test.zyc");
+	CHECK(loaded.err);
+	mn::file_remove("corrupt_test.zyc");
+
+	// relocs which would patch outside their proc or point outside their target fail to load
+	REQUIRE(pkg.relocs.count == 1);
+	auto reloc = pkg.relocs[0];
+	auto cpu = vm::core_new();
+	mn_defer(vm::core_free(cpu));
+	REQUIRE(!vm::pkg_core_load(pkg, cpu));
+
+	pkg.relocs[0].source_offset = mn::map_lookup(pkg.sections, reloc.source_name)->value.bytes.size - 2;
+	auto out_of_proc = vm::core_new();
+	mn_defer(vm::core_free(out_of_proc));
+	CHECK(vm::pkg_core_load(pkg, out_of_proc));
+
+	pkg.relocs[0] = reloc;
+	pkg.relocs[0].target_offset = 1024;
+	auto out_of_target = vm::core_new();
+	mn_defer(vm::core_free(out_of_target));
+	CHECK(vm::pkg_core_load(pkg, out_of_target));
+	pkg.relocs[0] = reloc;
+}
+
+TEST_CASE("pkg: stack bound")
+{
+	// main calls f at depth 8, f pushes 16 bytes and calls g at depth 24, g sets up a 40 bytes frame
+	auto pkg = pkg_from_str(R"""(
+	proc g
+		enter 32
+		i64.mov [fp - 8] r0
+		leave
+		ret
+	end
+
+	proc f
+		push r0 r1
+		call g
+		pop r0 r1
+		ret
+	end
+
+	proc main
+		call f
+		i32.mov r0 42
+		halt
+	end
+	)""");
+	mn_defer(vm::pkg_free(pkg));
+	CHECK(pkg.stack_size == 80);
+
+	vm::pkg_save(pkg, "stack_bound_test.zyc");
+	auto load_result = vm::pkg_load("stack_bound_test.zyc");
+	REQUIRE(!load_result.err);
+	auto loaded = load_result.val;
+	mn_defer(vm::pkg_free(loaded));
+	mn::file_remove("stack_bound_test.zyc");
+	CHECK(loaded.stack_size == 80);
+
+	auto cpu = vm::core_new();
+	mn_defer(vm::core_free(cpu));
+	REQUIRE(!vm::pkg_core_load(loaded, cpu));
+	CHECK(cpu.stack.count == 80 + cpu.frame_bound);
+	vm::core_run(cpu);
+	CHECK(cpu.state == vm::Core::STATE_HALT);
+	CHECK(cpu.r[vm::Reg_R0].i32 == 42);
+
+	// recursion has no bound so the core gets the default stack
+	auto recursive = pkg_from_str(R"""(
+	proc f
+		i32.je r0 0 done
+		i32.sub r0 1
+		call f
+	done:
+		ret
+	end
+
+	proc main
+		i32.mov r0 10
+		call f
+		halt
+	end
+	)""");
+	mn_defer(vm::pkg_free(recursive));
+	CHECK(recursive.stack_size == 0);
+
+	// running out of stack fails the core in both modes
+	for (auto verify: {false, true})
+	{
+		auto small = vm::core_new();
+		mn_defer(vm::core_free(small));
+		REQUIRE(!vm::pkg_core_load(recursive, small, 64));
+		REQUIRE(small.verified);
+		small.verified = verify;
+		vm::core_run(small);
+		CHECK(small.state == vm::Core::STATE_ERR);
+	}
+}
+
+#if VM_PROFILE
+TEST_CASE("vm: profile counters")
+{
+	auto pkg = pkg_from_str(R"""(
+	proc add
+		i64.add r0 r1
+		ret
+	end
+
+	proc main
+		i64.mov r0 0
+		i64.mov r1 1
+		i64.mov r2 10
+	loop:
+		call add
+		i64.sub r2 1
+		i64.cmp r2 0
+		jne loop
+		halt
+	end
+	)""");
+	mn_defer(vm::pkg_free(pkg));
+
+	auto cpu = vm::core_new();
+	mn_defer(vm::core_free(cpu));
+	REQUIRE(!vm::pkg_core_load(pkg, cpu));
+	vm::core_run(cpu);
+	REQUIRE(cpu.state == vm::Core::STATE_HALT);
+	CHECK(cpu.r[vm::Reg_R0].i64 == 10);
+
+	uint64_t total = 0;
+	for (auto count: cpu.profile.ops)
+		total += count;
+	CHECK(total == 3 + 10 * 6 + 1);
+	CHECK(cpu.profile.ops[vm::Op_RET] == 10);
+	CHECK(cpu.profile.ops[vm::Op_HALT] == 1);
+
+	uint64_t procs_ins[2] = {};
+	for (size_t offset = 0; offset < cpu.profile.ins.count; ++offset)
+	{
+		auto proc = vm::core_proc_at(cpu, offset);
+		REQUIRE(proc < 2);
+		procs_ins[proc] += cpu.profile.ins[offset];
+	}
+	CHECK(cpu.procs_name[0] == "add");
+	CHECK(procs_ins[0] == 10 * 2);
+	CHECK(procs_ins[1] == 3 + 10 * 4 + 1);
+	CHECK(cpu.profile.calls[cpu.procs[0]] == 10);
+	CHECK(cpu.profile.calls[cpu.procs[1]] == 0);
+}
+#endif
+
+TEST_CASE("vm: sampler unwinds the stack")
+{
+	// g sets up a frame and loops, f keeps 16 bytes on the stack while it calls g
+	auto pkg = pkg_from_str(R"""(
+	proc g
+		enter 16
+		i64.mov r2 3
+	loop:
+		i64.sub r2 1
+		i64.cmp r2 0
+		jne loop
+		leave
+		ret
+	end
+
+	proc f
+		push r0 r1
+		call g
+		pop r0 r1
+		ret
+	end
+
+	proc main
+		call f
+		halt
+	end
+	)""");
+	mn_defer(vm::pkg_free(pkg));
+
+	auto cpu = vm::core_new();
+	mn_defer(vm::core_free(cpu));
+	REQUIRE(!vm::pkg_core_load(pkg, cpu));
+	REQUIRE(cpu.verified);
+
+	auto sampler = vm::sampler_new(cpu, 1000);
+	mn_defer(vm::sampler_free(sampler));
+	CHECK(sampler.period == 1000000);
+
+	// sample before every instruction
+	while (cpu.state == vm::Core::STATE_OK)
+	{
+		vm::sampler_record(sampler, cpu);
+		vm::core_run_for(cpu, 1);
+	}
+	CHECK(cpu.state == vm::Core::STATE_HALT);
+
+	auto folded = vm::sampler_folded(sampler);
+	mn_defer(mn::str_free(folded));
+	CHECK(folded == "main 2\nmain;f 4\nmain;f;g 13\n");
+	CHECK(sampler.samples == 19);
+}
+
+TEST_CASE("pkg: debug info")
+{
+	const char* code = R"""(
+	proc add
+		i64.add r0 r1
+		ret
+	end
+
+	proc main
+		i64.mov r0 0
+		i64.mov r1 1
+		i64.mov r2 3
+	loop:
+		call add
+		i64.sub r2 1
+		i64.cmp r2 0
+		jne loop
+		halt
+	end
+	)""";
+
+	auto unit = as::src_from_str(code);
+	mn_defer(as::src_free(unit));
+	REQUIRE(as::scan(unit));
+	REQUIRE(as::parse(unit));
+	auto pkg = as::src_gen(unit, 1, true);
+	mn_defer(vm::pkg_free(pkg));
+	REQUIRE(as::src_has_err(unit) == false);
+	REQUIRE(pkg.debug.count == 2);
+
+	vm::pkg_save(pkg, "debug_info_test.zyc");
+	auto load_result = vm::pkg_load("debug_info_test.zyc");
+	REQUIRE(!load_result.err);
+	auto loaded = load_result.val;
+	mn_defer(vm::pkg_free(loaded));
+	mn::file_remove("debug_info_test.zyc");
+
+	const auto& main_debug = mn::map_lookup(loaded.debug, mn::str_lit("main"))->value;
+	CHECK(main_debug.file == "<STRING>");
+	REQUIRE(main_debug.lines.count == 8);
+	CHECK(main_debug.lines[3].line == 12);
+	CHECK(main_debug.lines[3].col == 3);
+	REQUIRE(main_debug.labels.count == 1);
+	CHECK(main_debug.labels[0].name == "loop");
+	CHECK(main_debug.labels[0].offset == main_debug.lines[3].offset);
+
+	auto cpu = vm::core_new();
+	mn_defer(vm::core_free(cpu));
+	REQUIRE(!vm::pkg_core_load(loaded, cpu));
+
+	// the sub after the call is in the middle of the loop
+	auto main_offset = cpu.procs[1];
+	auto sub_offset = main_offset + main_debug.lines[4].offset;
+	vm::Source_Location location{};
+	REQUIRE(vm::core_location_at(cpu, sub_offset, location));
+	CHECK(location.file == "<STRING>");
+	CHECK(location.line == 13);
+	CHECK(location.col == 3);
+	// the bytes of an instruction map to its line
+	REQUIRE(vm::core_location_at(cpu, sub_offset + 1, location));
+	CHECK(location.line == 13);
+	REQUIRE(vm::core_location_at(cpu, cpu.procs[0], location));
+	CHECK(location.line == 3);
+
+	auto label = vm::core_label_at(cpu, sub_offset);
+	REQUIRE(label != nullptr);
+	CHECK(label->name == "loop");
+	CHECK(vm::core_label_at(cpu, main_offset) == nullptr);
+	CHECK(vm::core_label_at(cpu, cpu.procs[0]) == nullptr);
+
+	// packages built without debug info have nothing to query
+	auto plain = pkg_from_str(code);
+	mn_defer(vm::pkg_free(plain));
+	CHECK(plain.debug.count == 0);
+	auto plain_cpu = vm::core_new();
+	mn_defer(vm::core_free(plain_cpu));
+	REQUIRE(!vm::pkg_core_load(plain, plain_cpu));
+	CHECK(vm::core_location_at(plain_cpu, plain_cpu.procs[1], location) == false);
+	CHECK(vm::core_label_at(plain_cpu, plain_cpu.procs[1]) == nullptr);
+}
+
+TEST_CASE("synth: generated programs give the same results")
+{
+	auto config = as::synth_config_default();
+	config.procs = 40;
+	config.c_procs = 8;
+
+	as::SYNTH_SHAPE shapes[] = {as::SYNTH_SHAPE_CHAIN, as::SYNTH_SHAPE_TREE, as::SYNTH_SHAPE_RANDOM};
+	for (auto shape: shapes)
+	{
+		for (uint64_t seed = 1; seed <= 3; ++seed)
+		{
+			config.shape = shape;
+			config.seed = seed;
+			auto code = as::synth_generate(config, mn::memory::tmp());
+			opt_run_str(code.ptr, as::OPT_LEVEL_2, true);
+		}
+	}
+
+	// the same config gives the same program
+	config.seed = 7;
+	CHECK(as::synth_generate(config, mn::memory::tmp()) == as::synth_generate(config, mn::memory::tmp()));
+	CHECK(gen_workers_check(as::synth_generate(config, mn::memory::tmp())) == 0);
+}
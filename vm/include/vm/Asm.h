@@ -6,10 +6,12 @@
 
 #include <mn/Buf.h>
 
+#include <string.h>
+
 namespace vm
 {
 	// EXT = 0123 4567
-	// EXT[0, 1] = addressing mode, choose from [reg, imm, mem]
+	// EXT[0, 1] = addressing mode, choose from [reg, imm, mem, mem + disp]
 	// add two extension bytes before each operand, [opcode] [dst ext] [dst] [src ext] [src]
 
 	enum ADDRESS_MODE: uint8_t
@@ -17,6 +19,8 @@ namespace vm
 		ADDRESS_MODE_REG,
 		ADDRESS_MODE_IMM,
 		ADDRESS_MODE_MEM,
+		// [reg + signed 32-bit displacement]
+		ADDRESS_MODE_MEM_DISP,
 	};
 
 	struct Ext
@@ -66,6 +70,20 @@ namespace vm
 		return ext_to_byte(e);
 	}
 
+	inline static uint8_t
+	mem_disp_ext_byte()
+	{
+		Ext e{};
+		e.address_mode = ADDRESS_MODE_MEM_DISP;
+		return ext_to_byte(e);
+	}
+
+	struct Mem_Disp
+	{
+		Reg base;
+		int32_t disp;
+	};
+
 	struct Operand
 	{
 		enum KIND
@@ -77,6 +95,7 @@ namespace vm
 			KIND_IMM32,
 			KIND_IMM64,
 			KIND_MEM,
+			KIND_MEM_DISP,
 		};
 
 		KIND kind;
@@ -88,6 +107,7 @@ namespace vm
 			uint32_t imm32;
 			uint64_t imm64;
 			Reg mem;
+			Mem_Disp mem_disp;
 		};
 	};
 
@@ -125,6 +145,16 @@ namespace vm
 			op.kind = Operand::KIND_IMM64;
 			op.imm64 = uint64_t(v);
 		}
+		else if constexpr (std::is_same_v<T, float>)
+		{
+			op.kind = Operand::KIND_IMM32;
+			::memcpy(&op.imm32, &v, sizeof(v));
+		}
+		else if constexpr (std::is_same_v<T, double>)
+		{
+			op.kind = Operand::KIND_IMM64;
+			::memcpy(&op.imm64, &v, sizeof(v));
+		}
 		else
 		{
 			static_assert(sizeof(T) == 0, "unsupported immediate type");
@@ -141,6 +171,15 @@ namespace vm
 		return op;
 	}
 
+	inline static Operand
+	op_mem_disp(Reg r, int32_t disp)
+	{
+		Operand op{};
+		op.kind = Operand::KIND_MEM_DISP;
+		op.mem_disp = Mem_Disp{ r, disp };
+		return op;
+	}
+
 	inline static Operand
 	op_none()
 	{
@@ -163,6 +202,8 @@ namespace vm
 			return imm_ext_byte();
 		case Operand::KIND_MEM:
 			return mem_ext_byte();
+		case Operand::KIND_MEM_DISP:
+			return mem_disp_ext_byte();
 		default:
 			assert(false && "unreachable");
 			return 0;
@@ -202,6 +243,11 @@ namespace vm
 			offset = code.count;
 			push8(code, op.mem);
 			break;
+		case Operand::KIND_MEM_DISP:
+			offset = code.count;
+			push8(code, op.mem_disp.base);
+			push32(code, uint32_t(op.mem_disp.disp));
+			break;
 		default:
 			assert(false && "unreachable");
 			break;
@@ -235,4 +281,17 @@ namespace vm
 		}
 		return offsets;
 	}
+
+	// pushes a three operand instruction, [opcode] [dst ext] [dst] [src ext] [src] [src2 ext] [src2]
+	inline static Ins_Op_Offsets
+	ins_push(mn::Buf<uint8_t>& code, Op opcode, Operand dst, Operand src, Operand src2)
+	{
+		auto offsets = ins_push(code, opcode, dst, src);
+		if (src2.kind != Operand::KIND_NONE)
+		{
+			push8(code, op_ext(src2));
+			op_push(code, src2);
+		}
+		return offsets;
+	}
 }
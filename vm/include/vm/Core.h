@@ -3,12 +3,32 @@
 #include "vm/Exports.h"
 #include "vm/Reg.h"
 #include "vm/C.h"
+#include "vm/Image.h"
+#include "vm/Debug.h"
 
+#include <mn/Str.h>
 #include <mn/Buf.h>
 #include <mn/Library.h>
 
 namespace vm
 {
+#if VM_PROFILE
+	// execution counters of a core, they're only compiled in with the VM_PROFILE build option so the
+	// interpreter doesn't pay anything for them otherwise
+	struct Core_Profile
+	{
+		// executions of each opcode
+		uint64_t ops[256];
+		// executions of the instruction which starts at each bytecode offset
+		mn::Buf<uint64_t> ins;
+		// calls which landed at each bytecode offset
+		mn::Buf<uint64_t> calls;
+		// calls of each c proc and the nanoseconds spent in it
+		mn::Buf<uint64_t> c_calls;
+		mn::Buf<uint64_t> c_time;
+	};
+#endif
+
 	struct Core
 	{
 		enum STATE
@@ -33,10 +53,35 @@ namespace vm
 
 		mn::Buf<uint8_t> bytecode;
 		mn::Buf<uint8_t> stack;
+		// read only data of the image the core runs, it's not owned by the core
+		mn::Block rodata;
+		// image loaded for this core alone when it's not given one to share
+		Image own_image;
+		// writes to the rodata and operands which fail to load in the checked mode end up here once the
+		// core fails
+		Reg_Val sink;
+
+		// offsets of the procs in the bytecode in ascending order and their names, filled when loading a
+		// package
+		mn::Buf<uint64_t> procs;
+		mn::Buf<mn::Str> procs_name;
+		// set by core_verify (vm/Verify.h), the deepest frame of any proc in bytes, the unchecked mode only
+		// checks there's room for it below the stack pointer on calls
+		uint64_t frame_bound;
+		// the bytecode passed verification and runs without the decoding and stack checks, it's only set by
+		// core_verify which pkg_core_load calls, clearing it forces the checked mode
+		bool verified;
 
 		mn::Buf<mn::Library> c_libraries;
 		mn::Buf<void*> c_procs_address;
 		mn::Buf<C_Proc> c_procs_desc;
+
+		// filled when loading a package which has debug info, see vm/Debug.h for the queries
+		Debug_Info debug;
+
+	#if VM_PROFILE
+		Core_Profile profile;
+	#endif
 	};
 
 	VM_EXPORT Core
@@ -51,6 +96,26 @@ namespace vm
 		core_free(self);
 	}
 
+	// executes a single instruction, unverified bytecode or a stack without room for the deepest frame is
+	// run in the checked mode
 	VM_EXPORT void
 	core_ins_execute(Core& self);
+
+	// executes instructions until the core halts or fails
+	VM_EXPORT void
+	core_run(Core& self);
+
+	// executes at most count instructions, it returns early if the core halts or fails
+	VM_EXPORT void
+	core_run_for(Core& self, uint64_t count);
+
+	// index of the proc which contains the bytecode offset, or procs.count if there's none
+	VM_EXPORT size_t
+	core_proc_at(const Core& self, uint64_t offset);
+
+#if VM_PROFILE
+	// clears the profile counters and sizes them to the loaded bytecode and c procs
+	VM_EXPORT void
+	core_profile_reset(Core& self);
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "vm/Exports.h"
+
+#include <mn/Str.h>
+#include <mn/Buf.h>
+#include <mn/File.h>
+
+namespace vm
+{
+	// source position of the instructions from the offset up to the next line entry
+	struct Debug_Line
+	{
+		uint64_t offset;
+		uint32_t line;
+		uint32_t col;
+	};
+
+	struct Debug_Label
+	{
+		mn::Str name;
+		uint64_t offset;
+	};
+
+	inline static void
+	destruct(Debug_Label& self)
+	{
+		mn::str_free(self.name);
+	}
+
+	// debug info of a single proc as it's kept in the package, offsets are relative to the proc start and
+	// the lines and labels are sorted by their offsets
+	struct Proc_Debug
+	{
+		mn::Str file;
+		mn::Buf<Debug_Line> lines;
+		mn::Buf<Debug_Label> labels;
+	};
+
+	VM_EXPORT Proc_Debug
+	proc_debug_new();
+
+	VM_EXPORT void
+	proc_debug_free(Proc_Debug& self);
+
+	inline static void
+	destruct(Proc_Debug& self)
+	{
+		proc_debug_free(self);
+	}
+
+	// the lines are delta encoded into varints so most instructions cost 3 bytes
+	VM_EXPORT void
+	proc_debug_save(const Proc_Debug& self, mn::Stream stream);
+
+	VM_EXPORT Proc_Debug
+	proc_debug_load(mn::Stream stream);
+
+	// decodes the bytes proc_debug_save writes after their length, truncated bytes decode as far as they go
+	VM_EXPORT Proc_Debug
+	proc_debug_decode(mn::Block bytes);
+
+	// debug info of the bytecode loaded into a core, offsets are bytecode offsets and everything is empty
+	// when the package has no debug info
+	struct Debug_Info
+	{
+		// source file of each proc of the core, it's empty for the procs without debug info
+		mn::Buf<mn::Str> procs_file;
+		mn::Buf<Debug_Line> lines;
+		mn::Buf<Debug_Label> labels;
+	};
+
+	VM_EXPORT Debug_Info
+	debug_info_new();
+
+	VM_EXPORT void
+	debug_info_free(Debug_Info& self);
+
+	inline static void
+	destruct(Debug_Info& self)
+	{
+		debug_info_free(self);
+	}
+
+	// source location of an instruction, the file is owned by the core debug info
+	struct Source_Location
+	{
+		mn::Str file;
+		uint32_t line;
+		uint32_t col;
+	};
+
+	struct Core;
+
+	// source location of the instruction at the bytecode offset in O(log n), returns false when its proc
+	// has no debug info
+	VM_EXPORT bool
+	core_location_at(const Core& self, uint64_t offset, Source_Location& location);
+
+	// closest label at or before the bytecode offset in the same proc in O(log n), nullptr if there's none
+	VM_EXPORT const Debug_Label*
+	core_label_at(const Core& self, uint64_t offset);
+}
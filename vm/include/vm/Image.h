@@ -0,0 +1,31 @@
+#pragma once
+
+#include "vm/Exports.h"
+
+#include <mn/Str.h>
+#include <mn/Buf.h>
+#include <mn/Map.h>
+
+namespace vm
+{
+	// program image, the read only data of a package loaded once and shared by all the cores running
+	// it, cores fail with STATE_ERR when they write to it
+	struct Image
+	{
+		mn::Buf<uint8_t> rodata;
+		// offset of each constant section in the rodata
+		mn::Map<mn::Str, uint64_t> sections;
+	};
+
+	VM_EXPORT Image
+	image_new();
+
+	VM_EXPORT void
+	image_free(Image& self);
+
+	inline static void
+	destruct(Image& self)
+	{
+		image_free(self);
+	}
+}
@@ -4,7 +4,7 @@
 
 namespace vm
 {
-	enum Op: int8_t
+	enum Op: uint8_t
 	{
 		// illegal opcode
 		Op_IGL,
@@ -51,6 +51,178 @@ namespace vm
 		Op_IDIV32,
 		Op_IDIV64,
 
+		// bitwise and
+		// AND [dst + op1] [op2]
+		Op_AND8,
+		Op_AND16,
+		Op_AND32,
+		Op_AND64,
+
+		// bitwise or
+		// OR [dst + op1] [op2]
+		Op_OR8,
+		Op_OR16,
+		Op_OR32,
+		Op_OR64,
+
+		// bitwise xor
+		// XOR [dst + op1] [op2]
+		Op_XOR8,
+		Op_XOR16,
+		Op_XOR32,
+		Op_XOR64,
+
+		// bitwise not
+		// NOT [dst + op1]
+		Op_NOT8,
+		Op_NOT16,
+		Op_NOT32,
+		Op_NOT64,
+
+		// shift left
+		// SHL [dst + op1] [op2]
+		Op_SHL8,
+		Op_SHL16,
+		Op_SHL32,
+		Op_SHL64,
+
+		// logical shift right, fills the high bits with zeros
+		// SHR [dst + op1] [op2]
+		Op_SHR8,
+		Op_SHR16,
+		Op_SHR32,
+		Op_SHR64,
+
+		// arithmetic shift right, fills the high bits with the sign bit
+		// SAR [dst + op1] [op2]
+		Op_SAR8,
+		Op_SAR16,
+		Op_SAR32,
+		Op_SAR64,
+
+		// rotate left
+		// ROL [dst + op1] [op2]
+		Op_ROL8,
+		Op_ROL16,
+		Op_ROL32,
+		Op_ROL64,
+
+		// rotate right
+		// ROR [dst + op1] [op2]
+		Op_ROR8,
+		Op_ROR16,
+		Op_ROR32,
+		Op_ROR64,
+
+		// counts the set bits in src
+		// POPCNT [dst] [src]
+		Op_POPCNT8,
+		Op_POPCNT16,
+		Op_POPCNT32,
+		Op_POPCNT64,
+
+		// counts the leading zero bits in src, returns the bit width if src is 0
+		// CLZ [dst] [src]
+		Op_CLZ8,
+		Op_CLZ16,
+		Op_CLZ32,
+		Op_CLZ64,
+
+		// counts the trailing zero bits in src, returns the bit width if src is 0
+		// CTZ [dst] [src]
+		Op_CTZ8,
+		Op_CTZ16,
+		Op_CTZ32,
+		Op_CTZ64,
+
+		// reverses the byte order of dst
+		// BSWAP [dst + op1]
+		Op_BSWAP16,
+		Op_BSWAP32,
+		Op_BSWAP64,
+
+		// float add
+		// FADD [dst + op1] [op2]
+		Op_FADD32,
+		Op_FADD64,
+
+		// float sub
+		// FSUB [dst + op1] [op2]
+		Op_FSUB32,
+		Op_FSUB64,
+
+		// float mul
+		// FMUL [dst + op1] [op2]
+		Op_FMUL32,
+		Op_FMUL64,
+
+		// float div
+		// FDIV [dst + op1] [op2]
+		Op_FDIV32,
+		Op_FDIV64,
+
+		// fused multiply add, dst += op1 * op2 with a single rounding
+		// FMA [dst] [op1] [op2]
+		Op_FMA32,
+		Op_FMA64,
+
+		// float square root
+		// FSQRT [dst] [src]
+		Op_FSQRT32,
+		Op_FSQRT64,
+
+		// float minimum
+		// FMIN [dst + op1] [op2]
+		Op_FMIN32,
+		Op_FMIN64,
+
+		// float maximum
+		// FMAX [dst + op1] [op2]
+		Op_FMAX32,
+		Op_FMAX64,
+
+		// float absolute value
+		// FABS [dst + op1]
+		Op_FABS32,
+		Op_FABS64,
+
+		// float negation
+		// FNEG [dst + op1]
+		Op_FNEG32,
+		Op_FNEG64,
+
+		// float compare, sets the compare result to CMP_NONE if any of the operands is NaN
+		// FCMP [op1] [op2]
+		Op_FCMP32,
+		Op_FCMP64,
+
+		// converts the integer src to float and stores it in dst
+		// I32_TO_F32 [dst] [src]
+		Op_I32_TO_F32,
+		Op_I64_TO_F32,
+		Op_U32_TO_F32,
+		Op_U64_TO_F32,
+		Op_I32_TO_F64,
+		Op_I64_TO_F64,
+		Op_U32_TO_F64,
+		Op_U64_TO_F64,
+
+		// converts the float src to integer rounding towards zero, out of range values saturate and NaN becomes 0
+		// F32_TO_I32 [dst] [src]
+		Op_F32_TO_I32,
+		Op_F32_TO_I64,
+		Op_F32_TO_U32,
+		Op_F32_TO_U64,
+		Op_F64_TO_I32,
+		Op_F64_TO_I64,
+		Op_F64_TO_U32,
+		Op_F64_TO_U64,
+
+		// converts between float widths
+		// F32_TO_F64 [dst] [src]
+		Op_F32_TO_F64,
+		Op_F64_TO_F32,
+
 		// unsigned compare
 		// CMP [op1] [op2]
 		Op_CMP8,
@@ -93,6 +265,100 @@ namespace vm
 		// JGE [offset 64-bit]
 		Op_JGE,
 
+		// short jumps, same as the above jumps but with a signed 8-bit offset
+		// JMP8 [offset 8-bit]
+		Op_JMP8,
+		Op_JE8,
+		Op_JNE8,
+		Op_JL8,
+		Op_JLE8,
+		Op_JG8,
+		Op_JGE8,
+
+		// near jumps, same as the above jumps but with a signed 32-bit offset
+		// JMP32 [offset 32-bit]
+		Op_JMP32,
+		Op_JE32,
+		Op_JNE32,
+		Op_JL32,
+		Op_JLE32,
+		Op_JG32,
+		Op_JGE32,
+
+		// conditional move, moves src into dst if the last compare result matches the condition
+		// CMOVE [dst] [src]
+		Op_CMOVE8,
+		Op_CMOVE16,
+		Op_CMOVE32,
+		Op_CMOVE64,
+
+		// move if not equal
+		Op_CMOVNE8,
+		Op_CMOVNE16,
+		Op_CMOVNE32,
+		Op_CMOVNE64,
+
+		// move if less than
+		Op_CMOVL8,
+		Op_CMOVL16,
+		Op_CMOVL32,
+		Op_CMOVL64,
+
+		// move if less than or equal
+		Op_CMOVLE8,
+		Op_CMOVLE16,
+		Op_CMOVLE32,
+		Op_CMOVLE64,
+
+		// move if greater than
+		Op_CMOVG8,
+		Op_CMOVG16,
+		Op_CMOVG32,
+		Op_CMOVG64,
+
+		// move if greater than or equal
+		Op_CMOVGE8,
+		Op_CMOVGE16,
+		Op_CMOVGE32,
+		Op_CMOVGE64,
+
+		// set on condition, sets dst to 1 if the last compare result matches the condition and 0 otherwise
+		// SETE [dst]
+		Op_SETE8,
+		Op_SETE16,
+		Op_SETE32,
+		Op_SETE64,
+
+		// set if not equal
+		Op_SETNE8,
+		Op_SETNE16,
+		Op_SETNE32,
+		Op_SETNE64,
+
+		// set if less than
+		Op_SETL8,
+		Op_SETL16,
+		Op_SETL32,
+		Op_SETL64,
+
+		// set if less than or equal
+		Op_SETLE8,
+		Op_SETLE16,
+		Op_SETLE32,
+		Op_SETLE64,
+
+		// set if greater than
+		Op_SETG8,
+		Op_SETG16,
+		Op_SETG32,
+		Op_SETG64,
+
+		// set if greater than or equal
+		Op_SETGE8,
+		Op_SETGE16,
+		Op_SETGE32,
+		Op_SETGE64,
+
 		// pushes the register into the stack and increment it
 		// PUSH [register]
 		Op_PUSH,
@@ -101,10 +367,33 @@ namespace vm
 		// POP [register]
 		Op_POP,
 
+		// pushes all the registers in the mask into the stack in ascending register order
+		// PUSHM [register mask unsigned 16-bit]
+		Op_PUSHM,
+
+		// pops all the registers in the mask from the stack in descending register order
+		// POPM [register mask unsigned 16-bit]
+		Op_POPM,
+
+		// sets up a stack frame, pushes FP, sets FP = SP then allocates size bytes from the stack
+		// ENTER [size unsigned 32-bit]
+		Op_ENTER,
+
+		// tears down the stack frame, sets SP = FP then pops FP
+		// LEAVE
+		Op_LEAVE,
+
 		// performs a call instruction
-		// CALL [address unsigned 64-bit]
 		Op_CALL,
 
+		// performs a call instruction with a 32-bit address
+		// CALL32 [address unsigned 32-bit]
+		Op_CALL32,
+
+		// jumps to the proc reusing the current frame and return address
+		// TAILCALL [address unsigned 32-bit]
+		Op_TAILCALL,
+
 		// returns from proc calls
 		// RET
 		Op_RET,
@@ -115,4 +404,75 @@ namespace vm
 
 		Op_HALT,
 	};
+
+	// mnemonic of the opcode, used by the profiler reports
+	inline static const char*
+	op_name(Op op)
+	{
+		static const char* NAMES[] = {
+			"igl",
+			"mov8", "mov16", "mov32", "mov64",
+			"add8", "add16", "add32", "add64",
+			"sub8", "sub16", "sub32", "sub64",
+			"mul8", "mul16", "mul32", "mul64",
+			"imul8", "imul16", "imul32", "imul64",
+			"div8", "div16", "div32", "div64",
+			"idiv8", "idiv16", "idiv32", "idiv64",
+			"and8", "and16", "and32", "and64",
+			"or8", "or16", "or32", "or64",
+			"xor8", "xor16", "xor32", "xor64",
+			"not8", "not16", "not32", "not64",
+			"shl8", "shl16", "shl32", "shl64",
+			"shr8", "shr16", "shr32", "shr64",
+			"sar8", "sar16", "sar32", "sar64",
+			"rol8", "rol16", "rol32", "rol64",
+			"ror8", "ror16", "ror32", "ror64",
+			"popcnt8", "popcnt16", "popcnt32", "popcnt64",
+			"clz8", "clz16", "clz32", "clz64",
+			"ctz8", "ctz16", "ctz32", "ctz64",
+			"bswap16", "bswap32", "bswap64",
+			"fadd32", "fadd64",
+			"fsub32", "fsub64",
+			"fmul32", "fmul64",
+			"fdiv32", "fdiv64",
+			"fma32", "fma64",
+			"fsqrt32", "fsqrt64",
+			"fmin32", "fmin64",
+			"fmax32", "fmax64",
+			"fabs32", "fabs64",
+			"fneg32", "fneg64",
+			"fcmp32", "fcmp64",
+			"i32_to_f32", "i64_to_f32", "u32_to_f32", "u64_to_f32",
+			"i32_to_f64", "i64_to_f64", "u32_to_f64", "u64_to_f64",
+			"f32_to_i32", "f32_to_i64", "f32_to_u32", "f32_to_u64",
+			"f64_to_i32", "f64_to_i64", "f64_to_u32", "f64_to_u64",
+			"f32_to_f64", "f64_to_f32",
+			"cmp8", "cmp16", "cmp32", "cmp64",
+			"icmp8", "icmp16", "icmp32", "icmp64",
+			"jmp", "je", "jne", "jl", "jle", "jg", "jge",
+			"jmp8", "je8", "jne8", "jl8", "jle8", "jg8", "jge8",
+			"jmp32", "je32", "jne32", "jl32", "jle32", "jg32", "jge32",
+			"cmove8", "cmove16", "cmove32", "cmove64",
+			"cmovne8", "cmovne16", "cmovne32", "cmovne64",
+			"cmovl8", "cmovl16", "cmovl32", "cmovl64",
+			"cmovle8", "cmovle16", "cmovle32", "cmovle64",
+			"cmovg8", "cmovg16", "cmovg32", "cmovg64",
+			"cmovge8", "cmovge16", "cmovge32", "cmovge64",
+			"sete8", "sete16", "sete32", "sete64",
+			"setne8", "setne16", "setne32", "setne64",
+			"setl8", "setl16", "setl32", "setl64",
+			"setle8", "setle16", "setle32", "setle64",
+			"setg8", "setg16", "setg32", "setg64",
+			"setge8", "setge16", "setge32", "setge64",
+			"push", "pop", "pushm", "popm",
+			"enter", "leave",
+			"call", "call32", "tailcall", "ret",
+			"c_call",
+			"halt",
+		};
+		static_assert(sizeof(NAMES) / sizeof(*NAMES) == Op_HALT + 1, "missing opcode names");
+		if (op > Op_HALT)
+			return "<invalid>";
+		return NAMES[op];
+	}
 }
\ No newline at end of file
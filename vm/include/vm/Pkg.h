@@ -2,8 +2,11 @@
 
 #include "vm/Exports.h"
 #include "vm/C.h"
+#include "vm/Image.h"
+#include "vm/Debug.h"
 
 #include <mn/Str.h>
+#include <mn/File.h>
 #include <mn/Buf.h>
 #include <mn/Map.h>
 #include <mn/Result.h>
@@ -45,12 +48,22 @@ namespace vm
 	section_load(mn::Stream stream);
 
 
+	// name of the read only data section which pools all the constants of a package, relocations to it
+	// use the target offset to address the constant inside it
+	constexpr static const char* RODATA_SECTION = ".rodata";
+	// alignment of the constant sections when loaded
+	constexpr static size_t RODATA_ALIGNMENT = 16;
+
 	// relocations is used to fix proc address on loading in call instructions
 	struct Reloc
 	{
 		mn::Str source_name;
 		mn::Str target_name;
 		uint64_t source_offset;
+		// size of the patched value in bytes, 4 for near calls and 8 for everything else
+		uint8_t width;
+		// offset added to the target address
+		uint64_t target_offset;
 	};
 
 	VM_EXPORT Reloc
@@ -72,11 +85,18 @@ namespace vm
 	reloc_load(mn::Stream stream);
 
 
+	// size of the stack the cores get when the package doesn't know its stack bound
+	constexpr static uint64_t DEFAULT_STACK_SIZE = 8ULL * 1024ULL * 1024ULL;
+
 	struct Pkg
 	{
 		mn::Map<mn::Str, Section> sections;
 		mn::Buf<Reloc> relocs;
 		mn::Buf<C_Proc> c_procs;
+		// stack size in bytes which is enough for any run of the package, 0 if it's unknown
+		uint64_t stack_size;
+		// optional debug info of the procs keyed by the proc name
+		mn::Map<mn::Str, Proc_Debug> debug;
 	};
 
 	VM_EXPORT Pkg
@@ -109,8 +129,67 @@ namespace vm
 		pkg_constant_add(self, mn::str_lit(name), bytes);
 	}
 
+	// adds the debug info of the proc, the package takes ownership of it
+	VM_EXPORT void
+	pkg_debug_add(Pkg& self, const mn::Str& proc_name, Proc_Debug debug);
+
+	VM_EXPORT void
+	pkg_reloc_add(Pkg& self, const mn::Str &source_name, uint64_t source_offset, const mn::Str &target_name, uint8_t width, uint64_t target_offset = 0);
+
+	// computes the deepest the stack can get starting from main using the call graph from the relocations
+	// and the stack pointer adjustments of each proc, the result is rounded up to 16 bytes and it's 0 when
+	// there's no bound because of recursion, indirect calls or stack adjustments it can't follow
+	VM_EXPORT uint64_t
+	pkg_stack_bound(const Pkg& self);
+
+	// call of a proc in the stack bound, the reloc at the call target immediate names the callee
+	struct Stack_Site
+	{
+		uint64_t offset;
+		// stack depth of the caller when the callee starts running
+		uint64_t depth;
+		mn::Str callee;
+	};
+
+	// stack usage of a proc, the depth is relative to the stack pointer at the proc entry and doesn't
+	// include the procs it calls
+	struct Stack_Frame
+	{
+		mn::Buf<Stack_Site> sites;
+		bool bounded;
+		uint64_t depth;
+	};
+
+	// the stack bound computed a proc at a time so it works for packages which are never held in memory,
+	// only the frame of each proc is kept
+	struct Stack_Bound
+	{
+		mn::Buf<Stack_Frame> frames;
+		mn::Map<mn::Str, size_t> procs;
+	};
+
+	VM_EXPORT Stack_Bound
+	stack_bound_new();
+
+	VM_EXPORT void
+	stack_bound_free(Stack_Bound& self);
+
+	inline static void
+	destruct(Stack_Bound& self)
+	{
+		stack_bound_free(self);
+	}
+
 	VM_EXPORT void
-	pkg_reloc_add(Pkg& self, const mn::Str &source_name, uint64_t source_offset, const mn::Str &target_name);
+	stack_bound_proc(Stack_Bound& self, const mn::Str& name, mn::Block bytes);
+
+	// relocs of a proc have to come after it
+	VM_EXPORT void
+	stack_bound_reloc(Stack_Bound& self, const mn::Str& source_name, uint64_t source_offset, const mn::Str& target_name);
+
+	// the same result as pkg_stack_bound for a package made of the given procs and relocs
+	VM_EXPORT uint64_t
+	stack_bound_compute(const Stack_Bound& self);
 
 	VM_EXPORT void
 	pkg_save(const Pkg& self, const mn::Str& filename);
@@ -121,18 +200,72 @@ namespace vm
 		pkg_save(self, mn::str_lit(filename));
 	}
 
-	VM_EXPORT Pkg
+	// loads a package saved by pkg_save or a Pkg_Writer, it fails on packages of another format version
+	VM_EXPORT mn::Result<Pkg>
 	pkg_load(const mn::Str& filename);
 
-	inline static Pkg
+	inline static mn::Result<Pkg>
 	pkg_load(const char* filename)
 	{
 		return pkg_load(mn::str_lit(filename));
 	}
 
-	// this will load the package bytecode into a cpu core
+	// streaming package writer, every section, reloc and c proc is written to the file as soon as it's
+	// added so the package is never held in memory
+	struct Pkg_Writer
+	{
+		mn::File file;
+	};
+
+	VM_EXPORT Pkg_Writer
+	pkg_writer_new(const mn::Str& filename);
+
+	inline static Pkg_Writer
+	pkg_writer_new(const char* filename)
+	{
+		return pkg_writer_new(mn::str_lit(filename));
+	}
+
+	// writes the end of the package and closes the file
+	VM_EXPORT void
+	pkg_writer_free(Pkg_Writer& self);
+
+	inline static void
+	destruct(Pkg_Writer& self)
+	{
+		pkg_writer_free(self);
+	}
+
+	VM_EXPORT void
+	pkg_writer_proc(Pkg_Writer& self, const mn::Str& name, mn::Block bytes);
+
+	VM_EXPORT void
+	pkg_writer_constant(Pkg_Writer& self, const mn::Str& name, mn::Block bytes);
+
+	VM_EXPORT void
+	pkg_writer_reloc(Pkg_Writer& self, const mn::Str& source_name, uint64_t source_offset, const mn::Str& target_name, uint8_t width, uint64_t target_offset = 0);
+
+	VM_EXPORT void
+	pkg_writer_c_proc(Pkg_Writer& self, const C_Proc& c_proc);
+
+	VM_EXPORT void
+	pkg_writer_stack_size(Pkg_Writer& self, uint64_t stack_size);
+
+	VM_EXPORT void
+	pkg_writer_debug(Pkg_Writer& self, const mn::Str& proc_name, const Proc_Debug& debug);
+
+	// loads the package constant sections into a read only image which can be shared by multiple cores
+	VM_EXPORT Image
+	pkg_image_load(const Pkg& self);
+
+	// this will load the package bytecode into a cpu core, the core gets its own image of the constants,
+	// a stack size of 0 uses the package stack size if it's known and DEFAULT_STACK_SIZE otherwise
 	struct Core;
 
 	VM_EXPORT mn::Err
-	pkg_core_load(const Pkg& self, Core& core, uint64_t stack_size_in_bytes = 8ULL * 1024ULL * 1024ULL);
+	pkg_core_load(const Pkg& self, Core& core, uint64_t stack_size_in_bytes = 0);
+
+	// same as above but the core reads the constants from the given image which must outlive it
+	VM_EXPORT mn::Err
+	pkg_core_load(const Pkg& self, Core& core, const Image& image, uint64_t stack_size_in_bytes = 0);
 }
\ No newline at end of file
@@ -22,10 +22,17 @@ namespace vm
 		// stack pointer
 		Reg_SP,
 
+		// frame pointer
+		Reg_FP,
+
 		//Count of the registers
 		Reg_COUNT
 	};
 
+	// registers which pushm and popm can save and restore, ip and sp can't be in a list since restoring
+	// them would jump or move the stack in the middle of the instruction
+	constexpr inline uint16_t REG_LIST_MASK = uint16_t(0xFF | (1 << Reg_FP));
+
 	union Reg_Val
 	{
 		int8_t   i8;
@@ -36,6 +43,8 @@ namespace vm
 		uint16_t u16;
 		uint32_t u32;
 		uint64_t u64;
+		float    f32;
+		double   f64;
 		void*	 ptr;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "vm/Exports.h"
+#include "vm/Core.h"
+
+#include <mn/Str.h>
+#include <mn/Buf.h>
+#include <mn/Map.h>
+
+namespace vm
+{
+	// where the return address of the proc is while the instruction at a bytecode offset is about to
+	// execute, it's at the given offset from the sp or the fp register
+	struct Unwind_Rule
+	{
+		enum KIND: uint8_t
+		{
+			KIND_NONE,
+			KIND_SP,
+			KIND_FP,
+		};
+
+		KIND kind;
+		int64_t offset;
+	};
+
+	// sampling profiler, it runs the core in instruction budgets and checks the clock between them, when
+	// a sample is due it records the stack of procs which is unwound through the saved return addresses
+	struct Sampler
+	{
+		// nanoseconds between samples
+		uint64_t period;
+		uint64_t samples;
+		// unwind rule of each bytecode offset of the core
+		mn::Buf<Unwind_Rule> unwind;
+		// samples of each stack in the folded format, the procs names from the outermost to the innermost
+		// separated by ';'
+		mn::Map<mn::Str, uint64_t> stacks;
+		// scratch buffers of the unwinding
+		mn::Buf<size_t> frames;
+		mn::Str folded;
+	};
+
+	// builds the unwind rules from the loaded bytecode of the core, procs whose stack depth can't be
+	// tracked end the unwound stacks at them
+	VM_EXPORT Sampler
+	sampler_new(const Core& core, uint64_t hz);
+
+	VM_EXPORT void
+	sampler_free(Sampler& self);
+
+	inline static void
+	destruct(Sampler& self)
+	{
+		sampler_free(self);
+	}
+
+	// unwinds the current stack of the core and adds weight samples to it
+	VM_EXPORT void
+	sampler_record(Sampler& self, const Core& core, uint64_t weight = 1);
+
+	// same as core_run but samples the core while it runs, time spent in c procs is counted for the stack
+	// which is sampled right after the c call returns
+	VM_EXPORT void
+	core_run_sampled(Core& self, Sampler& sampler);
+
+	// the recorded stacks in the folded format, one stack and its samples count per line, this is the input
+	// format of the flamegraph tools
+	VM_EXPORT mn::Str
+	sampler_folded(const Sampler& self, mn::Allocator allocator = mn::allocator_top());
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "vm/Exports.h"
+#include "vm/Core.h"
+
+#include <mn/Result.h>
+
+namespace vm
+{
+	// verifies the loaded bytecode of the core proc by proc, it checks the opcodes, operand encodings and
+	// register indices, that jumps land on instructions of the same proc and calls land on procs, and that
+	// the stack depth is known everywhere, agrees where paths meet and is balanced at returns, and that no
+	// proc touches the stack outside of its frame, the core has to be at the start of its entry proc, on
+	// success the core runs in the unchecked mode and on failure it keeps running in the checked mode,
+	// pkg_core_load verifies every core it loads, verified means stack safe and not memory safe since
+	// writes through memory operands aren't proven, the unchecked mode still fails on writes to the
+	// rodata and on returns outside of the bytecode but a return address overwritten with another
+	// offset inside the bytecode is trusted
+	VM_EXPORT mn::Err
+	core_verify(Core& self);
+}
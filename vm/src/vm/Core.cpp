@@ -8,32 +8,61 @@
 
 #include <ffi.h>
 
+#include <math.h>
+#include <limits>
+
+#if VM_PROFILE
+#include <chrono>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace vm
 {
-	inline static Op
-	pop_op(Core& self)
-	{
-		return Op(pop8(self.bytecode, self.r[Reg_IP].u64));
-	}
-
-	inline static Reg
-	pop_reg(Core& self)
+	// in the checked mode every fetch is bounds checked and fails the core instead of reading past the
+	// bytecode, the unchecked mode relies on core_verify having already proven the bytecode
+	template<bool CHECKED>
+	inline static bool
+	fetch_ok(Core& self, size_t size)
 	{
-		return Reg(pop8(self.bytecode, self.r[Reg_IP].u64));
+		if constexpr (CHECKED)
+		{
+			if (self.r[Reg_IP].u64 + size > self.bytecode.count)
+			{
+				self.state = Core::STATE_ERR;
+				return false;
+			}
+		}
+		return true;
 	}
 
-	inline static Ext
-	pop_ext(Core& self)
+	template<bool CHECKED>
+	inline static Op
+	pop_op(Core& self)
 	{
-		return ext_from_byte(pop8(self.bytecode, self.r[Reg_IP].u64));
+		if (fetch_ok<CHECKED>(self, 1) == false)
+			return Op_IGL;
+		return Op(pop8(self.bytecode, self.r[Reg_IP].u64));
 	}
 
-	inline static Reg_Val&
-	load_reg(Core& self)
+	template<bool CHECKED>
+	inline static bool
+	pop_reg(Core& self, Reg& r)
 	{
-		Reg i = pop_reg(self);
-		assert(i < Reg_COUNT);
-		return self.r[i];
+		if (fetch_ok<CHECKED>(self, 1) == false)
+			return false;
+		r = Reg(pop8(self.bytecode, self.r[Reg_IP].u64));
+		if constexpr (CHECKED)
+		{
+			if (r >= Reg_COUNT)
+			{
+				self.state = Core::STATE_ERR;
+				return false;
+			}
+		}
+		return true;
 	}
 
 	inline static bool
@@ -42,10 +71,23 @@ namespace vm
 		return ptr <= end(self.stack) && ptr >= begin(self.stack);
 	}
 
+	// the unchecked mode relies on core_verify having proven that procs stay in their frames so it only
+	// checks the stack at calls
+	template<bool CHECKED>
 	inline static bool
 	valid_next_bytes(Core& self, void* ptr, size_t size)
 	{
-		return valid_ptr(self, ptr) && valid_ptr(self, (uint8_t*)ptr + size);
+		if constexpr (CHECKED)
+			return valid_ptr(self, ptr) && valid_ptr(self, (uint8_t*)ptr + size);
+		else
+			return true;
+	}
+
+	// there's room for the deepest frame below the stack pointer
+	inline static bool
+	valid_frame(Core& self, void* sp)
+	{
+		return valid_ptr(self, sp) && uintptr_t(sp) - uintptr_t(self.stack.ptr) >= self.frame_bound;
 	}
 
 	inline static ffi_type*
@@ -69,6 +111,115 @@ namespace vm
 		}
 	}
 
+	template<typename T>
+	inline static T
+	bit_rotl(T v, T n)
+	{
+		constexpr T width = sizeof(T) * 8;
+		n &= width - 1;
+		if (n == 0)
+			return v;
+		return T((v << n) | (v >> (width - n)));
+	}
+
+	template<typename T>
+	inline static T
+	bit_rotr(T v, T n)
+	{
+		constexpr T width = sizeof(T) * 8;
+		n &= width - 1;
+		if (n == 0)
+			return v;
+		return T((v >> n) | (v << (width - n)));
+	}
+
+	template<typename T>
+	inline static T
+	bit_popcount(T v)
+	{
+	#if defined(_MSC_VER)
+		return T(__popcnt64(uint64_t(v)));
+	#else
+		return T(__builtin_popcountll(uint64_t(v)));
+	#endif
+	}
+
+	template<typename T>
+	inline static T
+	bit_clz(T v)
+	{
+		constexpr T width = sizeof(T) * 8;
+		if (v == 0)
+			return width;
+	#if defined(_MSC_VER)
+		unsigned long index = 0;
+		_BitScanReverse64(&index, uint64_t(v));
+		return T(width - 1 - index);
+	#else
+		return T(__builtin_clzll(uint64_t(v)) - (64 - width));
+	#endif
+	}
+
+	template<typename T>
+	inline static T
+	bit_ctz(T v)
+	{
+		constexpr T width = sizeof(T) * 8;
+		if (v == 0)
+			return width;
+	#if defined(_MSC_VER)
+		unsigned long index = 0;
+		_BitScanForward64(&index, uint64_t(v));
+		return T(index);
+	#else
+		return T(__builtin_ctzll(uint64_t(v)));
+	#endif
+	}
+
+	inline static uint16_t
+	bit_bswap(uint16_t v)
+	{
+	#if defined(_MSC_VER)
+		return _byteswap_ushort(v);
+	#else
+		return __builtin_bswap16(v);
+	#endif
+	}
+
+	inline static uint32_t
+	bit_bswap(uint32_t v)
+	{
+	#if defined(_MSC_VER)
+		return _byteswap_ulong(v);
+	#else
+		return __builtin_bswap32(v);
+	#endif
+	}
+
+	inline static uint64_t
+	bit_bswap(uint64_t v)
+	{
+	#if defined(_MSC_VER)
+		return _byteswap_uint64(v);
+	#else
+		return __builtin_bswap64(v);
+	#endif
+	}
+
+	// saturating float to integer conversion, C++ leaves out of range conversions undefined
+	template<typename TInt, typename TFloat>
+	inline static TInt
+	float_to_int(TFloat v)
+	{
+		if (v != v)
+			return 0;
+		if (v <= TFloat(std::numeric_limits<TInt>::min()))
+			return std::numeric_limits<TInt>::min();
+		if (v >= TFloat(std::numeric_limits<TInt>::max()))
+			return std::numeric_limits<TInt>::max();
+		return TInt(v);
+	}
+
 	// API
 	Core
 	core_new()
@@ -76,9 +227,18 @@ namespace vm
 		Core self{};
 		self.bytecode = mn::buf_new<uint8_t>();
 		self.stack = mn::buf_new<uint8_t>();
+		self.procs = mn::buf_new<uint64_t>();
+		self.procs_name = mn::buf_new<mn::Str>();
 		self.c_libraries = mn::buf_new<mn::Library>();
 		self.c_procs_address = mn::buf_new<void*>();
 		self.c_procs_desc = mn::buf_new<C_Proc>();
+		self.debug = debug_info_new();
+	#if VM_PROFILE
+		self.profile.ins = mn::buf_new<uint64_t>();
+		self.profile.calls = mn::buf_new<uint64_t>();
+		self.profile.c_calls = mn::buf_new<uint64_t>();
+		self.profile.c_time = mn::buf_new<uint64_t>();
+	#endif
 		return self;
 	}
 
@@ -87,33 +247,97 @@ namespace vm
 	{
 		mn::buf_free(self.bytecode);
 		mn::buf_free(self.stack);
+		image_free(self.own_image);
+		mn::buf_free(self.procs);
+		destruct(self.procs_name);
 		destruct(self.c_libraries);
 		mn::buf_free(self.c_procs_address);
 		destruct(self.c_procs_desc);
+		debug_info_free(self.debug);
+	#if VM_PROFILE
+		mn::buf_free(self.profile.ins);
+		mn::buf_free(self.profile.calls);
+		mn::buf_free(self.profile.c_calls);
+		mn::buf_free(self.profile.c_time);
+	#endif
+	}
+
+	size_t
+	core_proc_at(const Core& self, uint64_t offset)
+	{
+		// first proc which starts after the offset, the one before it contains the offset
+		size_t lo = 0, hi = self.procs.count;
+		while (lo < hi)
+		{
+			auto mid = lo + (hi - lo) / 2;
+			if (self.procs[mid] <= offset)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (lo == 0 || offset >= self.bytecode.count)
+			return self.procs.count;
+		return lo - 1;
+	}
+
+#if VM_PROFILE
+	void
+	core_profile_reset(Core& self)
+	{
+		::memset(self.profile.ops, 0, sizeof(self.profile.ops));
+		mn::buf_clear(self.profile.ins);
+		mn::buf_resize_fill(self.profile.ins, self.bytecode.count, uint64_t(0));
+		mn::buf_clear(self.profile.calls);
+		mn::buf_resize_fill(self.profile.calls, self.bytecode.count, uint64_t(0));
+		mn::buf_clear(self.profile.c_calls);
+		mn::buf_resize_fill(self.profile.c_calls, self.c_procs_desc.count, uint64_t(0));
+		mn::buf_clear(self.profile.c_time);
+		mn::buf_resize_fill(self.profile.c_time, self.c_procs_desc.count, uint64_t(0));
 	}
+#endif
 
+	template<bool CHECKED>
 	inline static uintptr_t
 	load_operand_uintptr(Core& self, size_t imm_size)
 	{
-		auto ext = pop_ext(self);
+		// failed operands point to the sink so the instruction can finish without touching any memory
+		auto sink = uintptr_t(&self.sink);
+		if (fetch_ok<CHECKED>(self, 1) == false)
+			return sink;
+		auto ext = ext_from_byte(pop8(self.bytecode, self.r[Reg_IP].u64));
 
 		uintptr_t ptr = 0;
 		switch(ext.address_mode)
 		{
 		case ADDRESS_MODE_REG:
 		{
-			auto R = Reg(pop8(self.bytecode, self.r[Reg_IP].u64));
+			Reg R{};
+			if (pop_reg<CHECKED>(self, R) == false)
+				return sink;
 			ptr = (uintptr_t)&self.r[R].u8;
 			break;
 		}
 		case ADDRESS_MODE_MEM:
 		{
-			auto R = Reg(pop8(self.bytecode, self.r[Reg_IP].u64));
+			Reg R{};
+			if (pop_reg<CHECKED>(self, R) == false)
+				return sink;
 			ptr = uintptr_t(self.r[R].ptr);
 			break;
 		}
+		case ADDRESS_MODE_MEM_DISP:
+		{
+			Reg R{};
+			if (pop_reg<CHECKED>(self, R) == false || fetch_ok<CHECKED>(self, sizeof(int32_t)) == false)
+				return sink;
+			auto disp = int32_t(pop32(self.bytecode, self.r[Reg_IP].u64));
+			ptr = uintptr_t(self.r[R].ptr) + intptr_t(disp);
+			break;
+		}
 		case ADDRESS_MODE_IMM:
 		{
+			if (fetch_ok<CHECKED>(self, imm_size) == false)
+				return sink;
 			ptr = uintptr_t(self.bytecode.ptr);
 			ptr += self.r[Reg_IP].u64;
 			self.r[Reg_IP].u64 += imm_size;
@@ -124,501 +348,1749 @@ namespace vm
 		return ptr;
 	}
 
-	template<typename T>
+	template<typename T, bool CHECKED>
 	inline static T*
 	load_operand(Core& self)
 	{
 		if constexpr (std::is_same_v<T, uint8_t>)
-			return (T*)load_operand_uintptr(self, sizeof(T));
+			return (T*)load_operand_uintptr<CHECKED>(self, sizeof(T));
 		else if constexpr (std::is_same_v<T, int8_t>)
-			return (T*)load_operand_uintptr(self, sizeof(T));
+			return (T*)load_operand_uintptr<CHECKED>(self, sizeof(T));
 		else if constexpr (std::is_same_v<T, uint16_t>)
-			return (T*)load_operand_uintptr(self, sizeof(T));
+			return (T*)load_operand_uintptr<CHECKED>(self, sizeof(T));
 		else if constexpr (std::is_same_v<T, int16_t>)
-			return (T*)load_operand_uintptr(self, sizeof(T));
+			return (T*)load_operand_uintptr<CHECKED>(self, sizeof(T));
 		else if constexpr (std::is_same_v<T, uint32_t>)
-			return (T*)load_operand_uintptr(self, sizeof(T));
+			return (T*)load_operand_uintptr<CHECKED>(self, sizeof(T));
 		else if constexpr (std::is_same_v<T, int32_t>)
-			return (T*)load_operand_uintptr(self, sizeof(T));
+			return (T*)load_operand_uintptr<CHECKED>(self, sizeof(T));
 		else if constexpr (std::is_same_v<T, uint64_t>)
-			return (T*)load_operand_uintptr(self, sizeof(T));
+			return (T*)load_operand_uintptr<CHECKED>(self, sizeof(T));
 		else if constexpr (std::is_same_v<T, int64_t>)
-			return (T*)load_operand_uintptr(self, sizeof(T));
+			return (T*)load_operand_uintptr<CHECKED>(self, sizeof(T));
+		else if constexpr (std::is_same_v<T, float>)
+			return (T*)load_operand_uintptr<CHECKED>(self, sizeof(T));
+		else if constexpr (std::is_same_v<T, double>)
+			return (T*)load_operand_uintptr<CHECKED>(self, sizeof(T));
 		else
 			static_assert(sizeof(T) == 0, "unsupported operand type");
 	}
 
-	void
-	core_ins_execute(Core& self)
+	// destination operands can't point into the rodata, writing to it fails the core and the write goes
+	// to the sink instead, the unchecked mode checks it too because the verifier doesn't prove memory
+	// writes and the rodata image is shared between cores, it's two compares and a branch which is
+	// always predicted, register destinations pay for it as well since skipping it for them costs more
+	// than it saves (see tethys_bench vm.arithmetic and vm.memory)
+	template<typename T, bool CHECKED>
+	inline static T*
+	load_dst_operand(Core& self)
+	{
+		auto ptr = (uint8_t*)load_operand<T, CHECKED>(self);
+		auto rodata = (uint8_t*)self.rodata.ptr;
+		if (ptr + sizeof(T) > rodata && ptr < rodata + self.rodata.size)
+		{
+			self.state = Core::STATE_ERR;
+			return (T*)&self.sink;
+		}
+		return (T*)ptr;
+	}
+
+	template<bool CHECKED>
+	inline static void
+	_core_ins_execute(Core& self)
 	{
-		Op op = pop_op(self);
+	#if VM_PROFILE
+		auto ins_offset = self.r[Reg_IP].u64;
+	#endif
+
+		Op op = pop_op<CHECKED>(self);
+
+	#if VM_PROFILE
+		++self.profile.ops[op];
+		if (ins_offset < self.profile.ins.count)
+			++self.profile.ins[ins_offset];
+	#endif
 
 		switch(op)
 		{
 		case Op_MOV8:
 		{
-			auto dst = load_operand<uint8_t>(self);
-			auto src = load_operand<uint8_t>(self);
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
 			*dst = *src;
 			break;
 		}
 		case Op_MOV16:
 		{
-			auto dst = load_operand<uint16_t>(self);
-			auto src = load_operand<uint16_t>(self);
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
 			*dst = *src;
 			break;
 		}
 		case Op_MOV32:
 		{
-			auto dst = load_operand<uint32_t>(self);
-			auto src = load_operand<uint32_t>(self);
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
 			*dst = *src;
 			break;
 		}
 		case Op_MOV64:
 		{
-			auto dst = load_operand<uint64_t>(self);
-			auto src = load_operand<uint64_t>(self);
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
 			*dst = *src;
 			break;
 		}
 		case Op_ADD8:
 		{
-			auto dst = load_operand<uint8_t>(self);
-			auto src = load_operand<uint8_t>(self);
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
 			*dst += *src;
 			break;
 		}
 		case Op_ADD16:
 		{
-			auto dst = load_operand<uint16_t>(self);
-			auto src = load_operand<uint16_t>(self);
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
 			*dst += *src;
 			break;
 		}
 		case Op_ADD32:
 		{
-			auto dst = load_operand<uint32_t>(self);
-			auto src = load_operand<uint32_t>(self);
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
 			*dst += *src;
 			break;
 		}
 		case Op_ADD64:
 		{
-			auto dst = load_operand<uint64_t>(self);
-			auto src = load_operand<uint64_t>(self);
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
 			*dst += *src;
 			break;
 		}
 		case Op_SUB8:
 		{
-			auto dst = load_operand<uint8_t>(self);
-			auto src = load_operand<uint8_t>(self);
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
 			*dst -= *src;
 			break;
 		}
 		case Op_SUB16:
 		{
-			auto dst = load_operand<uint16_t>(self);
-			auto src = load_operand<uint16_t>(self);
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
 			*dst -= *src;
 			break;
 		}
 		case Op_SUB32:
 		{
-			auto dst = load_operand<uint32_t>(self);
-			auto src = load_operand<uint32_t>(self);
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
 			*dst -= *src;
 			break;
 		}
 		case Op_SUB64:
 		{
-			auto dst = load_operand<uint64_t>(self);
-			auto src = load_operand<uint64_t>(self);
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
 			*dst -= *src;
 			break;
 		}
 		case Op_MUL8:
 		{
-			auto dst = load_operand<uint8_t>(self);
-			auto src = load_operand<uint8_t>(self);
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
 			*dst *= *src;
 			break;
 		}
 		case Op_MUL16:
 		{
-			auto dst = load_operand<uint16_t>(self);
-			auto src = load_operand<uint16_t>(self);
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
 			*dst *= *src;
 			break;
 		}
 		case Op_MUL32:
 		{
-			auto dst = load_operand<uint32_t>(self);
-			auto src = load_operand<uint32_t>(self);
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
 			*dst *= *src;
 			break;
 		}
 		case Op_MUL64:
 		{
-			auto dst = load_operand<uint64_t>(self);
-			auto src = load_operand<uint64_t>(self);
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
 			*dst *= *src;
 			break;
 		}
 		case Op_IMUL8:
 		{
-			auto dst = load_operand<int8_t>(self);
-			auto src = load_operand<int8_t>(self);
+			auto dst = load_dst_operand<int8_t, CHECKED>(self);
+			auto src = load_operand<int8_t, CHECKED>(self);
 			*dst *= *src;
 			break;
 		}
 		case Op_IMUL16:
 		{
-			auto dst = load_operand<int16_t>(self);
-			auto src = load_operand<int16_t>(self);
+			auto dst = load_dst_operand<int16_t, CHECKED>(self);
+			auto src = load_operand<int16_t, CHECKED>(self);
 			*dst *= *src;
 			break;
 		}
 		case Op_IMUL32:
 		{
-			auto dst = load_operand<int32_t>(self);
-			auto src = load_operand<int32_t>(self);
+			auto dst = load_dst_operand<int32_t, CHECKED>(self);
+			auto src = load_operand<int32_t, CHECKED>(self);
 			*dst *= *src;
 			break;
 		}
 		case Op_IMUL64:
 		{
-			auto dst = load_operand<int64_t>(self);
-			auto src = load_operand<int64_t>(self);
+			auto dst = load_dst_operand<int64_t, CHECKED>(self);
+			auto src = load_operand<int64_t, CHECKED>(self);
 			*dst *= *src;
 			break;
 		}
 		case Op_DIV8:
 		{
-			auto dst = load_operand<uint8_t>(self);
-			auto src = load_operand<uint8_t>(self);
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
 			*dst /= *src;
 			break;
 		}
 		case Op_DIV16:
 		{
-			auto dst = load_operand<uint16_t>(self);
-			auto src = load_operand<uint16_t>(self);
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
 			*dst /= *src;
 			break;
 		}
 		case Op_DIV32:
 		{
-			auto dst = load_operand<uint32_t>(self);
-			auto src = load_operand<uint32_t>(self);
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
 			*dst /= *src;
 			break;
 		}
 		case Op_DIV64:
 		{
-			auto dst = load_operand<uint64_t>(self);
-			auto src = load_operand<uint64_t>(self);
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
 			*dst /= *src;
 			break;
 		}
 		case Op_IDIV8:
 		{
-			auto dst = load_operand<int8_t>(self);
-			auto src = load_operand<int8_t>(self);
+			auto dst = load_dst_operand<int8_t, CHECKED>(self);
+			auto src = load_operand<int8_t, CHECKED>(self);
 			*dst /= *src;
 			break;
 		}
 		case Op_IDIV16:
 		{
-			auto dst = load_operand<int16_t>(self);
-			auto src = load_operand<int16_t>(self);
+			auto dst = load_dst_operand<int16_t, CHECKED>(self);
+			auto src = load_operand<int16_t, CHECKED>(self);
 			*dst /= *src;
 			break;
 		}
 		case Op_IDIV32:
 		{
-			auto dst = load_operand<int32_t>(self);
-			auto src = load_operand<int32_t>(self);
+			auto dst = load_dst_operand<int32_t, CHECKED>(self);
+			auto src = load_operand<int32_t, CHECKED>(self);
 			*dst /= *src;
 			break;
 		}
 		case Op_IDIV64:
 		{
-			auto dst = load_operand<int64_t>(self);
-			auto src = load_operand<int64_t>(self);
+			auto dst = load_dst_operand<int64_t, CHECKED>(self);
+			auto src = load_operand<int64_t, CHECKED>(self);
 			*dst /= *src;
 			break;
 		}
-		case Op_CMP8:
+		case Op_AND8:
 		{
-			auto op1 = load_operand<uint8_t>(self);
-			auto op2 = load_operand<uint8_t>(self);
-			if (*op1 > *op2)
-				self.cmp = Core::CMP_GREATER;
-			else if (*op1 < *op2)
-				self.cmp = Core::CMP_LESS;
-			else
-				self.cmp = Core::CMP_EQUAL;
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
+			*dst &= *src;
 			break;
 		}
-		case Op_CMP16:
+		case Op_AND16:
 		{
-			auto op1 = load_operand<uint16_t>(self);
-			auto op2 = load_operand<uint16_t>(self);
-			if (*op1 > *op2)
-				self.cmp = Core::CMP_GREATER;
-			else if (*op1 < *op2)
-				self.cmp = Core::CMP_LESS;
-			else
-				self.cmp = Core::CMP_EQUAL;
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
+			*dst &= *src;
 			break;
 		}
-		case Op_CMP32:
+		case Op_AND32:
 		{
-			auto op1 = load_operand<uint32_t>(self);
-			auto op2 = load_operand<uint32_t>(self);
-			if (*op1 > *op2)
-				self.cmp = Core::CMP_GREATER;
-			else if (*op1 < *op2)
-				self.cmp = Core::CMP_LESS;
-			else
-				self.cmp = Core::CMP_EQUAL;
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			*dst &= *src;
 			break;
 		}
-		case Op_CMP64:
+		case Op_AND64:
 		{
-			auto op1 = load_operand<uint64_t>(self);
-			auto op2 = load_operand<uint64_t>(self);
-			if (*op1 > *op2)
-				self.cmp = Core::CMP_GREATER;
-			else if (*op1 < *op2)
-				self.cmp = Core::CMP_LESS;
-			else
-				self.cmp = Core::CMP_EQUAL;
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			*dst &= *src;
 			break;
 		}
-		case Op_ICMP8:
+		case Op_OR8:
 		{
-			auto op1 = load_operand<int8_t>(self);
-			auto op2 = load_operand<int8_t>(self);
-			if (*op1 > *op2)
-				self.cmp = Core::CMP_GREATER;
-			else if (*op1 < *op2)
-				self.cmp = Core::CMP_LESS;
-			else
-				self.cmp = Core::CMP_EQUAL;
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
+			*dst |= *src;
 			break;
 		}
-		case Op_ICMP16:
+		case Op_OR16:
 		{
-			auto op1 = load_operand<int16_t>(self);
-			auto op2 = load_operand<int16_t>(self);
-			if (*op1 > *op2)
-				self.cmp = Core::CMP_GREATER;
-			else if (*op1 < *op2)
-				self.cmp = Core::CMP_LESS;
-			else
-				self.cmp = Core::CMP_EQUAL;
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
+			*dst |= *src;
 			break;
 		}
-		case Op_ICMP32:
+		case Op_OR32:
 		{
-			auto op1 = load_operand<int32_t>(self);
-			auto op2 = load_operand<int32_t>(self);
-			if (*op1 > *op2)
-				self.cmp = Core::CMP_GREATER;
-			else if (*op1 < *op2)
-				self.cmp = Core::CMP_LESS;
-			else
-				self.cmp = Core::CMP_EQUAL;
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			*dst |= *src;
 			break;
 		}
-		case Op_ICMP64:
+		case Op_OR64:
 		{
-			auto op1 = load_operand<int64_t>(self);
-			auto op2 = load_operand<int64_t>(self);
-			if (*op1 > *op2)
-				self.cmp = Core::CMP_GREATER;
-			else if (*op1 < *op2)
-				self.cmp = Core::CMP_LESS;
-			else
-				self.cmp = Core::CMP_EQUAL;
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			*dst |= *src;
 			break;
 		}
-		case Op_JMP:
+		case Op_XOR8:
 		{
-			auto offset = load_operand<uint64_t>(self);
-			self.r[Reg_IP].u64 += *offset;
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
+			*dst ^= *src;
 			break;
 		}
-		case Op_JE:
+		case Op_XOR16:
 		{
-			auto offset = load_operand<uint64_t>(self);
-			if (self.cmp == Core::CMP_EQUAL)
-				self.r[Reg_IP].u64 += *offset;
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
+			*dst ^= *src;
 			break;
 		}
-		case Op_JNE:
+		case Op_XOR32:
 		{
-			auto offset = load_operand<uint64_t>(self);
-			if (self.cmp != Core::CMP_EQUAL)
-				self.r[Reg_IP].u64 += *offset;
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			*dst ^= *src;
 			break;
 		}
-		case Op_JL:
+		case Op_XOR64:
 		{
-			auto offset = load_operand<uint64_t>(self);
-			if (self.cmp == Core::CMP_LESS)
-				self.r[Reg_IP].u64 += *offset;
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			*dst ^= *src;
 			break;
 		}
-		case Op_JLE:
+		case Op_NOT8:
 		{
-			auto offset = load_operand<uint64_t>(self);
-			if (self.cmp == Core::CMP_LESS || self.cmp == Core::CMP_EQUAL)
-				self.r[Reg_IP].u64 += *offset;
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			*dst = ~*dst;
 			break;
 		}
-		case Op_JG:
+		case Op_NOT16:
 		{
-			auto offset = load_operand<uint64_t>(self);
-			if (self.cmp == Core::CMP_GREATER)
-				self.r[Reg_IP].u64 += *offset;
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			*dst = ~*dst;
 			break;
 		}
-		case Op_JGE:
+		case Op_NOT32:
 		{
-			auto offset = load_operand<uint64_t>(self);
-			if (self.cmp == Core::CMP_GREATER || self.cmp == Core::CMP_EQUAL)
-				self.r[Reg_IP].u64 += *offset;
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			*dst = ~*dst;
 			break;
 		}
-		case Op_PUSH:
+		case Op_NOT64:
 		{
-			auto& dst = self.r[Reg_SP];
-			auto  src = load_operand<uint64_t>(self);
-			auto ptr = ((uint64_t*)dst.ptr - 1);
-			if(valid_next_bytes(self, ptr, 8) == false)
-			{
-				self.state = Core::STATE_ERR;
-				break;
-			}
-			*ptr = *src;
-			dst.ptr = ptr;
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			*dst = ~*dst;
 			break;
 		}
-		case Op_POP:
+		case Op_SHL8:
 		{
-			auto  dst = load_operand<uint64_t>(self);
-			auto& src = self.r[Reg_SP];
-			auto ptr = ((uint64_t*)src.ptr);
-			if(valid_next_bytes(self, ptr, 8) == false)
-			{
-				self.state = Core::STATE_ERR;
-				break;
-			}
-			*dst = *ptr;
-			src.ptr = ptr + 1;
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
+			*dst = uint8_t(*dst << (*src & (8 - 1)));
 			break;
 		}
-		case Op_CALL:
+		case Op_SHL16:
 		{
-			// load proc address
-			auto  address = load_operand<uint64_t>(self);
-			// load stack pointer
-			auto& SP = self.r[Reg_SP];
-			// allocate space for return address
-			auto ptr = ((uint64_t*)SP.ptr - 1);
-			if(valid_next_bytes(self, ptr, 8) == false)
-			{
-				self.state = Core::STATE_ERR;
-				break;
-			}
-			// write the return address
-			*ptr = self.r[Reg_IP].u64;
-			// move the stack pointer
-			SP.ptr = ptr;
-			// jump to proc address
-			self.r[Reg_IP].u64 = *address;
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
+			*dst = uint16_t(*dst << (*src & (16 - 1)));
 			break;
 		}
-		case Op_C_CALL:
+		case Op_SHL32:
 		{
-			// load c proc index
-			auto ix = *load_operand<uint64_t>(self);
-			if(ix >= self.c_procs_desc.count)
-			{
-				self.state = Core::STATE_ERR;
-				break;
-			}
-			auto& cproc = self.c_procs_desc[ix];
-			auto cproc_ptr= self.c_procs_address[ix];
-			
-			ffi_cif cif;
-			auto arg_types = mn::buf_with_count<ffi_type*>(cproc.arg_types.count);
-			auto arg_values = mn::buf_with_count<void*>(cproc.arg_types.count);
-			auto ret_type = ffi_type_from_c(cproc.ret);
-			ffi_arg ret_value;
-			mn_defer({
-				mn::buf_free(arg_types);
-				mn::buf_free(arg_values);
-			});
-
-			char* it = (char*)self.r[Reg_SP].ptr;
-
-			// get return value address from the stack
-			if(valid_next_bytes(self, it, ret_type->size) == false)
-			{
-				self.state = Core::STATE_ERR;
-				break;
-			}
-			it += ret_type->size;
-
-			// get args from the stack
-			for(size_t i = 0; i < cproc.arg_types.count; ++i)
-			{
-				auto ffi_arg_type = ffi_type_from_c(cproc.arg_types[i]);
-				if(valid_next_bytes(self, it, ffi_arg_type->size) == false)
-				{
-					self.state = Core::STATE_ERR;
-					break;
-				}
-				arg_types[i] = ffi_arg_type;
-				arg_values[i] = it;
-				it += ffi_arg_type->size;
-			}
-
-			// exit if there's an error
-			if (self.state == Core::STATE_ERR)
-				break;
-
-			auto res = ffi_prep_cif(&cif, FFI_DEFAULT_ABI, uint32_t(cproc.arg_types.count), ret_type, arg_types.ptr);
-			if(res != FFI_OK)
-			{
-				self.state = Core::STATE_ERR;
-				break;
-			}
-			ffi_call(&cif, FFI_FN(cproc_ptr), &ret_value, arg_values.ptr);
-			// write c proc name for now
-			mn::print("C CALL: {}.{} @ {}\n", cproc.lib, cproc.name, self.c_procs_address[ix]);
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			*dst = uint32_t(*dst << (*src & (32 - 1)));
 			break;
 		}
-		case Op_RET:
+		case Op_SHL64:
 		{
-			// load stack pointer
-			auto& SP = self.r[Reg_SP];
-			auto ptr = ((uint64_t*)SP.ptr);
-			if(valid_next_bytes(self, ptr, 8) == false)
-			{
-				self.state = Core::STATE_ERR;
-				break;
-			}
-			// restore the IP
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			*dst = uint64_t(*dst << (*src & (64 - 1)));
+			break;
+		}
+		case Op_SHR8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
+			*dst = uint8_t(*dst >> (*src & (8 - 1)));
+			break;
+		}
+		case Op_SHR16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
+			*dst = uint16_t(*dst >> (*src & (16 - 1)));
+			break;
+		}
+		case Op_SHR32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			*dst = uint32_t(*dst >> (*src & (32 - 1)));
+			break;
+		}
+		case Op_SHR64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			*dst = uint64_t(*dst >> (*src & (64 - 1)));
+			break;
+		}
+		case Op_SAR8:
+		{
+			auto dst = load_dst_operand<int8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
+			*dst = int8_t(*dst >> (*src & (8 - 1)));
+			break;
+		}
+		case Op_SAR16:
+		{
+			auto dst = load_dst_operand<int16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
+			*dst = int16_t(*dst >> (*src & (16 - 1)));
+			break;
+		}
+		case Op_SAR32:
+		{
+			auto dst = load_dst_operand<int32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			*dst = int32_t(*dst >> (*src & (32 - 1)));
+			break;
+		}
+		case Op_SAR64:
+		{
+			auto dst = load_dst_operand<int64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			*dst = int64_t(*dst >> (*src & (64 - 1)));
+			break;
+		}
+		case Op_ROL8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
+			*dst = bit_rotl(*dst, *src);
+			break;
+		}
+		case Op_ROL16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
+			*dst = bit_rotl(*dst, *src);
+			break;
+		}
+		case Op_ROL32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			*dst = bit_rotl(*dst, *src);
+			break;
+		}
+		case Op_ROL64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			*dst = bit_rotl(*dst, *src);
+			break;
+		}
+		case Op_ROR8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
+			*dst = bit_rotr(*dst, *src);
+			break;
+		}
+		case Op_ROR16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
+			*dst = bit_rotr(*dst, *src);
+			break;
+		}
+		case Op_ROR32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			*dst = bit_rotr(*dst, *src);
+			break;
+		}
+		case Op_ROR64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			*dst = bit_rotr(*dst, *src);
+			break;
+		}
+		case Op_POPCNT8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
+			*dst = bit_popcount(*src);
+			break;
+		}
+		case Op_POPCNT16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
+			*dst = bit_popcount(*src);
+			break;
+		}
+		case Op_POPCNT32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			*dst = bit_popcount(*src);
+			break;
+		}
+		case Op_POPCNT64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			*dst = bit_popcount(*src);
+			break;
+		}
+		case Op_CLZ8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
+			*dst = bit_clz(*src);
+			break;
+		}
+		case Op_CLZ16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
+			*dst = bit_clz(*src);
+			break;
+		}
+		case Op_CLZ32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			*dst = bit_clz(*src);
+			break;
+		}
+		case Op_CLZ64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			*dst = bit_clz(*src);
+			break;
+		}
+		case Op_CTZ8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
+			*dst = bit_ctz(*src);
+			break;
+		}
+		case Op_CTZ16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
+			*dst = bit_ctz(*src);
+			break;
+		}
+		case Op_CTZ32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			*dst = bit_ctz(*src);
+			break;
+		}
+		case Op_CTZ64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			*dst = bit_ctz(*src);
+			break;
+		}
+		case Op_BSWAP16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			*dst = bit_bswap(*dst);
+			break;
+		}
+		case Op_BSWAP32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			*dst = bit_bswap(*dst);
+			break;
+		}
+		case Op_BSWAP64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			*dst = bit_bswap(*dst);
+			break;
+		}
+		case Op_FADD32:
+		{
+			auto dst = load_dst_operand<float, CHECKED>(self);
+			auto src = load_operand<float, CHECKED>(self);
+			*dst += *src;
+			break;
+		}
+		case Op_FADD64:
+		{
+			auto dst = load_dst_operand<double, CHECKED>(self);
+			auto src = load_operand<double, CHECKED>(self);
+			*dst += *src;
+			break;
+		}
+		case Op_FSUB32:
+		{
+			auto dst = load_dst_operand<float, CHECKED>(self);
+			auto src = load_operand<float, CHECKED>(self);
+			*dst -= *src;
+			break;
+		}
+		case Op_FSUB64:
+		{
+			auto dst = load_dst_operand<double, CHECKED>(self);
+			auto src = load_operand<double, CHECKED>(self);
+			*dst -= *src;
+			break;
+		}
+		case Op_FMUL32:
+		{
+			auto dst = load_dst_operand<float, CHECKED>(self);
+			auto src = load_operand<float, CHECKED>(self);
+			*dst *= *src;
+			break;
+		}
+		case Op_FMUL64:
+		{
+			auto dst = load_dst_operand<double, CHECKED>(self);
+			auto src = load_operand<double, CHECKED>(self);
+			*dst *= *src;
+			break;
+		}
+		case Op_FDIV32:
+		{
+			auto dst = load_dst_operand<float, CHECKED>(self);
+			auto src = load_operand<float, CHECKED>(self);
+			*dst /= *src;
+			break;
+		}
+		case Op_FDIV64:
+		{
+			auto dst = load_dst_operand<double, CHECKED>(self);
+			auto src = load_operand<double, CHECKED>(self);
+			*dst /= *src;
+			break;
+		}
+		case Op_FMA32:
+		{
+			auto dst = load_dst_operand<float, CHECKED>(self);
+			auto op1 = load_operand<float, CHECKED>(self);
+			auto op2 = load_operand<float, CHECKED>(self);
+			*dst = fmaf(*op1, *op2, *dst);
+			break;
+		}
+		case Op_FMA64:
+		{
+			auto dst = load_dst_operand<double, CHECKED>(self);
+			auto op1 = load_operand<double, CHECKED>(self);
+			auto op2 = load_operand<double, CHECKED>(self);
+			*dst = fma(*op1, *op2, *dst);
+			break;
+		}
+		case Op_FSQRT32:
+		{
+			auto dst = load_dst_operand<float, CHECKED>(self);
+			auto src = load_operand<float, CHECKED>(self);
+			*dst = sqrtf(*src);
+			break;
+		}
+		case Op_FSQRT64:
+		{
+			auto dst = load_dst_operand<double, CHECKED>(self);
+			auto src = load_operand<double, CHECKED>(self);
+			*dst = sqrt(*src);
+			break;
+		}
+		case Op_FMIN32:
+		{
+			auto dst = load_dst_operand<float, CHECKED>(self);
+			auto src = load_operand<float, CHECKED>(self);
+			*dst = fminf(*dst, *src);
+			break;
+		}
+		case Op_FMIN64:
+		{
+			auto dst = load_dst_operand<double, CHECKED>(self);
+			auto src = load_operand<double, CHECKED>(self);
+			*dst = fmin(*dst, *src);
+			break;
+		}
+		case Op_FMAX32:
+		{
+			auto dst = load_dst_operand<float, CHECKED>(self);
+			auto src = load_operand<float, CHECKED>(self);
+			*dst = fmaxf(*dst, *src);
+			break;
+		}
+		case Op_FMAX64:
+		{
+			auto dst = load_dst_operand<double, CHECKED>(self);
+			auto src = load_operand<double, CHECKED>(self);
+			*dst = fmax(*dst, *src);
+			break;
+		}
+		case Op_FABS32:
+		{
+			auto dst = load_dst_operand<float, CHECKED>(self);
+			*dst = fabsf(*dst);
+			break;
+		}
+		case Op_FABS64:
+		{
+			auto dst = load_dst_operand<double, CHECKED>(self);
+			*dst = fabs(*dst);
+			break;
+		}
+		case Op_FNEG32:
+		{
+			auto dst = load_dst_operand<float, CHECKED>(self);
+			*dst = -*dst;
+			break;
+		}
+		case Op_FNEG64:
+		{
+			auto dst = load_dst_operand<double, CHECKED>(self);
+			*dst = -*dst;
+			break;
+		}
+		case Op_FCMP32:
+		{
+			auto op1 = load_operand<float, CHECKED>(self);
+			auto op2 = load_operand<float, CHECKED>(self);
+			if (*op1 > *op2)
+				self.cmp = Core::CMP_GREATER;
+			else if (*op1 < *op2)
+				self.cmp = Core::CMP_LESS;
+			else if (*op1 == *op2)
+				self.cmp = Core::CMP_EQUAL;
+			else
+				self.cmp = Core::CMP_NONE;
+			break;
+		}
+		case Op_FCMP64:
+		{
+			auto op1 = load_operand<double, CHECKED>(self);
+			auto op2 = load_operand<double, CHECKED>(self);
+			if (*op1 > *op2)
+				self.cmp = Core::CMP_GREATER;
+			else if (*op1 < *op2)
+				self.cmp = Core::CMP_LESS;
+			else if (*op1 == *op2)
+				self.cmp = Core::CMP_EQUAL;
+			else
+				self.cmp = Core::CMP_NONE;
+			break;
+		}
+		case Op_I32_TO_F32:
+		{
+			auto dst = load_dst_operand<float, CHECKED>(self);
+			auto src = load_operand<int32_t, CHECKED>(self);
+			*dst = float(*src);
+			break;
+		}
+		case Op_I64_TO_F32:
+		{
+			auto dst = load_dst_operand<float, CHECKED>(self);
+			auto src = load_operand<int64_t, CHECKED>(self);
+			*dst = float(*src);
+			break;
+		}
+		case Op_U32_TO_F32:
+		{
+			auto dst = load_dst_operand<float, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			*dst = float(*src);
+			break;
+		}
+		case Op_U64_TO_F32:
+		{
+			auto dst = load_dst_operand<float, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			*dst = float(*src);
+			break;
+		}
+		case Op_I32_TO_F64:
+		{
+			auto dst = load_dst_operand<double, CHECKED>(self);
+			auto src = load_operand<int32_t, CHECKED>(self);
+			*dst = double(*src);
+			break;
+		}
+		case Op_I64_TO_F64:
+		{
+			auto dst = load_dst_operand<double, CHECKED>(self);
+			auto src = load_operand<int64_t, CHECKED>(self);
+			*dst = double(*src);
+			break;
+		}
+		case Op_U32_TO_F64:
+		{
+			auto dst = load_dst_operand<double, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			*dst = double(*src);
+			break;
+		}
+		case Op_U64_TO_F64:
+		{
+			auto dst = load_dst_operand<double, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			*dst = double(*src);
+			break;
+		}
+		case Op_F32_TO_I32:
+		{
+			auto dst = load_dst_operand<int32_t, CHECKED>(self);
+			auto src = load_operand<float, CHECKED>(self);
+			*dst = float_to_int<int32_t>(*src);
+			break;
+		}
+		case Op_F32_TO_I64:
+		{
+			auto dst = load_dst_operand<int64_t, CHECKED>(self);
+			auto src = load_operand<float, CHECKED>(self);
+			*dst = float_to_int<int64_t>(*src);
+			break;
+		}
+		case Op_F32_TO_U32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<float, CHECKED>(self);
+			*dst = float_to_int<uint32_t>(*src);
+			break;
+		}
+		case Op_F32_TO_U64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<float, CHECKED>(self);
+			*dst = float_to_int<uint64_t>(*src);
+			break;
+		}
+		case Op_F64_TO_I32:
+		{
+			auto dst = load_dst_operand<int32_t, CHECKED>(self);
+			auto src = load_operand<double, CHECKED>(self);
+			*dst = float_to_int<int32_t>(*src);
+			break;
+		}
+		case Op_F64_TO_I64:
+		{
+			auto dst = load_dst_operand<int64_t, CHECKED>(self);
+			auto src = load_operand<double, CHECKED>(self);
+			*dst = float_to_int<int64_t>(*src);
+			break;
+		}
+		case Op_F64_TO_U32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<double, CHECKED>(self);
+			*dst = float_to_int<uint32_t>(*src);
+			break;
+		}
+		case Op_F64_TO_U64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<double, CHECKED>(self);
+			*dst = float_to_int<uint64_t>(*src);
+			break;
+		}
+		case Op_F32_TO_F64:
+		{
+			auto dst = load_dst_operand<double, CHECKED>(self);
+			auto src = load_operand<float, CHECKED>(self);
+			*dst = double(*src);
+			break;
+		}
+		case Op_F64_TO_F32:
+		{
+			auto dst = load_dst_operand<float, CHECKED>(self);
+			auto src = load_operand<double, CHECKED>(self);
+			*dst = float(*src);
+			break;
+		}
+		case Op_CMP8:
+		{
+			auto op1 = load_operand<uint8_t, CHECKED>(self);
+			auto op2 = load_operand<uint8_t, CHECKED>(self);
+			if (*op1 > *op2)
+				self.cmp = Core::CMP_GREATER;
+			else if (*op1 < *op2)
+				self.cmp = Core::CMP_LESS;
+			else
+				self.cmp = Core::CMP_EQUAL;
+			break;
+		}
+		case Op_CMP16:
+		{
+			auto op1 = load_operand<uint16_t, CHECKED>(self);
+			auto op2 = load_operand<uint16_t, CHECKED>(self);
+			if (*op1 > *op2)
+				self.cmp = Core::CMP_GREATER;
+			else if (*op1 < *op2)
+				self.cmp = Core::CMP_LESS;
+			else
+				self.cmp = Core::CMP_EQUAL;
+			break;
+		}
+		case Op_CMP32:
+		{
+			auto op1 = load_operand<uint32_t, CHECKED>(self);
+			auto op2 = load_operand<uint32_t, CHECKED>(self);
+			if (*op1 > *op2)
+				self.cmp = Core::CMP_GREATER;
+			else if (*op1 < *op2)
+				self.cmp = Core::CMP_LESS;
+			else
+				self.cmp = Core::CMP_EQUAL;
+			break;
+		}
+		case Op_CMP64:
+		{
+			auto op1 = load_operand<uint64_t, CHECKED>(self);
+			auto op2 = load_operand<uint64_t, CHECKED>(self);
+			if (*op1 > *op2)
+				self.cmp = Core::CMP_GREATER;
+			else if (*op1 < *op2)
+				self.cmp = Core::CMP_LESS;
+			else
+				self.cmp = Core::CMP_EQUAL;
+			break;
+		}
+		case Op_ICMP8:
+		{
+			auto op1 = load_operand<int8_t, CHECKED>(self);
+			auto op2 = load_operand<int8_t, CHECKED>(self);
+			if (*op1 > *op2)
+				self.cmp = Core::CMP_GREATER;
+			else if (*op1 < *op2)
+				self.cmp = Core::CMP_LESS;
+			else
+				self.cmp = Core::CMP_EQUAL;
+			break;
+		}
+		case Op_ICMP16:
+		{
+			auto op1 = load_operand<int16_t, CHECKED>(self);
+			auto op2 = load_operand<int16_t, CHECKED>(self);
+			if (*op1 > *op2)
+				self.cmp = Core::CMP_GREATER;
+			else if (*op1 < *op2)
+				self.cmp = Core::CMP_LESS;
+			else
+				self.cmp = Core::CMP_EQUAL;
+			break;
+		}
+		case Op_ICMP32:
+		{
+			auto op1 = load_operand<int32_t, CHECKED>(self);
+			auto op2 = load_operand<int32_t, CHECKED>(self);
+			if (*op1 > *op2)
+				self.cmp = Core::CMP_GREATER;
+			else if (*op1 < *op2)
+				self.cmp = Core::CMP_LESS;
+			else
+				self.cmp = Core::CMP_EQUAL;
+			break;
+		}
+		case Op_ICMP64:
+		{
+			auto op1 = load_operand<int64_t, CHECKED>(self);
+			auto op2 = load_operand<int64_t, CHECKED>(self);
+			if (*op1 > *op2)
+				self.cmp = Core::CMP_GREATER;
+			else if (*op1 < *op2)
+				self.cmp = Core::CMP_LESS;
+			else
+				self.cmp = Core::CMP_EQUAL;
+			break;
+		}
+		case Op_JMP:
+		{
+			auto offset = load_operand<uint64_t, CHECKED>(self);
+			self.r[Reg_IP].u64 += *offset;
+			break;
+		}
+		case Op_JE:
+		{
+			auto offset = load_operand<uint64_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_EQUAL)
+				self.r[Reg_IP].u64 += *offset;
+			break;
+		}
+		case Op_JNE:
+		{
+			auto offset = load_operand<uint64_t, CHECKED>(self);
+			if (self.cmp != Core::CMP_EQUAL)
+				self.r[Reg_IP].u64 += *offset;
+			break;
+		}
+		case Op_JL:
+		{
+			auto offset = load_operand<uint64_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_LESS)
+				self.r[Reg_IP].u64 += *offset;
+			break;
+		}
+		case Op_JLE:
+		{
+			auto offset = load_operand<uint64_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_LESS || self.cmp == Core::CMP_EQUAL)
+				self.r[Reg_IP].u64 += *offset;
+			break;
+		}
+		case Op_JG:
+		{
+			auto offset = load_operand<uint64_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_GREATER)
+				self.r[Reg_IP].u64 += *offset;
+			break;
+		}
+		case Op_JGE:
+		{
+			auto offset = load_operand<uint64_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_GREATER || self.cmp == Core::CMP_EQUAL)
+				self.r[Reg_IP].u64 += *offset;
+			break;
+		}
+		case Op_JMP8:
+		{
+			auto offset = load_operand<int8_t, CHECKED>(self);
+			self.r[Reg_IP].u64 += int64_t(*offset);
+			break;
+		}
+		case Op_JE8:
+		{
+			auto offset = load_operand<int8_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_EQUAL)
+				self.r[Reg_IP].u64 += int64_t(*offset);
+			break;
+		}
+		case Op_JNE8:
+		{
+			auto offset = load_operand<int8_t, CHECKED>(self);
+			if (self.cmp != Core::CMP_EQUAL)
+				self.r[Reg_IP].u64 += int64_t(*offset);
+			break;
+		}
+		case Op_JL8:
+		{
+			auto offset = load_operand<int8_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_LESS)
+				self.r[Reg_IP].u64 += int64_t(*offset);
+			break;
+		}
+		case Op_JLE8:
+		{
+			auto offset = load_operand<int8_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_LESS || self.cmp == Core::CMP_EQUAL)
+				self.r[Reg_IP].u64 += int64_t(*offset);
+			break;
+		}
+		case Op_JG8:
+		{
+			auto offset = load_operand<int8_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_GREATER)
+				self.r[Reg_IP].u64 += int64_t(*offset);
+			break;
+		}
+		case Op_JGE8:
+		{
+			auto offset = load_operand<int8_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_GREATER || self.cmp == Core::CMP_EQUAL)
+				self.r[Reg_IP].u64 += int64_t(*offset);
+			break;
+		}
+		case Op_JMP32:
+		{
+			auto offset = load_operand<int32_t, CHECKED>(self);
+			self.r[Reg_IP].u64 += int64_t(*offset);
+			break;
+		}
+		case Op_JE32:
+		{
+			auto offset = load_operand<int32_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_EQUAL)
+				self.r[Reg_IP].u64 += int64_t(*offset);
+			break;
+		}
+		case Op_JNE32:
+		{
+			auto offset = load_operand<int32_t, CHECKED>(self);
+			if (self.cmp != Core::CMP_EQUAL)
+				self.r[Reg_IP].u64 += int64_t(*offset);
+			break;
+		}
+		case Op_JL32:
+		{
+			auto offset = load_operand<int32_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_LESS)
+				self.r[Reg_IP].u64 += int64_t(*offset);
+			break;
+		}
+		case Op_JLE32:
+		{
+			auto offset = load_operand<int32_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_LESS || self.cmp == Core::CMP_EQUAL)
+				self.r[Reg_IP].u64 += int64_t(*offset);
+			break;
+		}
+		case Op_JG32:
+		{
+			auto offset = load_operand<int32_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_GREATER)
+				self.r[Reg_IP].u64 += int64_t(*offset);
+			break;
+		}
+		case Op_JGE32:
+		{
+			auto offset = load_operand<int32_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_GREATER || self.cmp == Core::CMP_EQUAL)
+				self.r[Reg_IP].u64 += int64_t(*offset);
+			break;
+		}
+		case Op_CMOVE8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_EQUAL)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVE16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_EQUAL)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVE32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_EQUAL)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVE64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_EQUAL)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVNE8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
+			if (self.cmp != Core::CMP_EQUAL)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVNE16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
+			if (self.cmp != Core::CMP_EQUAL)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVNE32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			if (self.cmp != Core::CMP_EQUAL)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVNE64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			if (self.cmp != Core::CMP_EQUAL)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVL8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_LESS)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVL16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_LESS)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVL32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_LESS)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVL64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_LESS)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVLE8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_LESS || self.cmp == Core::CMP_EQUAL)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVLE16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_LESS || self.cmp == Core::CMP_EQUAL)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVLE32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_LESS || self.cmp == Core::CMP_EQUAL)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVLE64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_LESS || self.cmp == Core::CMP_EQUAL)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVG8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_GREATER)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVG16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_GREATER)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVG32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_GREATER)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVG64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_GREATER)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVGE8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			auto src = load_operand<uint8_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_GREATER || self.cmp == Core::CMP_EQUAL)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVGE16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			auto src = load_operand<uint16_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_GREATER || self.cmp == Core::CMP_EQUAL)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVGE32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			auto src = load_operand<uint32_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_GREATER || self.cmp == Core::CMP_EQUAL)
+				*dst = *src;
+			break;
+		}
+		case Op_CMOVGE64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto src = load_operand<uint64_t, CHECKED>(self);
+			if (self.cmp == Core::CMP_GREATER || self.cmp == Core::CMP_EQUAL)
+				*dst = *src;
+			break;
+		}
+		case Op_SETE8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_EQUAL) ? 1 : 0;
+			break;
+		}
+		case Op_SETE16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_EQUAL) ? 1 : 0;
+			break;
+		}
+		case Op_SETE32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_EQUAL) ? 1 : 0;
+			break;
+		}
+		case Op_SETE64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_EQUAL) ? 1 : 0;
+			break;
+		}
+		case Op_SETNE8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			*dst = (self.cmp != Core::CMP_EQUAL) ? 1 : 0;
+			break;
+		}
+		case Op_SETNE16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			*dst = (self.cmp != Core::CMP_EQUAL) ? 1 : 0;
+			break;
+		}
+		case Op_SETNE32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			*dst = (self.cmp != Core::CMP_EQUAL) ? 1 : 0;
+			break;
+		}
+		case Op_SETNE64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			*dst = (self.cmp != Core::CMP_EQUAL) ? 1 : 0;
+			break;
+		}
+		case Op_SETL8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_LESS) ? 1 : 0;
+			break;
+		}
+		case Op_SETL16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_LESS) ? 1 : 0;
+			break;
+		}
+		case Op_SETL32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_LESS) ? 1 : 0;
+			break;
+		}
+		case Op_SETL64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_LESS) ? 1 : 0;
+			break;
+		}
+		case Op_SETLE8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_LESS || self.cmp == Core::CMP_EQUAL) ? 1 : 0;
+			break;
+		}
+		case Op_SETLE16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_LESS || self.cmp == Core::CMP_EQUAL) ? 1 : 0;
+			break;
+		}
+		case Op_SETLE32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_LESS || self.cmp == Core::CMP_EQUAL) ? 1 : 0;
+			break;
+		}
+		case Op_SETLE64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_LESS || self.cmp == Core::CMP_EQUAL) ? 1 : 0;
+			break;
+		}
+		case Op_SETG8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_GREATER) ? 1 : 0;
+			break;
+		}
+		case Op_SETG16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_GREATER) ? 1 : 0;
+			break;
+		}
+		case Op_SETG32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_GREATER) ? 1 : 0;
+			break;
+		}
+		case Op_SETG64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_GREATER) ? 1 : 0;
+			break;
+		}
+		case Op_SETGE8:
+		{
+			auto dst = load_dst_operand<uint8_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_GREATER || self.cmp == Core::CMP_EQUAL) ? 1 : 0;
+			break;
+		}
+		case Op_SETGE16:
+		{
+			auto dst = load_dst_operand<uint16_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_GREATER || self.cmp == Core::CMP_EQUAL) ? 1 : 0;
+			break;
+		}
+		case Op_SETGE32:
+		{
+			auto dst = load_dst_operand<uint32_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_GREATER || self.cmp == Core::CMP_EQUAL) ? 1 : 0;
+			break;
+		}
+		case Op_SETGE64:
+		{
+			auto dst = load_dst_operand<uint64_t, CHECKED>(self);
+			*dst = (self.cmp == Core::CMP_GREATER || self.cmp == Core::CMP_EQUAL) ? 1 : 0;
+			break;
+		}
+		case Op_PUSH:
+		{
+			auto& dst = self.r[Reg_SP];
+			auto  src = load_operand<uint64_t, CHECKED>(self);
+			auto ptr = ((uint64_t*)dst.ptr - 1);
+			if(valid_next_bytes<CHECKED>(self, ptr, 8) == false)
+			{
+				self.state = Core::STATE_ERR;
+				break;
+			}
+			*ptr = *src;
+			dst.ptr = ptr;
+			break;
+		}
+		case Op_POP:
+		{
+			auto  dst = load_dst_operand<uint64_t, CHECKED>(self);
+			auto& src = self.r[Reg_SP];
+			auto ptr = ((uint64_t*)src.ptr);
+			if(valid_next_bytes<CHECKED>(self, ptr, 8) == false)
+			{
+				self.state = Core::STATE_ERR;
+				break;
+			}
+			*dst = *ptr;
+			src.ptr = ptr + 1;
+			break;
+		}
+		case Op_PUSHM:
+		{
+			auto mask = *load_operand<uint16_t, CHECKED>(self);
+			if(CHECKED && (mask & ~REG_LIST_MASK))
+			{
+				self.state = Core::STATE_ERR;
+				break;
+			}
+			auto& SP = self.r[Reg_SP];
+			for(uint8_t i = 0; i < Reg_COUNT; ++i)
+			{
+				if((mask & (1 << i)) == 0)
+					continue;
+
+				auto ptr = ((uint64_t*)SP.ptr - 1);
+				if(valid_next_bytes<CHECKED>(self, ptr, 8) == false)
+				{
+					self.state = Core::STATE_ERR;
+					break;
+				}
+				*ptr = self.r[i].u64;
+				SP.ptr = ptr;
+			}
+			break;
+		}
+		case Op_POPM:
+		{
+			auto mask = *load_operand<uint16_t, CHECKED>(self);
+			if(CHECKED && (mask & ~REG_LIST_MASK))
+			{
+				self.state = Core::STATE_ERR;
+				break;
+			}
+			auto& SP = self.r[Reg_SP];
+			for(uint8_t i = Reg_COUNT; i > 0; --i)
+			{
+				if((mask & (1 << (i - 1))) == 0)
+					continue;
+
+				auto ptr = ((uint64_t*)SP.ptr);
+				if(valid_next_bytes<CHECKED>(self, ptr, 8) == false)
+				{
+					self.state = Core::STATE_ERR;
+					break;
+				}
+				self.r[i - 1].u64 = *ptr;
+				SP.ptr = ptr + 1;
+			}
+			break;
+		}
+		case Op_ENTER:
+		{
+			auto size = *load_operand<uint32_t, CHECKED>(self);
+			auto& SP = self.r[Reg_SP];
+			// space for the old frame pointer
+			auto ptr = ((uint64_t*)SP.ptr - 1);
+			auto frame = (uint8_t*)ptr - size;
+			if(valid_next_bytes<CHECKED>(self, frame, size + 8) == false)
+			{
+				self.state = Core::STATE_ERR;
+				break;
+			}
+			*ptr = self.r[Reg_FP].u64;
+			self.r[Reg_FP].ptr = ptr;
+			SP.ptr = frame;
+			break;
+		}
+		case Op_LEAVE:
+		{
+			auto ptr = ((uint64_t*)self.r[Reg_FP].ptr);
+			if(valid_next_bytes<CHECKED>(self, ptr, 8) == false)
+			{
+				self.state = Core::STATE_ERR;
+				break;
+			}
+			self.r[Reg_FP].u64 = *ptr;
+			self.r[Reg_SP].ptr = ptr + 1;
+			break;
+		}
+		case Op_CALL:
+		{
+			// load proc address
+			auto  address = load_operand<uint64_t, CHECKED>(self);
+			// load stack pointer
+			auto& SP = self.r[Reg_SP];
+			// allocate space for return address, the unchecked mode checks the callee frame fits instead
+			auto ptr = ((uint64_t*)SP.ptr - 1);
+			if(valid_next_bytes<CHECKED>(self, ptr, 8) == false || (CHECKED == false && valid_frame(self, ptr) == false))
+			{
+				self.state = Core::STATE_ERR;
+				break;
+			}
+			// write the return address
+			*ptr = self.r[Reg_IP].u64;
+			// move the stack pointer
+			SP.ptr = ptr;
+			// jump to proc address
+			self.r[Reg_IP].u64 = *address;
+		#if VM_PROFILE
+			if (*address < self.profile.calls.count)
+				++self.profile.calls[*address];
+		#endif
+			break;
+		}
+		case Op_CALL32:
+		{
+			// load proc address
+			auto  address = load_operand<uint32_t, CHECKED>(self);
+			// load stack pointer
+			auto& SP = self.r[Reg_SP];
+			// allocate space for return address, the unchecked mode checks the callee frame fits instead
+			auto ptr = ((uint64_t*)SP.ptr - 1);
+			if(valid_next_bytes<CHECKED>(self, ptr, 8) == false || (CHECKED == false && valid_frame(self, ptr) == false))
+			{
+				self.state = Core::STATE_ERR;
+				break;
+			}
+			// write the return address
+			*ptr = self.r[Reg_IP].u64;
+			// move the stack pointer
+			SP.ptr = ptr;
+			// jump to proc address
+			self.r[Reg_IP].u64 = *address;
+		#if VM_PROFILE
+			if (*address < self.profile.calls.count)
+				++self.profile.calls[*address];
+		#endif
+			break;
+		}
+		case Op_TAILCALL:
+		{
+			// the return address of the current proc is left as is on the stack
+			auto address = load_operand<uint32_t, CHECKED>(self);
+			self.r[Reg_IP].u64 = *address;
+		#if VM_PROFILE
+			if (*address < self.profile.calls.count)
+				++self.profile.calls[*address];
+		#endif
+			break;
+		}
+		case Op_C_CALL:
+		{
+			// load c proc index
+			auto ix = *load_operand<uint64_t, CHECKED>(self);
+			if(CHECKED && ix >= self.c_procs_desc.count)
+			{
+				self.state = Core::STATE_ERR;
+				break;
+			}
+			auto& cproc = self.c_procs_desc[ix];
+			auto cproc_ptr= self.c_procs_address[ix];
+			
+			ffi_cif cif;
+			auto arg_types = mn::buf_with_count<ffi_type*>(cproc.arg_types.count);
+			auto arg_values = mn::buf_with_count<void*>(cproc.arg_types.count);
+			auto ret_type = ffi_type_from_c(cproc.ret);
+			ffi_arg ret_value;
+			mn_defer({
+				mn::buf_free(arg_types);
+				mn::buf_free(arg_values);
+			});
+
+			char* it = (char*)self.r[Reg_SP].ptr;
+
+			// get return value address from the stack
+			if(valid_next_bytes<CHECKED>(self, it, ret_type->size) == false)
+			{
+				self.state = Core::STATE_ERR;
+				break;
+			}
+			it += ret_type->size;
+
+			// get args from the stack
+			for(size_t i = 0; i < cproc.arg_types.count; ++i)
+			{
+				auto ffi_arg_type = ffi_type_from_c(cproc.arg_types[i]);
+				if(valid_next_bytes<CHECKED>(self, it, ffi_arg_type->size) == false)
+				{
+					self.state = Core::STATE_ERR;
+					break;
+				}
+				arg_types[i] = ffi_arg_type;
+				arg_values[i] = it;
+				it += ffi_arg_type->size;
+			}
+
+			// exit if there's an error
+			if (self.state == Core::STATE_ERR)
+				break;
+
+			auto res = ffi_prep_cif(&cif, FFI_DEFAULT_ABI, uint32_t(cproc.arg_types.count), ret_type, arg_types.ptr);
+			if(res != FFI_OK)
+			{
+				self.state = Core::STATE_ERR;
+				break;
+			}
+		#if VM_PROFILE
+			auto c_call_start = std::chrono::steady_clock::now();
+			ffi_call(&cif, FFI_FN(cproc_ptr), &ret_value, arg_values.ptr);
+			if (ix < self.profile.c_calls.count)
+			{
+				auto elapsed = std::chrono::steady_clock::now() - c_call_start;
+				++self.profile.c_calls[ix];
+				self.profile.c_time[ix] += uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+			}
+		#else
+			ffi_call(&cif, FFI_FN(cproc_ptr), &ret_value, arg_values.ptr);
+		#endif
+
+			// write the return value to its slot, small integers are widened to ffi_arg so their bytes come
+			// first on little endian
+			if (ret_type != &ffi_type_void)
+				::memcpy(self.r[Reg_SP].ptr, &ret_value, ret_type->size);
+			break;
+		}
+		case Op_RET:
+		{
+			// load stack pointer
+			auto& SP = self.r[Reg_SP];
+			auto ptr = ((uint64_t*)SP.ptr);
+			if(valid_next_bytes<CHECKED>(self, ptr, 8) == false)
+			{
+				self.state = Core::STATE_ERR;
+				break;
+			}
+			// the verifier doesn't prove writes through memory operands so the return address might have
+			// been overwritten, the unchecked mode doesn't check fetches and has to check it here
+			if (CHECKED == false && *ptr >= self.bytecode.count)
+			{
+				self.state = Core::STATE_ERR;
+				break;
+			}
+			// restore the IP
 			self.r[Reg_IP].u64 = *ptr;
 			// deallocate the space for return address
-			SP.ptr = ptr;
+			SP.ptr = ptr + 1;
 			break;
 		}
 		case Op_HALT:
@@ -630,4 +2102,51 @@ namespace vm
 			break;
 		}
 	}
+
+	// verified bytecode runs unchecked once the stack has room for the deepest frame, calls keep checking
+	// it from there on
+	inline static bool
+	_core_unchecked(Core& self)
+	{
+		return self.verified && valid_frame(self, self.r[Reg_SP].ptr);
+	}
+
+	void
+	core_ins_execute(Core& self)
+	{
+		if (_core_unchecked(self))
+			_core_ins_execute<false>(self);
+		else
+			_core_ins_execute<true>(self);
+	}
+
+	void
+	core_run(Core& self)
+	{
+		if (_core_unchecked(self))
+		{
+			while (self.state == Core::STATE_OK)
+				_core_ins_execute<false>(self);
+		}
+		else
+		{
+			while (self.state == Core::STATE_OK)
+				_core_ins_execute<true>(self);
+		}
+	}
+
+	void
+	core_run_for(Core& self, uint64_t count)
+	{
+		if (_core_unchecked(self))
+		{
+			for (uint64_t i = 0; i < count && self.state == Core::STATE_OK; ++i)
+				_core_ins_execute<false>(self);
+		}
+		else
+		{
+			for (uint64_t i = 0; i < count && self.state == Core::STATE_OK; ++i)
+				_core_ins_execute<true>(self);
+		}
+	}
 }
\ No newline at end of file
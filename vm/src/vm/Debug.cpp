@@ -0,0 +1,228 @@
+#include "vm/Debug.h"
+#include "vm/Core.h"
+
+#include <mn/Defer.h>
+
+#include <algorithm>
+
+namespace vm
+{
+	inline static void
+	_varint_push(mn::Buf<uint8_t>& out, uint64_t v)
+	{
+		while (v >= 0x80)
+		{
+			mn::buf_push(out, uint8_t(v | 0x80));
+			v >>= 7;
+		}
+		mn::buf_push(out, uint8_t(v));
+	}
+
+	// a truncated varint reads as the bits it has and leaves the iterator at the end
+	inline static uint64_t
+	_varint_read(const uint8_t*& it, const uint8_t* end)
+	{
+		uint64_t v = 0;
+		for (uint32_t shift = 0; it < end && shift < 64; shift += 7)
+		{
+			auto byte = *it++;
+			v |= uint64_t(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+				break;
+		}
+		return v;
+	}
+
+	// signed deltas are zigzag encoded so small negative values stay small
+	inline static uint64_t
+	_zigzag(int64_t v)
+	{
+		return (uint64_t(v) << 1) ^ uint64_t(v >> 63);
+	}
+
+	inline static int64_t
+	_unzigzag(uint64_t v)
+	{
+		return int64_t(v >> 1) ^ -int64_t(v & 1);
+	}
+
+	inline static void
+	_str_push(mn::Buf<uint8_t>& out, const mn::Str& str)
+	{
+		_varint_push(out, str.count);
+		for (auto c: str)
+			mn::buf_push(out, uint8_t(c));
+	}
+
+	inline static mn::Str
+	_str_read(const uint8_t*& it, const uint8_t* end)
+	{
+		auto len = _varint_read(it, end);
+		if (len > uint64_t(end - it))
+			len = end - it;
+		auto str = mn::str_from_substr((const char*)it, (const char*)it + len);
+		it += len;
+		return str;
+	}
+
+	// API
+	Proc_Debug
+	proc_debug_new()
+	{
+		Proc_Debug self{};
+		self.file = mn::str_new();
+		self.lines = mn::buf_new<Debug_Line>();
+		self.labels = mn::buf_new<Debug_Label>();
+		return self;
+	}
+
+	void
+	proc_debug_free(Proc_Debug& self)
+	{
+		mn::str_free(self.file);
+		mn::buf_free(self.lines);
+		destruct(self.labels);
+	}
+
+	void
+	proc_debug_save(const Proc_Debug& self, mn::Stream stream)
+	{
+		auto bytes = mn::buf_new<uint8_t>();
+		mn_defer(mn::buf_free(bytes));
+
+		_str_push(bytes, self.file);
+
+		_varint_push(bytes, self.lines.count);
+		Debug_Line prev{};
+		for (const auto& line: self.lines)
+		{
+			_varint_push(bytes, line.offset - prev.offset);
+			_varint_push(bytes, _zigzag(int64_t(line.line) - int64_t(prev.line)));
+			_varint_push(bytes, _zigzag(int64_t(line.col) - int64_t(prev.col)));
+			prev = line;
+		}
+
+		_varint_push(bytes, self.labels.count);
+		uint64_t prev_offset = 0;
+		for (const auto& label: self.labels)
+		{
+			_str_push(bytes, label.name);
+			_varint_push(bytes, label.offset - prev_offset);
+			prev_offset = label.offset;
+		}
+
+		uint32_t len = uint32_t(bytes.count);
+		mn::stream_write(stream, mn::block_from(len));
+		mn::stream_write(stream, mn::block_from(bytes));
+	}
+
+	Proc_Debug
+	proc_debug_load(mn::Stream stream)
+	{
+		uint32_t len = 0;
+		mn::stream_read(stream, mn::block_from(len));
+		auto bytes = mn::buf_new<uint8_t>();
+		mn_defer(mn::buf_free(bytes));
+		mn::buf_resize(bytes, len);
+		mn::stream_read(stream, mn::block_from(bytes));
+		return proc_debug_decode(mn::block_from(bytes));
+	}
+
+	Proc_Debug
+	proc_debug_decode(mn::Block bytes)
+	{
+		const uint8_t* it = (const uint8_t*)bytes.ptr;
+		const uint8_t* end = it + bytes.size;
+
+		auto self = proc_debug_new();
+		mn::str_free(self.file);
+		self.file = _str_read(it, end);
+
+		auto lines_count = _varint_read(it, end);
+		Debug_Line prev{};
+		for (uint64_t i = 0; i < lines_count && it < end; ++i)
+		{
+			Debug_Line line{};
+			line.offset = prev.offset + _varint_read(it, end);
+			line.line = uint32_t(int64_t(prev.line) + _unzigzag(_varint_read(it, end)));
+			line.col = uint32_t(int64_t(prev.col) + _unzigzag(_varint_read(it, end)));
+			mn::buf_push(self.lines, line);
+			prev = line;
+		}
+
+		auto labels_count = _varint_read(it, end);
+		uint64_t prev_offset = 0;
+		for (uint64_t i = 0; i < labels_count && it < end; ++i)
+		{
+			Debug_Label label{};
+			label.name = _str_read(it, end);
+			label.offset = prev_offset + _varint_read(it, end);
+			mn::buf_push(self.labels, label);
+			prev_offset = label.offset;
+		}
+		return self;
+	}
+
+	Debug_Info
+	debug_info_new()
+	{
+		Debug_Info self{};
+		self.procs_file = mn::buf_new<mn::Str>();
+		self.lines = mn::buf_new<Debug_Line>();
+		self.labels = mn::buf_new<Debug_Label>();
+		return self;
+	}
+
+	void
+	debug_info_free(Debug_Info& self)
+	{
+		destruct(self.procs_file);
+		mn::buf_free(self.lines);
+		destruct(self.labels);
+	}
+
+	bool
+	core_location_at(const Core& self, uint64_t offset, Source_Location& location)
+	{
+		const auto& lines = self.debug.lines;
+		if (lines.count == 0)
+			return false;
+
+		// the last line entry at or before the offset, it must be in the same proc
+		auto it = std::upper_bound(lines.ptr, lines.ptr + lines.count, offset, [](uint64_t offset, const Debug_Line& line) {
+			return offset < line.offset;
+		});
+		if (it == lines.ptr)
+			return false;
+		--it;
+
+		auto proc = core_proc_at(self, offset);
+		if (proc >= self.debug.procs_file.count || it->offset < self.procs[proc])
+			return false;
+
+		location.file = self.debug.procs_file[proc];
+		location.line = it->line;
+		location.col = it->col;
+		return true;
+	}
+
+	const Debug_Label*
+	core_label_at(const Core& self, uint64_t offset)
+	{
+		const auto& labels = self.debug.labels;
+		if (labels.count == 0)
+			return nullptr;
+
+		auto it = std::upper_bound(labels.ptr, labels.ptr + labels.count, offset, [](uint64_t offset, const Debug_Label& label) {
+			return offset < label.offset;
+		});
+		if (it == labels.ptr)
+			return nullptr;
+		--it;
+
+		auto proc = core_proc_at(self, offset);
+		if (proc == self.procs.count || it->offset < self.procs[proc])
+			return nullptr;
+		return it;
+	}
+}
@@ -0,0 +1,433 @@
+#pragma once
+
+#include "vm/Op.h"
+#include "vm/Reg.h"
+#include "vm/Asm.h"
+
+#include <mn/Buf.h>
+#include <mn/Defer.h>
+#include <mn/Result.h>
+
+#include <stdint.h>
+
+// bytecode decoding and stack depth tracking shared by the verifier and the stack bound analysis
+namespace vm
+{
+	// operands of an opcode in the order they're encoded, the first one is written to when dst is set
+	struct Op_Layout
+	{
+		uint8_t count;
+		uint8_t sizes[3];
+		bool dst;
+	};
+
+	struct Ins_Operand
+	{
+		ADDRESS_MODE mode;
+		Reg reg;
+		int32_t disp;
+		uint64_t imm;
+	};
+
+	struct Decoded_Ins
+	{
+		uint64_t offset;
+		uint64_t size;
+		Op op;
+		Op_Layout layout;
+		Ins_Operand operands[3];
+	};
+
+	// stack pointer and frame pointer relative to the stack pointer at the proc entry
+	struct Stack_State
+	{
+		bool visited;
+		bool sp_known;
+		bool fp_known;
+		int64_t sp;
+		int64_t fp;
+	};
+
+	inline static Op_Layout
+	op_layout_unary(uint8_t size, bool dst = true)
+	{
+		return Op_Layout{1, {size, 0, 0}, dst};
+	}
+
+	inline static Op_Layout
+	op_layout_binary(uint8_t size, bool dst = true)
+	{
+		return Op_Layout{2, {size, size, 0}, dst};
+	}
+
+	// integer ops come in 8, 16, 32 and 64-bit variants in this order
+	inline static uint8_t
+	op_int_size(Op op, Op first)
+	{
+		return uint8_t(1 << ((op - first) % 4));
+	}
+
+	// float ops come in 32 and 64-bit variants in this order
+	inline static uint8_t
+	op_float_size(Op op, Op first)
+	{
+		return uint8_t(4 << ((op - first) % 2));
+	}
+
+	inline static bool
+	op_layout(Op op, Op_Layout& layout)
+	{
+		if (op >= Op_NOT8 && op <= Op_NOT64)
+			layout = op_layout_unary(op_int_size(op, Op_NOT8));
+		else if (op >= Op_MOV8 && op <= Op_CTZ64)
+			layout = op_layout_binary(op_int_size(op, Op_MOV8));
+		else if (op >= Op_BSWAP16 && op <= Op_BSWAP64)
+			layout = op_layout_unary(uint8_t(2 << (op - Op_BSWAP16)));
+		else if (op == Op_FMA32 || op == Op_FMA64)
+			layout = Op_Layout{3, {op_float_size(op, Op_FMA32), op_float_size(op, Op_FMA32), op_float_size(op, Op_FMA32)}, true};
+		else if (op >= Op_FABS32 && op <= Op_FNEG64)
+			layout = op_layout_unary(op_float_size(op, Op_FABS32));
+		else if (op == Op_FCMP32 || op == Op_FCMP64)
+			layout = op_layout_binary(op_float_size(op, Op_FCMP32), false);
+		else if (op >= Op_FADD32 && op <= Op_FMAX64)
+			layout = op_layout_binary(op_float_size(op, Op_FADD32));
+		else if (op >= Op_CMP8 && op <= Op_ICMP64)
+			layout = op_layout_binary(op_int_size(op, Op_CMP8), false);
+		else if (op >= Op_JMP && op <= Op_JGE)
+			layout = op_layout_unary(8, false);
+		else if (op >= Op_JMP8 && op <= Op_JGE8)
+			layout = op_layout_unary(1, false);
+		else if (op >= Op_JMP32 && op <= Op_JGE32)
+			layout = op_layout_unary(4, false);
+		else if (op >= Op_CMOVE8 && op <= Op_CMOVGE64)
+			layout = op_layout_binary(op_int_size(op, Op_CMOVE8));
+		else if (op >= Op_SETE8 && op <= Op_SETGE64)
+			layout = op_layout_unary(op_int_size(op, Op_SETE8));
+		else
+		{
+			switch(op)
+			{
+			// conversions, dst then src size
+			case Op_I32_TO_F32: layout = Op_Layout{2, {4, 4, 0}, true}; break;
+			case Op_I64_TO_F32: layout = Op_Layout{2, {4, 8, 0}, true}; break;
+			case Op_U32_TO_F32: layout = Op_Layout{2, {4, 4, 0}, true}; break;
+			case Op_U64_TO_F32: layout = Op_Layout{2, {4, 8, 0}, true}; break;
+			case Op_I32_TO_F64: layout = Op_Layout{2, {8, 4, 0}, true}; break;
+			case Op_I64_TO_F64: layout = Op_Layout{2, {8, 8, 0}, true}; break;
+			case Op_U32_TO_F64: layout = Op_Layout{2, {8, 4, 0}, true}; break;
+			case Op_U64_TO_F64: layout = Op_Layout{2, {8, 8, 0}, true}; break;
+			case Op_F32_TO_I32: layout = Op_Layout{2, {4, 4, 0}, true}; break;
+			case Op_F32_TO_I64: layout = Op_Layout{2, {8, 4, 0}, true}; break;
+			case Op_F32_TO_U32: layout = Op_Layout{2, {4, 4, 0}, true}; break;
+			case Op_F32_TO_U64: layout = Op_Layout{2, {8, 4, 0}, true}; break;
+			case Op_F64_TO_I32: layout = Op_Layout{2, {4, 8, 0}, true}; break;
+			case Op_F64_TO_I64: layout = Op_Layout{2, {8, 8, 0}, true}; break;
+			case Op_F64_TO_U32: layout = Op_Layout{2, {4, 8, 0}, true}; break;
+			case Op_F64_TO_U64: layout = Op_Layout{2, {8, 8, 0}, true}; break;
+			case Op_F32_TO_F64: layout = Op_Layout{2, {8, 4, 0}, true}; break;
+			case Op_F64_TO_F32: layout = Op_Layout{2, {4, 8, 0}, true}; break;
+			case Op_PUSH: layout = op_layout_unary(8, false); break;
+			case Op_POP: layout = op_layout_unary(8); break;
+			case Op_PUSHM: layout = op_layout_unary(2, false); break;
+			case Op_POPM: layout = op_layout_unary(2, false); break;
+			case Op_ENTER: layout = op_layout_unary(4, false); break;
+			case Op_CALL: layout = op_layout_unary(8, false); break;
+			case Op_CALL32: layout = op_layout_unary(4, false); break;
+			case Op_TAILCALL: layout = op_layout_unary(4, false); break;
+			case Op_C_CALL: layout = op_layout_unary(8, false); break;
+			case Op_LEAVE:
+			case Op_RET:
+			case Op_HALT:
+				layout = Op_Layout{};
+				break;
+			default:
+				return false;
+			}
+		}
+		return true;
+	}
+
+	inline static bool
+	op_is_cond_jump(Op op)
+	{
+		return ((op >= Op_JE && op <= Op_JGE) ||
+				(op >= Op_JE8 && op <= Op_JGE8) ||
+				(op >= Op_JE32 && op <= Op_JGE32));
+	}
+
+	inline static bool
+	op_is_jump(Op op)
+	{
+		return (op == Op_JMP || op == Op_JMP8 || op == Op_JMP32 || op_is_cond_jump(op));
+	}
+
+	inline static bool
+	op_falls_through(Op op)
+	{
+		return (op != Op_JMP && op != Op_JMP8 && op != Op_JMP32 &&
+				op != Op_RET && op != Op_TAILCALL && op != Op_HALT);
+	}
+
+	inline static uint64_t
+	ins_jump_target(const Decoded_Ins& ins)
+	{
+		auto next = ins.offset + ins.size;
+		auto imm = ins.operands[0].imm;
+		switch(ins.layout.sizes[0])
+		{
+		case 1: return next + uint64_t(int64_t(int8_t(imm)));
+		case 4: return next + uint64_t(int64_t(int32_t(imm)));
+		default: return next + imm;
+		}
+	}
+
+	inline static mn::Err
+	ins_decode(const uint8_t* code, uint64_t offset, uint64_t end, Decoded_Ins& ins)
+	{
+		ins = Decoded_Ins{};
+		ins.offset = offset;
+		ins.op = Op(code[offset]);
+		if (ins.op == Op_IGL || op_layout(ins.op, ins.layout) == false)
+			return mn::Err{"bytecode offset {}: illegal opcode {}", offset, uint8_t(ins.op)};
+
+		auto it = offset + 1;
+		for (uint8_t i = 0; i < ins.layout.count; ++i)
+		{
+			auto& operand = ins.operands[i];
+			if (it >= end)
+				return mn::Err{"bytecode offset {}: truncated instruction", offset};
+			operand.mode = ext_from_byte(code[it++]).address_mode;
+
+			if (operand.mode == ADDRESS_MODE_IMM)
+			{
+				auto size = ins.layout.sizes[i];
+				if (it + size > end)
+					return mn::Err{"bytecode offset {}: truncated immediate operand", offset};
+				::memcpy(&operand.imm, code + it, size);
+				it += size;
+				continue;
+			}
+
+			if (it >= end)
+				return mn::Err{"bytecode offset {}: truncated instruction", offset};
+			operand.reg = Reg(code[it++]);
+			if (operand.reg >= Reg_COUNT)
+				return mn::Err{"bytecode offset {}: invalid register {}", offset, uint8_t(operand.reg)};
+
+			if (operand.mode == ADDRESS_MODE_MEM_DISP)
+			{
+				if (it + sizeof(int32_t) > end)
+					return mn::Err{"bytecode offset {}: truncated displacement", offset};
+				::memcpy(&operand.disp, code + it, sizeof(int32_t));
+				it += sizeof(int32_t);
+			}
+		}
+		ins.size = it - offset;
+
+		if (ins.layout.dst)
+		{
+			const auto& dst = ins.operands[0];
+			if (dst.mode == ADDRESS_MODE_IMM)
+				return mn::Err{"bytecode offset {}: immediate destination operand", offset};
+			if (dst.mode == ADDRESS_MODE_REG && dst.reg == Reg_IP)
+				return mn::Err{"bytecode offset {}: instruction writes the ip register", offset};
+		}
+
+		if (op_is_jump(ins.op) && ins.operands[0].mode != ADDRESS_MODE_IMM)
+			return mn::Err{"bytecode offset {}: jump offset isn't an immediate", offset};
+
+		if ((ins.op == Op_PUSHM || ins.op == Op_POPM) && ins.operands[0].mode != ADDRESS_MODE_IMM)
+			return mn::Err{"bytecode offset {}: register list isn't an immediate", offset};
+		if ((ins.op == Op_PUSHM || ins.op == Op_POPM) && (ins.operands[0].imm & ~uint64_t(REG_LIST_MASK)))
+			return mn::Err{"bytecode offset {}: register list has registers other than r0 to r7 and fp", offset};
+		return mn::Err{};
+	}
+
+	// the stack state after executing the instruction, returns false if the proc returns with an unbalanced stack
+	inline static bool
+	stack_step(const Decoded_Ins& ins, Stack_State& state)
+	{
+		const auto& op0 = ins.operands[0];
+		switch(ins.op)
+		{
+		case Op_PUSH:
+			state.sp -= 8;
+			break;
+		case Op_POP:
+			state.sp += 8;
+			break;
+		case Op_PUSHM:
+		case Op_POPM:
+		{
+			// ins_decode made sure the list is an immediate without sp or ip
+			int64_t count = 0;
+			for (uint8_t i = 0; i < Reg_COUNT; ++i)
+				if (op0.imm & (1 << i))
+					++count;
+			state.sp += (ins.op == Op_PUSHM ? -8 : 8) * count;
+			if (ins.op == Op_POPM && (op0.imm & (1 << Reg_FP)))
+				state.fp_known = false;
+			break;
+		}
+		case Op_ENTER:
+			state.fp = state.sp - 8;
+			state.fp_known = state.sp_known;
+			if (op0.mode == ADDRESS_MODE_IMM)
+				state.sp -= 8 + int64_t(uint32_t(op0.imm));
+			else
+				state.sp_known = false;
+			break;
+		case Op_LEAVE:
+			state.sp = state.fp + 8;
+			state.sp_known = state.fp_known;
+			// the frame pointer is restored to whatever the proc was called with
+			state.fp_known = false;
+			break;
+		case Op_ADD64:
+		case Op_SUB64:
+			// stack allocations like sub sp 16
+			if (op0.mode == ADDRESS_MODE_REG && op0.reg == Reg_SP && ins.operands[1].mode == ADDRESS_MODE_IMM)
+			{
+				auto size = int64_t(ins.operands[1].imm);
+				state.sp += ins.op == Op_ADD64 ? size : -size;
+				return true;
+			}
+			break;
+		case Op_MOV64:
+			// frames set up and torn down by hand like mov fp sp and mov sp fp
+			if (op0.mode == ADDRESS_MODE_REG && ins.operands[1].mode == ADDRESS_MODE_REG)
+			{
+				if (op0.reg == Reg_SP && ins.operands[1].reg == Reg_FP)
+				{
+					state.sp = state.fp;
+					state.sp_known = state.fp_known;
+					return true;
+				}
+				else if (op0.reg == Reg_FP && ins.operands[1].reg == Reg_SP)
+				{
+					state.fp = state.sp;
+					state.fp_known = state.sp_known;
+					return true;
+				}
+			}
+			break;
+		case Op_RET:
+		case Op_TAILCALL:
+			return state.sp_known == false || state.sp == 0;
+		default:
+			break;
+		}
+
+		if (ins.layout.dst && op0.mode == ADDRESS_MODE_REG)
+		{
+			if (op0.reg == Reg_SP)
+				state.sp_known = false;
+			else if (op0.reg == Reg_FP)
+				state.fp_known = false;
+		}
+		return true;
+	}
+
+	// merges the incoming state into the instruction entry state and sets changed if it changed, paths
+	// which meet with different known stack depths fail the merge
+	inline static bool
+	stack_merge(Stack_State& self, const Stack_State& in, bool& changed)
+	{
+		changed = false;
+		if (self.visited == false)
+		{
+			self = in;
+			self.visited = true;
+			changed = true;
+			return true;
+		}
+
+		if (self.sp_known && in.sp_known && self.sp != in.sp)
+			return false;
+
+		if (self.sp_known && in.sp_known == false)
+		{
+			self.sp_known = false;
+			changed = true;
+		}
+		if (self.fp_known && (in.fp_known == false || in.fp != self.fp))
+		{
+			self.fp_known = false;
+			changed = true;
+		}
+		return true;
+	}
+
+	// decodes the instructions of the proc in [begin, end), index maps each byte of the proc to the
+	// instruction which starts at it or SIZE_MAX
+	inline static mn::Err
+	proc_decode(const uint8_t* code, uint64_t begin, uint64_t end, mn::Buf<Decoded_Ins>& ins, mn::Buf<size_t>& index)
+	{
+		mn::buf_clear(ins);
+		mn::buf_clear(index);
+		mn::buf_resize_fill(index, end - begin, SIZE_MAX);
+		for (auto it = begin; it < end;)
+		{
+			Decoded_Ins decoded{};
+			if (auto err = ins_decode(code, it, end, decoded))
+				return err;
+			index[it - begin] = ins.count;
+			mn::buf_push(ins, decoded);
+			it += decoded.size;
+		}
+		return mn::Err{};
+	}
+
+	// propagates the stack state from the proc entry through its instructions, it fails on jumps outside
+	// the proc, on paths which meet with different stack depths and on unbalanced returns
+	inline static mn::Err
+	proc_stack_flow(const mn::Buf<Decoded_Ins>& ins, const mn::Buf<size_t>& index, uint64_t begin, mn::Buf<Stack_State>& states)
+	{
+		mn::buf_clear(states);
+		mn::buf_resize_fill(states, ins.count, Stack_State{});
+		if (ins.count == 0)
+			return mn::Err{};
+
+		auto work = mn::buf_new<size_t>();
+		mn_defer(mn::buf_free(work));
+		states[0] = Stack_State{true, true, false, 0, 0};
+		mn::buf_push(work, size_t(0));
+
+		while (work.count > 0)
+		{
+			auto ix = mn::buf_top(work);
+			mn::buf_pop(work);
+
+			const auto& decoded = ins[ix];
+			auto state = states[ix];
+			if (stack_step(decoded, state) == false)
+				return mn::Err{"bytecode offset {}: the stack is unbalanced by {} bytes on return", decoded.offset, state.sp};
+
+			size_t succs[2] = {};
+			size_t succs_count = 0;
+			if (op_is_jump(decoded.op))
+			{
+				auto target = ins_jump_target(decoded);
+				if (target < begin || target - begin >= index.count || index[target - begin] == SIZE_MAX)
+					return mn::Err{"bytecode offset {}: jump target {} isn't an instruction of the proc", decoded.offset, target};
+				succs[succs_count++] = index[target - begin];
+			}
+			if (op_falls_through(decoded.op))
+			{
+				if (ix + 1 >= ins.count)
+					return mn::Err{"bytecode offset {}: execution falls through the end of the proc", decoded.offset};
+				succs[succs_count++] = ix + 1;
+			}
+
+			for (size_t i = 0; i < succs_count; ++i)
+			{
+				bool changed = false;
+				if (stack_merge(states[succs[i]], state, changed) == false)
+					return mn::Err{"bytecode offset {}: paths reach it with different stack depths", ins[succs[i]].offset};
+				if (changed)
+					mn::buf_push(work, succs[i]);
+			}
+		}
+		return mn::Err{};
+	}
+}
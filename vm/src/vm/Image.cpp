@@ -0,0 +1,21 @@
+#include "vm/Image.h"
+
+namespace vm
+{
+	// API
+	Image
+	image_new()
+	{
+		Image self{};
+		self.rodata = mn::buf_new<uint8_t>();
+		self.sections = mn::map_new<mn::Str, uint64_t>();
+		return self;
+	}
+
+	void
+	image_free(Image& self)
+	{
+		mn::buf_free(self.rodata);
+		destruct(self.sections);
+	}
+}
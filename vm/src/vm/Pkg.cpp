@@ -1,5 +1,8 @@
 #include "vm/Pkg.h"
 #include "vm/Core.h"
+#include "vm/Verify.h"
+
+#include "Decode.h"
 
 #include <mn/File.h>
 #include <mn/Path.h>
@@ -30,6 +33,33 @@ namespace vm
 		ptr[7] = uint8_t(v >> 56);
 	}
 
+	inline static void
+	_write32(uint8_t* ptr, uint32_t v)
+	{
+		ptr[0] = uint8_t(v);
+		ptr[1] = uint8_t(v >> 8);
+		ptr[2] = uint8_t(v >> 16);
+		ptr[3] = uint8_t(v >> 24);
+	}
+
+	inline static mn::Err
+	_reloc_write(uint8_t* ptr, const Reloc& reloc, uint64_t v)
+	{
+		switch(reloc.width)
+		{
+		case sizeof(uint32_t):
+			if (v > UINT32_MAX)
+				return mn::Err{ "relocation target '{}' is out of the 32-bit range", reloc.target_name };
+			_write32(ptr, uint32_t(v));
+			return mn::Err{};
+		case sizeof(uint64_t):
+			_write64(ptr, v);
+			return mn::Err{};
+		default:
+			return mn::Err{ "relocation target '{}' has invalid width {}", reloc.target_name, reloc.width };
+		}
+	}
+
 	inline static void
 	_write_string(mn::Stream out, const mn::Str& str)
 	{
@@ -46,31 +76,188 @@ namespace vm
 		mn::stream_write(out, bytes);
 	}
 
-	inline static mn::Str
-	_read_string(mn::Stream in)
+	// reads of a package, the lengths are checked against the bytes left in the file so a truncated or
+	// corrupt package fails the load instead of allocating or reading past its end
+	struct Pkg_Reader
+	{
+		mn::Stream in;
+		uint64_t left;
+		bool failed;
+	};
+
+	inline static Pkg_Reader
+	_reader_new(mn::Stream in, uint64_t size = UINT64_MAX)
+	{
+		return Pkg_Reader{in, size, false};
+	}
+
+	inline static bool
+	_read(Pkg_Reader& self, mn::Block block)
+	{
+		if (self.failed == false && block.size <= self.left &&
+			size_t(mn::stream_read(self.in, block)) == block.size)
+		{
+			self.left -= block.size;
+			return true;
+		}
+
+		self.failed = true;
+		::memset(block.ptr, 0, block.size);
+		return false;
+	}
+
+	// reads the length of the next string or bytes, it fails if they don't fit in what's left of the file
+	inline static uint32_t
+	_read_len(Pkg_Reader& self, size_t element_size = 1)
 	{
 		uint32_t len = 0;
-		mn::stream_read(in, mn::block_from(len));
+		if (_read(self, mn::block_from(len)) && uint64_t(len) * element_size > self.left)
+		{
+			self.failed = true;
+			len = 0;
+		}
+		return len;
+	}
+
+	inline static mn::Str
+	_read_string(Pkg_Reader& in)
+	{
+		auto len = _read_len(in);
 
 		auto v = mn::str_new();
 		mn::str_resize(v, len);
-		mn::stream_read(in, mn::block_from(v));
+		_read(in, mn::block_from(v));
 
 		return v;
 	}
 
 	inline static mn::Block
-	_read_bytes(mn::Stream in)
+	_read_bytes(Pkg_Reader& in)
 	{
-		uint32_t len = 0;
-		mn::stream_read(in, mn::block_from(len));
+		auto len = _read_len(in);
 
 		auto v = mn::alloc(len, alignof(uint8_t));
-		mn::stream_read(in, v);
+		_read(in, v);
 
 		return v;
 	}
 
+	// a package starts with the magic and the format version, the version is bumped whenever the records,
+	// the opcodes or the operand encodings change since the old bytecode can't run on the new vm
+	constexpr inline uint32_t PKG_MAGIC = 'Z' | ('Y' << 8) | ('P' << 16) | ('K' << 24);
+	constexpr inline uint32_t PKG_VERSION = 1;
+
+	// after the header a package is a list of records, each starts with its kind and the package ends with
+	// the end record
+	enum PKG_RECORD: uint8_t
+	{
+		PKG_RECORD_END,
+		PKG_RECORD_SECTION,
+		PKG_RECORD_RELOC,
+		PKG_RECORD_C_PROC,
+		PKG_RECORD_STACK_SIZE,
+		PKG_RECORD_DEBUG,
+	};
+
+	inline static void
+	_write_record(mn::Stream out, PKG_RECORD record)
+	{
+		mn::stream_write(out, mn::block_from(record));
+	}
+
+	inline static void
+	_section_save(mn::Stream out, Section::KIND kind, const mn::Str& name, mn::Block bytes)
+	{
+		mn::stream_write(out, mn::block_from(kind));
+		_write_string(out, name);
+		_write_bytes(out, bytes);
+	}
+
+	inline static bool
+	_c_type_valid(C_TYPE t)
+	{
+		return t >= C_TYPE_VOID && t <= C_TYPE_PTR;
+	}
+
+	inline static C_Proc
+	_c_proc_load(Pkg_Reader& in)
+	{
+		auto self = c_proc_new();
+		self.lib = _read_string(in);
+		self.name = _read_string(in);
+
+		// read args count
+		auto arg_len = _read_len(in, sizeof(C_TYPE));
+		// read arg_types
+		mn::buf_resize(self.arg_types, arg_len);
+		_read(in, mn::block_from(self.arg_types));
+
+		// read return type
+		_read(in, mn::block_from(self.ret));
+
+		// unknown types would reach the ffi calls
+		if (_c_type_valid(self.ret) == false)
+			in.failed = true;
+		for (auto t: self.arg_types)
+			if (_c_type_valid(t) == false)
+				in.failed = true;
+		return self;
+	}
+
+	inline static Section
+	_section_load(Pkg_Reader& in)
+	{
+		Section self{};
+		_read(in, mn::block_from(self.kind));
+		self.name = _read_string(in);
+		self.bytes = _read_bytes(in);
+		if (self.kind != Section::KIND_BYTECODE && self.kind != Section::KIND_CONSTANT)
+			in.failed = true;
+		return self;
+	}
+
+	inline static Reloc
+	_reloc_load(Pkg_Reader& in)
+	{
+		Reloc self{};
+		self.source_name = _read_string(in);
+		self.target_name = _read_string(in);
+		_read(in, mn::block_from(self.source_offset));
+		_read(in, mn::block_from(self.width));
+		_read(in, mn::block_from(self.target_offset));
+		return self;
+	}
+
+	// appends the debug info of the proc which starts at the bytecode offset to the core, packages without
+	// debug info don't add anything
+	inline static void
+	_proc_debug_load(Core& core, const Pkg& pkg, const mn::Str& name, uint64_t offset)
+	{
+		if (pkg.debug.count == 0)
+			return;
+
+		// procs loaded without debug info get an empty file
+		while (core.debug.procs_file.count + 1 < core.procs.count)
+			mn::buf_push(core.debug.procs_file, mn::str_new());
+
+		auto it = mn::map_lookup(pkg.debug, name);
+		if (it == nullptr)
+		{
+			mn::buf_push(core.debug.procs_file, mn::str_new());
+			return;
+		}
+
+		const auto& debug = it->value;
+		mn::buf_push(core.debug.procs_file, clone(debug.file));
+		for (auto line: debug.lines)
+		{
+			line.offset += offset;
+			mn::buf_push(core.debug.lines, line);
+		}
+		for (const auto& label: debug.labels)
+			mn::buf_push(core.debug.labels, Debug_Label{clone(label.name), label.offset + offset});
+	}
+
 	// API
 	Section
 	section_constant_new(const mn::Str& name, mn::Block bytes)
@@ -102,19 +289,14 @@ namespace vm
 	void
 	section_save(const Section& self, mn::Stream out)
 	{
-		mn::stream_write(out, mn::block_from(self.kind));
-		_write_string(out, self.name);
-		_write_bytes(out, self.bytes);
+		_section_save(out, self.kind, self.name, self.bytes);
 	}
 
 	Section
 	section_load(mn::Stream in)
 	{
-		Section self{};
-		mn::stream_read(in, mn::block_from(self.kind));
-		self.name = _read_string(in);
-		self.bytes = _read_bytes(in);
-		return self;
+		auto reader = _reader_new(in);
+		return _section_load(reader);
 	}
 
 
@@ -140,16 +322,15 @@ namespace vm
 		_write_string(out, self.source_name);
 		_write_string(out, self.target_name);
 		mn::stream_write(out, mn::block_from(self.source_offset));
+		mn::stream_write(out, mn::block_from(self.width));
+		mn::stream_write(out, mn::block_from(self.target_offset));
 	}
 
 	Reloc
 	reloc_load(mn::Stream in)
 	{
-		Reloc self{};
-		self.source_name = _read_string(in);
-		self.target_name = _read_string(in);
-		mn::stream_read(in, mn::block_from(self.source_offset));
-		return self;
+		auto reader = _reader_new(in);
+		return _reloc_load(reader);
 	}
 
 
@@ -160,6 +341,7 @@ namespace vm
 		self.sections = mn::map_new<mn::Str, Section>();
 		self.relocs = mn::buf_new<Reloc>();
 		self.c_procs = mn::buf_new<C_Proc>();
+		self.debug = mn::map_new<mn::Str, Proc_Debug>();
 		return self;
 	}
 
@@ -172,6 +354,7 @@ namespace vm
 
 		destruct(self.relocs);
 		destruct(self.c_procs);
+		destruct(self.debug);
 	}
 
 	void
@@ -191,115 +374,442 @@ namespace vm
 	}
 
 	void
-	pkg_reloc_add(Pkg& self, const mn::Str &source_name, uint64_t source_offset, const mn::Str &target_name)
+	pkg_debug_add(Pkg& self, const mn::Str& proc_name, Proc_Debug debug)
+	{
+		if (auto it = mn::map_lookup(self.debug, proc_name))
+		{
+			proc_debug_free(it->value);
+			it->value = debug;
+			return;
+		}
+		mn::map_insert(self.debug, clone(proc_name), debug);
+	}
+
+	void
+	pkg_reloc_add(Pkg& self, const mn::Str &source_name, uint64_t source_offset, const mn::Str &target_name, uint8_t width, uint64_t target_offset)
 	{
 		mn::buf_push(self.relocs, Reloc{
 			clone(source_name),
 			clone(target_name),
-			source_offset
+			source_offset,
+			width,
+			target_offset
 		});
 	}
 
-	void
-	pkg_save(const Pkg& self, const mn::Str& filename)
+	inline static void
+	_stack_frame_free(Stack_Frame& self)
 	{
-		auto f = mn::file_open(filename, mn::IO_MODE::WRITE, mn::OPEN_MODE::CREATE_OVERWRITE);
-		assert(f != nullptr);
-		mn_defer(mn::file_close(f));
+		for (auto& site: self.sites)
+			mn::str_free(site.callee);
+		mn::buf_free(self.sites);
+	}
 
-		// write sections
-		uint32_t len = uint32_t(self.sections.count);
-		mn::stream_write(f, mn::block_from(len));
-		for (const auto& [_, value] : self.sections)
-			section_save(value, f);
+	inline static void
+	destruct(Stack_Frame& self)
+	{
+		_stack_frame_free(self);
+	}
 
-		len = uint32_t(self.relocs.count);
-		mn::stream_write(f, mn::block_from(len));
-		for (const auto& reloc : self.relocs)
-			reloc_save(reloc, f);
+	inline static void
+	_stack_frame_touch(Stack_Frame& self, int64_t sp)
+	{
+		if (sp < 0 && uint64_t(-sp) > self.depth)
+			self.depth = uint64_t(-sp);
+	}
 
+	inline static bool
+	_stack_frame_build(Stack_Frame& self, mn::Block bytes)
+	{
+		auto ins = mn::buf_new<Decoded_Ins>();
+		mn_defer(mn::buf_free(ins));
+		auto index = mn::buf_new<size_t>();
+		mn_defer(mn::buf_free(index));
+		auto states = mn::buf_new<Stack_State>();
+		mn_defer(mn::buf_free(states));
+
+		auto code = (const uint8_t*)bytes.ptr;
+		auto size = uint64_t(bytes.size);
+		if (proc_decode(code, 0, size, ins, index) || proc_stack_flow(ins, index, 0, states))
+			return false;
+
+		for (size_t i = 0; i < ins.count; ++i)
+		{
+			if (states[i].visited == false)
+				continue;
 
-		// write c procs count
-		len = uint32_t(self.c_procs.count);
-		mn::stream_write(f, mn::block_from(len));
+			const auto& decoded = ins[i];
+			auto state = states[i];
+			if (state.sp_known == false)
+				return false;
+			_stack_frame_touch(self, state.sp);
 
-		// write each proc
-		for(const auto &proc: self.c_procs)
-		{
-			_write_string(f, proc.lib);
-			_write_string(f, proc.name);
+			// stack memory accessed below the stack pointer
+			for (uint8_t j = 0; j < decoded.layout.count; ++j)
+			{
+				const auto& operand = decoded.operands[j];
+				if (operand.mode != ADDRESS_MODE_MEM && operand.mode != ADDRESS_MODE_MEM_DISP)
+					continue;
+				auto disp = operand.mode == ADDRESS_MODE_MEM_DISP ? int64_t(operand.disp) : 0;
+				if (operand.reg == Reg_SP)
+					_stack_frame_touch(self, state.sp + disp);
+				else if (operand.reg == Reg_FP && state.fp_known)
+					_stack_frame_touch(self, state.fp + disp);
+				else if (operand.reg == Reg_FP && disp < 0)
+					return false;
+			}
 
-			// write arg_types count
-			len = uint32_t(proc.arg_types.count);
-			mn::stream_write(f, mn::block_from(len));
-			mn::stream_write(f, mn::block_from(proc.arg_types));
+			if (decoded.op == Op_CALL || decoded.op == Op_CALL32 || decoded.op == Op_TAILCALL)
+			{
+				if (decoded.operands[0].mode != ADDRESS_MODE_IMM)
+					return false;
+				// the call address immediate follows the opcode and its ext byte, a tail call reuses the
+				// caller return address and a call pushes its own
+				auto depth = uint64_t(-state.sp) + (decoded.op == Op_TAILCALL ? 0 : 8);
+				mn::buf_push(self.sites, Stack_Site{decoded.offset + 2, depth, mn::str_new()});
+			}
 
-			// write return type
-			mn::stream_write(f, mn::block_from(proc.ret));
+			stack_step(decoded, state);
+			if (state.sp_known == false)
+				return false;
+			_stack_frame_touch(self, state.sp);
 		}
+		return true;
 	}
 
-	Pkg
-	pkg_load(const mn::Str& filename)
+	Stack_Bound
+	stack_bound_new()
 	{
-		auto self = pkg_new();
+		Stack_Bound self{};
+		self.frames = mn::buf_new<Stack_Frame>();
+		self.procs = mn::map_new<mn::Str, size_t>();
+		return self;
+	}
 
-		auto f = mn::file_open(filename, mn::IO_MODE::READ, mn::OPEN_MODE::OPEN_ONLY);
-		assert(f != nullptr);
-		mn_defer(mn::file_close(f));
+	void
+	stack_bound_free(Stack_Bound& self)
+	{
+		destruct(self.frames);
+		for (auto& [name, _]: self.procs)
+			mn::str_free(name);
+		mn::map_free(self.procs);
+	}
 
-		// read sections count
-		uint32_t len = 0;
-		mn::stream_read(f, mn::block_from(len));
-		mn::map_reserve(self.sections, len);
+	void
+	stack_bound_proc(Stack_Bound& self, const mn::Str& name, mn::Block bytes)
+	{
+		Stack_Frame frame{};
+		frame.sites = mn::buf_new<Stack_Site>();
+		frame.bounded = _stack_frame_build(frame, bytes);
+		mn::map_insert(self.procs, clone(name), self.frames.count);
+		mn::buf_push(self.frames, frame);
+	}
+
+	void
+	stack_bound_reloc(Stack_Bound& self, const mn::Str& source_name, uint64_t source_offset, const mn::Str& target_name)
+	{
+		auto it = mn::map_lookup(self.procs, source_name);
+		if (it == nullptr)
+			return;
+		for (auto& site: self.frames[it->value].sites)
+		{
+			if (site.offset != source_offset)
+				continue;
+			mn::str_free(site.callee);
+			site.callee = clone(target_name);
+		}
+	}
+
+	uint64_t
+	stack_bound_compute(const Stack_Bound& self)
+	{
+		const auto& frames = self.frames;
+		auto main_it = mn::map_lookup(self.procs, mn::str_lit("main"));
+		if (main_it == nullptr)
+			return 0;
+
+		// callees of each call site, calls without a reloc or with one to something other than a proc
+		// can't be followed
+		auto callees = mn::buf_new<mn::Buf<size_t>>();
+		mn_defer({
+			for (auto& frame_callees: callees)
+				mn::buf_free(frame_callees);
+			mn::buf_free(callees);
+		});
+		for (const auto& frame: frames)
+		{
+			auto frame_callees = mn::buf_new<size_t>();
+			for (const auto& site: frame.sites)
+			{
+				auto it = mn::map_lookup(self.procs, site.callee);
+				mn::buf_push(frame_callees, it ? it->value : SIZE_MAX);
+			}
+			mn::buf_push(callees, frame_callees);
+		}
 
-		// read each section
-		for(size_t i = 0; i < len; ++i)
+		// post order walk of the call graph from main, reaching a proc which is still on the walk stack
+		// means recursion
+		enum VISIT: uint8_t { VISIT_NONE, VISIT_ACTIVE, VISIT_DONE };
+		auto visits = mn::buf_new<VISIT>();
+		mn_defer(mn::buf_free(visits));
+		mn::buf_resize_fill(visits, frames.count, VISIT_NONE);
+		auto bounds = mn::buf_new<uint64_t>();
+		mn_defer(mn::buf_free(bounds));
+		mn::buf_resize_fill(bounds, frames.count, uint64_t(0));
+
+		// each entry is a proc and the index of its next call to visit
+		struct Walk_Entry { size_t proc; size_t next_call; };
+		auto walk = mn::buf_new<Walk_Entry>();
+		mn_defer(mn::buf_free(walk));
+		mn::buf_push(walk, Walk_Entry{main_it->value, 0});
+		visits[main_it->value] = VISIT_ACTIVE;
+
+		while (walk.count > 0)
 		{
-			auto section = section_load(f);
-			mn::map_insert(self.sections, section.name, section);
+			auto& top = mn::buf_top(walk);
+			const auto& frame = frames[top.proc];
+			const auto& frame_callees = callees[top.proc];
+			if (frame.bounded == false)
+				return 0;
+
+			if (top.next_call < frame_callees.count)
+			{
+				auto callee = frame_callees[top.next_call++];
+				if (callee == SIZE_MAX || visits[callee] == VISIT_ACTIVE)
+					return 0;
+				if (visits[callee] == VISIT_NONE)
+				{
+					visits[callee] = VISIT_ACTIVE;
+					mn::buf_push(walk, Walk_Entry{callee, 0});
+				}
+				continue;
+			}
+
+			auto bound = frame.depth;
+			for (size_t i = 0; i < frame.sites.count; ++i)
+				if (frame.sites[i].depth + bounds[frame_callees[i]] > bound)
+					bound = frame.sites[i].depth + bounds[frame_callees[i]];
+			bounds[top.proc] = bound;
+			visits[top.proc] = VISIT_DONE;
+			mn::buf_pop(walk);
 		}
 
-		// read relocs count
-		len = 0;
-		mn::stream_read(f, mn::block_from(len));
-		mn::buf_reserve(self.relocs, len);
+		auto bound = bounds[main_it->value];
+		if (bound == 0)
+			return 16;
+		return (bound + 15) & ~uint64_t(15);
+	}
+
+	uint64_t
+	pkg_stack_bound(const Pkg& self)
+	{
+		auto bound = stack_bound_new();
+		mn_defer(stack_bound_free(bound));
+
+		for (const auto& [name, section]: self.sections)
+			if (section.kind == Section::KIND_BYTECODE)
+				stack_bound_proc(bound, name, section.bytes);
+
+		for (const auto& reloc: self.relocs)
+			stack_bound_reloc(bound, reloc.source_name, reloc.source_offset, reloc.target_name);
 
-		// read each reloc
-		for(size_t i = 0; i < len; ++i)
-			mn::buf_push(self.relocs, reloc_load(f));
+		return stack_bound_compute(bound);
+	}
 
-		
-		// read c procs count
-		len = 0;
-		mn::stream_read(f, mn::block_from(len));
-		mn::buf_reserve(self.c_procs, len);
+	void
+	pkg_save(const Pkg& self, const mn::Str& filename)
+	{
+		auto writer = pkg_writer_new(filename);
+		mn_defer(pkg_writer_free(writer));
 
-		// read each c proc
-		for(size_t i = 0; i < len; ++i)
+		for (const auto& [_, value] : self.sections)
 		{
-			auto proc = c_proc_new();
-			proc.lib = _read_string(f);
-			proc.name = _read_string(f);
+			if (value.kind == Section::KIND_BYTECODE)
+				pkg_writer_proc(writer, value.name, value.bytes);
+			else
+				pkg_writer_constant(writer, value.name, value.bytes);
+		}
+
+		for (const auto& reloc : self.relocs)
+			pkg_writer_reloc(writer, reloc.source_name, reloc.source_offset, reloc.target_name, reloc.width, reloc.target_offset);
+
+		for (const auto& proc : self.c_procs)
+			pkg_writer_c_proc(writer, proc);
+
+		if (self.stack_size != 0)
+			pkg_writer_stack_size(writer, self.stack_size);
+
+		for (const auto& [name, debug] : self.debug)
+			pkg_writer_debug(writer, name, debug);
+	}
 
-			// read args count
-			uint32_t arg_len = 0;
-			mn::stream_read(f, mn::block_from(arg_len));
-			// read arg_types
-			mn::buf_resize(proc.arg_types, arg_len);
-			mn::stream_read(f, mn::block_from(proc.arg_types));
+	mn::Result<Pkg>
+	pkg_load(const mn::Str& filename)
+	{
+		auto f = mn::file_open(filename, mn::IO_MODE::READ, mn::OPEN_MODE::OPEN_ONLY);
+		if (f == nullptr)
+			return mn::Err{"failed to open '{}'", filename};
+		mn_defer(mn::file_close(f));
 
-			// read return type
-			mn::stream_read(f, mn::block_from(proc.ret));
+		uint32_t header[2] = {};
+		if (mn::stream_read(f, mn::block_from(header)) != sizeof(header) || header[0] != PKG_MAGIC)
+			return mn::Err{"'{}' isn't a package or it was written by an older version", filename};
+		if (header[1] != PKG_VERSION)
+			return mn::Err{"'{}' has package format version {} but version {} is expected", filename, header[1], PKG_VERSION};
 
-			mn::buf_push(self.c_procs, proc);
+		auto self = pkg_new();
+		auto in = _reader_new(f, uint64_t(mn::file_size(f)) - sizeof(header));
+
+		while (in.failed == false)
+		{
+			auto record = PKG_RECORD_END;
+			if (_read(in, mn::block_from(record)) == false)
+				break;
+
+			switch (record)
+			{
+			case PKG_RECORD_SECTION:
+			{
+				auto section = _section_load(in);
+				if (in.failed || mn::map_lookup(self.sections, section.name))
+				{
+					in.failed = true;
+					section_free(section);
+					break;
+				}
+				mn::map_insert(self.sections, section.name, section);
+				break;
+			}
+			case PKG_RECORD_RELOC:
+				mn::buf_push(self.relocs, _reloc_load(in));
+				break;
+			case PKG_RECORD_C_PROC:
+				mn::buf_push(self.c_procs, _c_proc_load(in));
+				break;
+			case PKG_RECORD_STACK_SIZE:
+				_read(in, mn::block_from(self.stack_size));
+				break;
+			case PKG_RECORD_DEBUG:
+			{
+				auto name = _read_string(in);
+				auto bytes = _read_bytes(in);
+				pkg_debug_add(self, name, proc_debug_decode(bytes));
+				mn::free(bytes);
+				mn::str_free(name);
+				break;
+			}
+			case PKG_RECORD_END:
+				if (in.failed == false)
+					return self;
+				break;
+			default:
+				pkg_free(self);
+				return mn::Err{"'{}' has an unknown record kind {}", filename, uint8_t(record)};
+			}
 		}
 
+		// the writer always ends the package with the end record
+		pkg_free(self);
+		return mn::Err{"'{}' is truncated or corrupt", filename};
+	}
+
+	Pkg_Writer
+	pkg_writer_new(const mn::Str& filename)
+	{
+		Pkg_Writer self{};
+		self.file = mn::file_open(filename, mn::IO_MODE::WRITE, mn::OPEN_MODE::CREATE_OVERWRITE);
+		assert(self.file != nullptr);
+
+		uint32_t header[2] = {PKG_MAGIC, PKG_VERSION};
+		mn::stream_write(self.file, mn::block_from(header));
 		return self;
 	}
 
+	void
+	pkg_writer_free(Pkg_Writer& self)
+	{
+		_write_record(self.file, PKG_RECORD_END);
+		mn::file_close(self.file);
+	}
+
+	void
+	pkg_writer_proc(Pkg_Writer& self, const mn::Str& name, mn::Block bytes)
+	{
+		_write_record(self.file, PKG_RECORD_SECTION);
+		_section_save(self.file, Section::KIND_BYTECODE, name, bytes);
+	}
+
+	void
+	pkg_writer_constant(Pkg_Writer& self, const mn::Str& name, mn::Block bytes)
+	{
+		_write_record(self.file, PKG_RECORD_SECTION);
+		_section_save(self.file, Section::KIND_CONSTANT, name, bytes);
+	}
+
+	void
+	pkg_writer_reloc(Pkg_Writer& self, const mn::Str& source_name, uint64_t source_offset, const mn::Str& target_name, uint8_t width, uint64_t target_offset)
+	{
+		_write_record(self.file, PKG_RECORD_RELOC);
+		reloc_save(Reloc{source_name, target_name, source_offset, width, target_offset}, self.file);
+	}
+
+	void
+	pkg_writer_c_proc(Pkg_Writer& self, const C_Proc& c_proc)
+	{
+		_write_record(self.file, PKG_RECORD_C_PROC);
+		_write_string(self.file, c_proc.lib);
+		_write_string(self.file, c_proc.name);
+
+		// write arg_types count
+		uint32_t len = uint32_t(c_proc.arg_types.count);
+		mn::stream_write(self.file, mn::block_from(len));
+		mn::stream_write(self.file, mn::block_from(c_proc.arg_types));
+
+		// write return type
+		mn::stream_write(self.file, mn::block_from(c_proc.ret));
+	}
+
+	void
+	pkg_writer_stack_size(Pkg_Writer& self, uint64_t stack_size)
+	{
+		_write_record(self.file, PKG_RECORD_STACK_SIZE);
+		mn::stream_write(self.file, mn::block_from(stack_size));
+	}
+
+	void
+	pkg_writer_debug(Pkg_Writer& self, const mn::Str& proc_name, const Proc_Debug& debug)
+	{
+		_write_record(self.file, PKG_RECORD_DEBUG);
+		_write_string(self.file, proc_name);
+		proc_debug_save(debug, self.file);
+	}
+
+	Image
+	pkg_image_load(const Pkg& self)
+	{
+		auto image = image_new();
+		for(const auto&[key, value]: self.sections)
+		{
+			if (value.kind != Section::KIND_CONSTANT)
+				continue;
+
+			auto offset = (image.rodata.count + RODATA_ALIGNMENT - 1) & ~(RODATA_ALIGNMENT - 1);
+			mn::map_insert(image.sections, clone(key), uint64_t(offset));
+			mn::buf_resize_fill(image.rodata, offset + value.bytes.size, uint8_t(0));
+			::memcpy(image.rodata.ptr + offset, value.bytes.ptr, value.bytes.size);
+		}
+		return image;
+	}
+
 	mn::Err
 	pkg_core_load(const Pkg& self, Core& core, uint64_t stack_size_in_bytes)
+	{
+		core.own_image = pkg_image_load(self);
+		return pkg_core_load(self, core, core.own_image, stack_size_in_bytes);
+	}
+
+	mn::Err
+	pkg_core_load(const Pkg& self, Core& core, const Image& image, uint64_t stack_size_in_bytes)
 	{
 		auto loaded_libraries = mn::map_new<mn::Str, size_t>();
 		auto loaded_c_procs_table = mn::map_new<mn::Str, size_t>();
@@ -362,17 +872,21 @@ namespace vm
 			case Section::KIND_BYTECODE:
 			{
 				mn::map_insert(section_offset_table, key, uint64_t(core.bytecode.count));
+				mn::buf_push(core.procs, uint64_t(core.bytecode.count));
+				mn::buf_push(core.procs_name, clone(key));
+				_proc_debug_load(core, self, key, core.bytecode.count);
 				auto old_count = core.bytecode.count;
-				mn::buf_resize(core.bytecode, value.bytes.size);
+				mn::buf_resize(core.bytecode, old_count + value.bytes.size);
 				::memcpy(core.bytecode.ptr + old_count, value.bytes.ptr, value.bytes.size);
 				break;
 			}
 			case Section::KIND_CONSTANT:
 			{
-				mn::map_insert(section_offset_table, key, uint64_t(core.stack.count));
-				auto old_count = core.stack.count;
-				mn::buf_resize(core.stack, value.bytes.size);
-				::memcpy(core.stack.ptr + old_count, value.bytes.ptr, value.bytes.size);
+				// constants live in the image rodata which is shared with the other cores
+				auto it = mn::map_lookup(image.sections, key);
+				if (it == nullptr)
+					return mn::Err{ "constant section '{}' not found in the image", key };
+				mn::map_insert(section_offset_table, key, it->value);
 				break;
 			}
 			default:
@@ -381,7 +895,7 @@ namespace vm
 			}
 		}
 
-		mn::buf_resize(core.stack, core.stack.count + stack_size_in_bytes);
+		core.rodata = mn::block_from(image.rodata);
 
 		// after loading procs we'll need to perform the relocs
 		for(const auto& reloc: self.relocs)
@@ -394,13 +908,19 @@ namespace vm
 			if(source_section.kind != Section::KIND_BYTECODE)
 				return mn::Err{ "unsupported relocation in a non-procedure section '{}'", reloc.source_name };
 
+			// the patched value has to be inside the source proc
+			if(reloc.source_offset > source_section.bytes.size || source_section.bytes.size - reloc.source_offset < reloc.width)
+				return mn::Err{ "relocation at {} is out of the procedure '{}'", reloc.source_offset, reloc.source_name };
+
 			if(mn::str_prefix(reloc.target_name, "C."))
 			{
 				auto target_it = mn::map_lookup(loaded_c_procs_table, reloc.target_name);
 				if (target_it == nullptr)
 					return mn::Err{ "relocation target procedure '{}' not found", reloc.target_name };
 
-				_write64(core.bytecode.ptr + source_it->value + reloc.source_offset, target_it->value);
+				auto err = _reloc_write(core.bytecode.ptr + source_it->value + reloc.source_offset, reloc, target_it->value);
+				if (err)
+					return err;
 			}
 			else
 			{
@@ -409,24 +929,31 @@ namespace vm
 					return mn::Err{ "relocation target section '{}' not found", reloc.target_name };
 
 				const auto &[_2, target_section] = *mn::map_lookup(self.sections, reloc.target_name);
+				if (reloc.target_offset != 0 && reloc.target_offset >= target_section.bytes.size)
+					return mn::Err{ "relocation target offset {} is out of the section '{}'", reloc.target_offset, reloc.target_name };
+				mn::Err err{};
 				switch (target_section.kind)
 				{
 				case Section::KIND_BYTECODE:
-					_write64(
+					err = _reloc_write(
 						core.bytecode.ptr + source_it->value + reloc.source_offset,
-						target_it->value
+						reloc,
+						target_it->value + reloc.target_offset
 					);
 					break;
 				case Section::KIND_CONSTANT:
-					_write64(
+					err = _reloc_write(
 						core.bytecode.ptr + source_it->value + reloc.source_offset,
-						uint64_t(core.stack.ptr + target_it->value)
+						reloc,
+						uint64_t(image.rodata.ptr + target_it->value + reloc.target_offset)
 					);
 					break;
 				default:
 					assert(false && "unreachable");
 					break;
 				}
+				if (err)
+					return err;
 			}
 		}
 
@@ -434,7 +961,22 @@ namespace vm
 		if(main_it == nullptr)
 			return mn::Err{ "undefined main proc" };
 
+	#if VM_PROFILE
+		core_profile_reset(core);
+	#endif
+
 		core.r[Reg_IP].u64 = main_it->value;
+
+		// only bytecode which passes verification runs in the unchecked mode, the rest still runs but in the
+		// checked mode and core_verify can be called again to get the reason
+		core_verify(core);
+
+		// the unchecked mode checks for room for the deepest frame at calls, the extra room keeps the whole
+		// requested stack size usable
+		if (stack_size_in_bytes == 0)
+			stack_size_in_bytes = self.stack_size != 0 ? self.stack_size : DEFAULT_STACK_SIZE;
+		stack_size_in_bytes += core.frame_bound;
+		mn::buf_resize(core.stack, stack_size_in_bytes);
 		core.r[Reg_SP].ptr = core.stack.ptr + stack_size_in_bytes;
 		return mn::Err{};
 	}
@@ -0,0 +1,187 @@
+#include "vm/Sample.h"
+
+#include "Decode.h"
+
+#include <mn/Defer.h>
+
+#include <chrono>
+#include <algorithm>
+
+namespace vm
+{
+	// instructions executed between two checks of the clock
+	constexpr static uint64_t SAMPLE_BUDGET = 1024;
+	// unwinding stops at this depth so a corrupt stack can't keep it going
+	constexpr static size_t SAMPLE_MAX_DEPTH = 256;
+	// frame of the stacks which couldn't be unwound all the way to the outermost proc
+	constexpr static size_t SAMPLE_FRAME_UNKNOWN = SIZE_MAX;
+
+	inline static void
+	_proc_unwind_build(Sampler& self, const Core& core, uint64_t begin, uint64_t end)
+	{
+		auto ins = mn::buf_new<Decoded_Ins>();
+		mn_defer(mn::buf_free(ins));
+		auto index = mn::buf_new<size_t>();
+		mn_defer(mn::buf_free(index));
+		auto states = mn::buf_new<Stack_State>();
+		mn_defer(mn::buf_free(states));
+
+		// procs which fail to decode or to track keep the none rule
+		if (proc_decode(core.bytecode.ptr, begin, end, ins, index))
+			return;
+		if (proc_stack_flow(ins, index, begin, states))
+			return;
+
+		// the return address is at the sp the proc was entered with
+		for (size_t i = 0; i < ins.count; ++i)
+		{
+			const auto& state = states[i];
+			auto& rule = self.unwind[ins[i].offset];
+			if (state.visited == false)
+				continue;
+			if (state.sp_known)
+				rule = Unwind_Rule{Unwind_Rule::KIND_SP, -state.sp};
+			else if (state.fp_known)
+				rule = Unwind_Rule{Unwind_Rule::KIND_FP, -state.fp};
+		}
+	}
+
+	// API
+	Sampler
+	sampler_new(const Core& core, uint64_t hz)
+	{
+		Sampler self{};
+		self.period = 1000000000 / (hz ? hz : 1);
+		if (self.period == 0)
+			self.period = 1;
+		self.unwind = mn::buf_new<Unwind_Rule>();
+		self.stacks = mn::map_new<mn::Str, uint64_t>();
+		self.frames = mn::buf_new<size_t>();
+		self.folded = mn::str_new();
+
+		mn::buf_resize_fill(self.unwind, core.bytecode.count, Unwind_Rule{});
+		for (size_t i = 0; i < core.procs.count; ++i)
+		{
+			auto begin = core.procs[i];
+			auto end = i + 1 < core.procs.count ? core.procs[i + 1] : core.bytecode.count;
+			_proc_unwind_build(self, core, begin, end);
+		}
+		return self;
+	}
+
+	void
+	sampler_free(Sampler& self)
+	{
+		mn::buf_free(self.unwind);
+		destruct(self.stacks);
+		mn::buf_free(self.frames);
+		mn::str_free(self.folded);
+	}
+
+	void
+	sampler_record(Sampler& self, const Core& core, uint64_t weight)
+	{
+		auto stack_begin = uintptr_t(core.stack.ptr);
+		auto stack_end = uintptr_t(core.stack.ptr + core.stack.count);
+		auto ip = core.r[Reg_IP].u64;
+		auto sp = uintptr_t(core.r[Reg_SP].ptr);
+
+		// walk from the innermost proc out, the fp only belongs to the innermost proc since the procs it
+		// called could have changed it
+		mn::buf_clear(self.frames);
+		while (true)
+		{
+			auto proc = core_proc_at(core, ip);
+			if (proc == core.procs.count || self.frames.count == SAMPLE_MAX_DEPTH)
+			{
+				mn::buf_push(self.frames, SAMPLE_FRAME_UNKNOWN);
+				break;
+			}
+			mn::buf_push(self.frames, proc);
+
+			auto rule = self.unwind[ip];
+			uintptr_t entry_sp = 0;
+			if (rule.kind == Unwind_Rule::KIND_SP)
+				entry_sp = sp + rule.offset;
+			else if (rule.kind == Unwind_Rule::KIND_FP && self.frames.count == 1)
+				entry_sp = uintptr_t(core.r[Reg_FP].ptr) + rule.offset;
+
+			// the outermost proc is entered with an empty stack
+			if (entry_sp == stack_end)
+				break;
+
+			if (entry_sp < stack_begin || entry_sp + sizeof(uint64_t) > stack_end)
+			{
+				mn::buf_push(self.frames, SAMPLE_FRAME_UNKNOWN);
+				break;
+			}
+
+			::memcpy(&ip, (const void*)entry_sp, sizeof(ip));
+			sp = entry_sp + sizeof(uint64_t);
+		}
+
+		mn::str_clear(self.folded);
+		for (size_t i = self.frames.count; i > 0; --i)
+		{
+			auto frame = self.frames[i - 1];
+			if (i != self.frames.count)
+				mn::str_push(self.folded, ";");
+			if (frame == SAMPLE_FRAME_UNKNOWN)
+				mn::str_push(self.folded, "[unknown]");
+			else
+				mn::str_push(self.folded, core.procs_name[frame]);
+		}
+
+		if (auto it = mn::map_lookup(self.stacks, self.folded))
+			it->value += weight;
+		else
+			mn::map_insert(self.stacks, clone(self.folded), weight);
+		self.samples += weight;
+	}
+
+	void
+	core_run_sampled(Core& self, Sampler& sampler)
+	{
+		using Clock = std::chrono::steady_clock;
+		auto period = std::chrono::nanoseconds(sampler.period);
+		auto next = Clock::now() + period;
+		while (self.state == Core::STATE_OK)
+		{
+			core_run_for(self, SAMPLE_BUDGET);
+			if (self.state != Core::STATE_OK)
+				break;
+
+			auto now = Clock::now();
+			if (now < next)
+				continue;
+
+			// a budget which took several periods, like one with a long c call, counts for all of them
+			auto weight = uint64_t((now - next) / period) + 1;
+			sampler_record(sampler, self, weight);
+			next += period * weight;
+		}
+	}
+
+	mn::Str
+	sampler_folded(const Sampler& self, mn::Allocator allocator)
+	{
+		struct Folded_Stack
+		{
+			const mn::Str* stack;
+			uint64_t samples;
+		};
+
+		auto stacks = mn::buf_new<Folded_Stack>();
+		mn_defer(mn::buf_free(stacks));
+		for (const auto& [stack, samples]: self.stacks)
+			mn::buf_push(stacks, Folded_Stack{&stack, samples});
+		std::sort(stacks.ptr, stacks.ptr + stacks.count, [](const Folded_Stack& a, const Folded_Stack& b) {
+			return ::strcmp(a.stack->ptr, b.stack->ptr) < 0;
+		});
+
+		auto out = mn::str_with_allocator(allocator);
+		for (const auto& folded: stacks)
+			out = mn::strf(out, "{} {}\n", *folded.stack, folded.samples);
+		return out;
+	}
+}
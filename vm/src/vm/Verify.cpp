@@ -0,0 +1,161 @@
+#include "vm/Verify.h"
+
+#include "Decode.h"
+
+#include <mn/Defer.h>
+
+namespace vm
+{
+	inline static bool
+	_is_proc_start(const Core& self, uint64_t offset)
+	{
+		auto ix = core_proc_at(self, offset);
+		return ix < self.procs.count && self.procs[ix] == offset;
+	}
+
+	// sizes of the c types as libffi passes them on the stack, the return slot of void procs takes a byte
+	inline static int64_t
+	_c_type_size(C_TYPE t)
+	{
+		switch(t)
+		{
+		case C_TYPE_VOID:
+		case C_TYPE_INT8:
+		case C_TYPE_UINT8:
+			return 1;
+		case C_TYPE_INT16:
+		case C_TYPE_UINT16:
+			return 2;
+		case C_TYPE_INT32:
+		case C_TYPE_UINT32:
+		case C_TYPE_FLOAT32:
+			return 4;
+		default:
+			return 8;
+		}
+	}
+
+	// proves that the proc never touches the stack outside of its frame so the unchecked mode can skip the
+	// stack checks, the frame spans depth bytes below the stack pointer at the proc entry and the return
+	// address above it, the proc which the core starts in has no return address
+	inline static mn::Err
+	_proc_stack_prove(const Core& self, const mn::Buf<Decoded_Ins>& ins, const mn::Buf<Stack_State>& states, bool entry, uint64_t& depth)
+	{
+		depth = 0;
+		for (size_t i = 0; i < ins.count; ++i)
+		{
+			if (states[i].visited == false)
+				continue;
+
+			const auto& decoded = ins[i];
+			auto state = states[i];
+			if (state.sp_known == false)
+				return mn::Err{"bytecode offset {}: the stack depth isn't known", decoded.offset};
+
+			if (decoded.op == Op_CALL || decoded.op == Op_CALL32 || decoded.op == Op_TAILCALL || decoded.op == Op_C_CALL)
+			{
+				if (decoded.operands[0].mode != ADDRESS_MODE_IMM)
+					return mn::Err{"bytecode offset {}: indirect calls can't be verified", decoded.offset};
+			}
+
+			if ((decoded.op == Op_RET || decoded.op == Op_TAILCALL) && entry)
+				return mn::Err{"bytecode offset {}: the proc the core starts in has nothing to return to", decoded.offset};
+
+			// c procs read their return slot and arguments above the stack pointer
+			if (decoded.op == Op_C_CALL)
+			{
+				const auto& cproc = self.c_procs_desc[decoded.operands[0].imm];
+				auto size = _c_type_size(cproc.ret);
+				for (auto arg: cproc.arg_types)
+					size += _c_type_size(arg);
+				if (state.sp + size > 0)
+					return mn::Err{"bytecode offset {}: the c proc arguments are outside of the frame", decoded.offset};
+			}
+
+			stack_step(decoded, state);
+			if (state.sp_known == false)
+				return mn::Err{"bytecode offset {}: the stack depth isn't known", decoded.offset};
+
+			auto lowest = states[i].sp < state.sp ? states[i].sp : state.sp;
+			if (states[i].sp > 0 || state.sp > 0)
+				return mn::Err{"bytecode offset {}: the stack pointer moves above the proc frame", decoded.offset};
+			if (uint64_t(-lowest) > depth)
+				depth = uint64_t(-lowest);
+		}
+		return mn::Err{};
+	}
+
+	inline static mn::Err
+	_proc_verify(Core& self, uint64_t begin, uint64_t end, bool entry, uint64_t& depth)
+	{
+		auto ins = mn::buf_new<Decoded_Ins>();
+		mn_defer(mn::buf_free(ins));
+		auto index = mn::buf_new<size_t>();
+		mn_defer(mn::buf_free(index));
+		auto states = mn::buf_new<Stack_State>();
+		mn_defer(mn::buf_free(states));
+
+		if (auto err = proc_decode(self.bytecode.ptr, begin, end, ins, index))
+			return err;
+
+		for (const auto& decoded: ins)
+		{
+			if (op_is_jump(decoded.op))
+			{
+				auto target = ins_jump_target(decoded);
+				if (target < begin || target >= end || index[target - begin] == SIZE_MAX)
+					return mn::Err{"bytecode offset {}: jump target {} isn't an instruction of the proc", decoded.offset, target};
+			}
+			else if ((decoded.op == Op_CALL || decoded.op == Op_CALL32 || decoded.op == Op_TAILCALL) &&
+					 decoded.operands[0].mode == ADDRESS_MODE_IMM)
+			{
+				if (_is_proc_start(self, decoded.operands[0].imm) == false)
+					return mn::Err{"bytecode offset {}: call target {} isn't a proc", decoded.offset, decoded.operands[0].imm};
+			}
+			else if (decoded.op == Op_C_CALL && decoded.operands[0].mode == ADDRESS_MODE_IMM &&
+					 decoded.operands[0].imm >= self.c_procs_desc.count)
+			{
+				return mn::Err{"bytecode offset {}: invalid c proc index {}", decoded.offset, decoded.operands[0].imm};
+			}
+		}
+
+		if (ins.count > 0 && op_falls_through(mn::buf_top(ins).op))
+			return mn::Err{"bytecode offset {}: execution falls through the end of the proc", mn::buf_top(ins).offset};
+
+		if (auto err = proc_stack_flow(ins, index, begin, states))
+			return err;
+
+		return _proc_stack_prove(self, ins, states, entry, depth);
+	}
+
+	// API
+	mn::Err
+	core_verify(Core& self)
+	{
+		self.verified = false;
+		self.frame_bound = 0;
+
+		if (self.procs.count == 0 || self.procs[0] != 0)
+			return mn::Err{"bytecode doesn't start with a proc"};
+
+		auto entry = core_proc_at(self, self.r[Reg_IP].u64);
+		if (entry >= self.procs.count || self.procs[entry] != self.r[Reg_IP].u64)
+			return mn::Err{"the core doesn't start at a proc"};
+
+		uint64_t frame_bound = 0;
+		for (size_t i = 0; i < self.procs.count; ++i)
+		{
+			auto begin = self.procs[i];
+			auto end = i + 1 < self.procs.count ? self.procs[i + 1] : self.bytecode.count;
+			uint64_t depth = 0;
+			if (auto err = _proc_verify(self, begin, end, i == entry, depth))
+				return err;
+			if (depth > frame_bound)
+				frame_bound = depth;
+		}
+
+		self.frame_bound = frame_bound;
+		self.verified = true;
+		return mn::Err{};
+	}
+}